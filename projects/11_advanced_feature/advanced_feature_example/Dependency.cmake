@@ -89,6 +89,21 @@ ExternalProject_Add(
   )
 set(DEP_LIST ${DEP_LIST} dep_glm)
 
+# nlohmann json: header-only json parser (glTF 로더)
+ExternalProject_Add(
+  dep_json
+  URL "https://github.com/nlohmann/json/releases/download/v3.11.2/include.zip"
+  UPDATE_COMMAND ""
+  PATCH_COMMAND ""
+  CONFIGURE_COMMAND ""
+  BUILD_COMMAND ""
+  TEST_COMMAND ""
+  INSTALL_COMMAND ${CMAKE_COMMAND} -E copy_directory
+        ${PROJECT_BINARY_DIR}/dep_json-prefix/src/dep_json/single_include/nlohmann
+        ${DEP_INSTALL_DIR}/include/nlohmann
+  )
+set(DEP_LIST ${DEP_LIST} dep_json)
+
 # imgui
 add_library(imgui
     imgui/imgui_draw.cpp
@@ -128,4 +143,8 @@ set(DEP_LIBS ${DEP_LIBS}
   assimp-vc142-mt$<$<CONFIG:Debug>:d>
   zlibstatic$<$<CONFIG:Debug>:d>
   IrrXML$<$<CONFIG:Debug>:d>
-  )
\ No newline at end of file
+  )
+
+# std::thread / std::async (BVH 병렬 구성 등)
+find_package(Threads REQUIRED)
+set(DEP_LIBS ${DEP_LIBS} Threads::Threads)
@@ -0,0 +1,5 @@
+#version 330 core
+
+// depth만 기록하므로 색은 출력하지 않음
+void main() {
+}
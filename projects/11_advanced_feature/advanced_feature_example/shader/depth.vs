@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 aPos; // 위치 전용 stream (Mesh::DrawPositionOnly)
+
+uniform mat4 modelTransform;
+
+#include "include/camera.glsl" // view projection은 프레임마다 한 번 올리는 block에서 읽음
+
+invariant gl_Position; // lighting.vs와 같은 식이 같은 depth가 되도록 (depth prepass 후 GL_LEQUAL로 비교)
+
+void main() {
+  gl_Position = viewProjection * modelTransform * vec4(aPos, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceTransform; // location 3~6 사용
+
+uniform mat4 transform;
+
+invariant gl_Position;
+
+void main() {
+  gl_Position = transform * aInstanceTransform * vec4(aPos, 1.0);
+}
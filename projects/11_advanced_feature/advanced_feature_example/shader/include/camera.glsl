@@ -0,0 +1,7 @@
+// 프레임마다 한 번 올리는 camera uniform block (frame_uniforms.h의 CameraUniforms와 같은 배치)
+layout (std140) uniform Camera {
+  mat4 view;
+  mat4 projection;
+  mat4 viewProjection;
+  vec4 viewPos; // xyz
+};
@@ -0,0 +1,50 @@
+// 광원 uniform block (frame_uniforms.h의 LightUniforms와 같은 배치)과 material, 조명 계산
+// camera.glsl을 먼저 include해야 함 (viewPos)
+layout (std140) uniform Light {
+  vec4 position;
+  vec4 direction;
+  vec4 cutoff; // inner, outer
+  vec4 attenuation; // 감쇠계수 (Kc, Kl, Kq)
+  vec4 ambient;
+  vec4 diffuse;
+  vec4 specular;
+} light;
+
+#include "material.glsl"
+
+// POINT_LIGHT를 define하면 spot light의 원뿔 계산과 분기가 컴파일 시간에 빠짐
+vec3 ComputeLighting(vec3 position, vec3 normal, vec2 texCoord) {
+  vec3 texColor = MaterialDiffuse(texCoord);
+  vec3 ambient = texColor * light.ambient.xyz;
+
+  float dist = length(light.position.xyz - position);
+  vec3 distPoly = vec3(1.0, dist, dist*dist);
+  float attenuation = 1.0 / dot(distPoly, light.attenuation.xyz); // attenuation = 1 / (Kc + Kl*dist + Kq*dist*dist)
+  vec3 lightDir = (light.position.xyz - position) / dist; 
+  vec3 result = ambient;
+
+#ifdef POINT_LIGHT
+  float intensity = 1.0;
+  {
+#else
+  float theta = dot(lightDir, normalize(-light.direction.xyz));
+
+  // cox(x) - cos(outer) / cos(inner) - cost(outer)
+  float intensity = clamp((theta - light.cutoff[1]) / (light.cutoff[0] - light.cutoff[1]), 0.0, 1.0); 
+ 
+  if (intensity > 0.0) {
+#endif
+      vec3 pixelNorm = normalize(normal);
+      float diff = max(dot(pixelNorm, lightDir), 0.0);
+      vec3 diffuse = diff * texColor * light.diffuse.xyz;
+
+      vec3 specColor = MaterialSpecular(texCoord);
+      vec3 viewDir = normalize(viewPos.xyz - position);
+      vec3 reflectDir = reflect(-lightDir, pixelNorm);
+      float spec = pow(max(dot(viewDir, reflectDir), 0.0), MaterialShininess());
+      vec3 specular = spec * specColor * light.specular.xyz;
+
+      result += (diffuse + specular) * intensity;
+  }
+  return result * attenuation;
+}
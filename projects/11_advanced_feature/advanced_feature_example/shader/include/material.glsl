@@ -0,0 +1,31 @@
+// material 값을 읽는 함수. MATERIAL_TABLE을 define하면 모든 material이 들어 있는 uniform block에서
+// materialIndex번째를 읽고 texture는 texture array의 layer로 찾음. draw마다 index 하나만 바꾸면 됨
+#ifdef MATERIAL_TABLE
+#define MAX_MATERIALS 256 // material_table.h의 kMaxMaterials
+struct MaterialEntry {
+  vec4 params; // shininess, diffuse layer, specular layer (layer가 음수면 texture 없음)
+};
+layout (std140) uniform Materials {
+  MaterialEntry materials[MAX_MATERIALS];
+};
+uniform int materialIndex;
+uniform sampler2DArray materialTextures;
+
+vec3 SampleMaterialLayer(float layer, vec2 texCoord) {
+  return layer < 0.0 ? vec3(0.0) : texture(materialTextures, vec3(texCoord, layer)).xyz;
+}
+vec3 MaterialDiffuse(vec2 texCoord) { return SampleMaterialLayer(materials[materialIndex].params.y, texCoord); }
+vec3 MaterialSpecular(vec2 texCoord) { return SampleMaterialLayer(materials[materialIndex].params.z, texCoord); }
+float MaterialShininess() { return materials[materialIndex].params.x; }
+#else
+struct Material {
+    sampler2D diffuse; 
+    sampler2D specular;
+    float shininess;
+};
+uniform Material material;
+
+vec3 MaterialDiffuse(vec2 texCoord) { return texture2D(material.diffuse, texCoord).xyz; }
+vec3 MaterialSpecular(vec2 texCoord) { return texture2D(material.specular, texCoord).xyz; }
+float MaterialShininess() { return material.shininess; }
+#endif
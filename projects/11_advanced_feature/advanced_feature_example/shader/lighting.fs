@@ -4,57 +4,10 @@ in vec2 texCoord;
 in vec3 position;
 out vec4 fragColor;
 
-uniform vec3 viewPos;
-
-struct Light {
-    vec3 position;
-    vec3 direction;
-    vec2 cutoff; // inner, outer
-    vec3 attenuation; // 감쇠계수 (Kc, Kl, Kq)
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;  
-};
-uniform Light light;
- 
-struct Material {
-    sampler2D diffuse; 
-    sampler2D specular;
-    float shininess;
-};
-uniform Material material;
+#include "include/camera.glsl"
+#include "include/light.glsl"
 
 void main() {
-  vec3 texColor = texture2D(material.diffuse, texCoord).xyz;
-  vec3 ambient = texColor * light.ambient;
-
-  float dist = length(light.position - position);
-  vec3 distPoly = vec3(1.0, dist, dist*dist);
-  float attenuation = 1.0 / dot(distPoly, light.attenuation); // attenuation = 1 / (Kc + Kl*dist + Kq*dist*dist)
-  vec3 lightDir = (light.position - position) / dist; 
-
-  float theta = dot(lightDir, normalize(-light.direction));
-  vec3 result = ambient;
-
-  // cox(x) - cos(outer) / cos(inner) - cost(outer)
-  float intensity = clamp((theta - light.cutoff[1]) / (light.cutoff[0] - light.cutoff[1]), 0.0, 1.0); 
- 
-  if (intensity > 0.0) {
-      vec3 pixelNorm = normalize(normal);
-      float diff = max(dot(pixelNorm, lightDir), 0.0);
-      vec3 diffuse = diff * texColor * light.diffuse;
-
-      vec3 specColor = texture2D(material.specular, texCoord).xyz;
-      vec3 viewDir = normalize(viewPos - position);
-      vec3 reflectDir = reflect(-lightDir, pixelNorm);
-      float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-      vec3 specular = spec * specColor * light.specular;
-
-      result += (diffuse + specular) * intensity;
-  }
-  result *= attenuation;
-
-  fragColor = vec4(result, 1.0);
+  fragColor = vec4(ComputeLighting(position, normal, texCoord), 1.0);
 // fragColor = vec4(vec3(gl_FragCoord.z), 1.0);
-
-}
\ No newline at end of file
+}
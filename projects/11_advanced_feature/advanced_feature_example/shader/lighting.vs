@@ -3,15 +3,18 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
-uniform mat4 transform;
 uniform mat4 modelTransform;
 
+#include "include/camera.glsl" // view projection은 프레임마다 한 번 올리는 block에서 읽음
+
 out vec3 normal;
 out vec2 texCoord;
 out vec3 position;
 
+invariant gl_Position; // depth prepass(depth.vs)와 같은 식이라 같은 depth를 보장
+
 void main() {
-  gl_Position = transform * vec4(aPos, 1.0);
+  gl_Position = viewProjection * modelTransform * vec4(aPos, 1.0);
   normal = (transpose(inverse(modelTransform))*vec4(aNormal, 0.0)).xyz; // diffuse 값을 계산하려면 world space상에서의 노멀 벡터가 필요.
   texCoord = aTexCoord;
   position = (modelTransform*vec4(aPos, 1.0)).xyz; // diffuse 값을 계산하려면 world space 상에서의 좌표값이 필요.
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aInstanceTransform; // model node의 world transform (location 3~6 사용)
+
+uniform mat4 transform;
+uniform mat4 modelTransform;
+
+out vec3 normal;
+out vec2 texCoord;
+out vec3 position;
+
+invariant gl_Position; // depth prepass(depth.vs)와 같은 depth를 보장
+
+void main() {
+  mat4 world = modelTransform * aInstanceTransform;
+  gl_Position = transform * aInstanceTransform * vec4(aPos, 1.0);
+  normal = (transpose(inverse(world))*vec4(aNormal, 0.0)).xyz;
+  texCoord = aTexCoord;
+  position = (world*vec4(aPos, 1.0)).xyz;
+}
@@ -0,0 +1,30 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 7) in ivec4 aBoneIds;     // 3~6은 인스턴스 transform이 사용
+layout (location = 8) in vec4 aBoneWeights;
+
+uniform mat4 transform;
+uniform mat4 modelTransform;
+
+// 캐릭터 하나의 bone palette. 배열 크기는 skinning.h의 kMaxBones와 같아야 함
+layout (std140) uniform BonePalette {
+  mat4 bones[128];
+};
+
+out vec3 normal;
+out vec2 texCoord;
+out vec3 position;
+
+void main() {
+  mat4 skin = bones[aBoneIds.x] * aBoneWeights.x
+            + bones[aBoneIds.y] * aBoneWeights.y
+            + bones[aBoneIds.z] * aBoneWeights.z
+            + bones[aBoneIds.w] * aBoneWeights.w;
+  vec4 skinnedPos = skin * vec4(aPos, 1.0);
+  gl_Position = transform * skinnedPos;
+  normal = (transpose(inverse(modelTransform)) * (skin * vec4(aNormal, 0.0))).xyz;
+  texCoord = aTexCoord;
+  position = (modelTransform * skinnedPos).xyz;
+}
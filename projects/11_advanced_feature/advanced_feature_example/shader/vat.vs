@@ -0,0 +1,43 @@
+#version 330 core
+layout (location = 0) in vec3 aPos; // bind pose, 실제 위치는 positionMap에서 읽음
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aInstanceTransform; // location 3~6 사용
+layout (location = 9) in vec2 aInstanceClip;      // (clip 번호, 시간 offset)
+
+uniform mat4 transform;
+uniform mat4 modelTransform;
+uniform float time;
+uniform int vertexCount;
+uniform vec4 clips[16]; // (first frame, frame count, frame rate, 0), vertex_animation.h의 kMaxVertexAnimationClips
+uniform sampler2D positionMap;
+uniform sampler2D normalMap;
+
+out vec3 normal;
+out vec2 texCoord;
+out vec3 position;
+
+// frame마다 vertexCount개의 texel이 이어져 있고, texture 폭에서 줄바꿈
+vec4 FetchFrame(sampler2D map, int frame) {
+  int index = frame * vertexCount + gl_VertexID;
+  int width = textureSize(map, 0).x;
+  return texelFetch(map, ivec2(index % width, index / width), 0);
+}
+
+void main() {
+  vec4 clip = clips[int(aInstanceClip.x)];
+  float frame = mod((time + aInstanceClip.y) * clip.z, clip.y);
+  int frame0 = int(frame);
+  int frame1 = (frame0 + 1) % int(clip.y); // 마지막 frame 다음은 첫 frame
+  float t = frame - float(frame0);
+  int first = int(clip.x);
+
+  vec3 pos = mix(FetchFrame(positionMap, first + frame0), FetchFrame(positionMap, first + frame1), t).xyz;
+  vec3 norm = mix(FetchFrame(normalMap, first + frame0), FetchFrame(normalMap, first + frame1), t).xyz;
+
+  mat4 world = modelTransform * aInstanceTransform;
+  gl_Position = transform * aInstanceTransform * vec4(pos, 1.0);
+  normal = (transpose(inverse(world)) * vec4(norm, 0.0)).xyz;
+  texCoord = aTexCoord;
+  position = (world * vec4(pos, 1.0)).xyz;
+}
@@ -0,0 +1,204 @@
+#include "bounds.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BOUNDS_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BOUNDS_USE_SSE
+#endif
+
+void AABB::Expand(const glm::vec3 &point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::Expand(const AABB &box)
+{
+    min = glm::min(min, box.min);
+    max = glm::max(max, box.max);
+}
+
+AABB AABB::Transform(const glm::mat4 &transform) const
+{
+    if (IsEmpty())
+        return *this;
+
+    // Arvo의 방법: 8개 꼭짓점을 변환하는 대신 행렬 원소별로 최소/최대를 누적
+    AABB result;
+    result.min = result.max = glm::vec3(transform[3]);
+    for (int col = 0; col < 3; col++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            float a = transform[col][row] * min[col];
+            float b = transform[col][row] * max[col];
+            result.min[row] += glm::min(a, b);
+            result.max[row] += glm::max(a, b);
+        }
+    }
+    return result;
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4 &transform) const
+{
+    float scale = glm::max(glm::length(glm::vec3(transform[0])),
+                           glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    return {glm::vec3(transform * glm::vec4(center, 1.0f)), radius * scale};
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4 &viewProjection)
+{
+    // Gribb-Hartmann 방식: clip space의 -w <= x,y,z <= w 조건을 행(row)의 합/차로 표현
+    auto row = [&](int i)
+    {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    Frustum frustum;
+    frustum.planes[0] = row(3) + row(0); // left
+    frustum.planes[1] = row(3) - row(0); // right
+    frustum.planes[2] = row(3) + row(1); // bottom
+    frustum.planes[3] = row(3) - row(1); // top
+    frustum.planes[4] = row(3) + row(2); // near
+    frustum.planes[5] = row(3) - row(2); // far
+    for (auto &plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane)); // sphere 검사를 위해 법선 길이를 1로 맞춤
+    return frustum;
+}
+
+void BoundsSoA::Clear()
+{
+    Resize(0);
+}
+
+void BoundsSoA::Add(const AABB &box, const BoundingSphere &sphere)
+{
+    Resize(m_count + 1);
+    Set(m_count - 1, box, sphere);
+}
+
+void BoundsSoA::Set(size_t index, const AABB &box, const BoundingSphere &sphere)
+{
+    m_minX[index] = box.min.x;
+    m_minY[index] = box.min.y;
+    m_minZ[index] = box.min.z;
+    m_maxX[index] = box.max.x;
+    m_maxY[index] = box.max.y;
+    m_maxZ[index] = box.max.z;
+    m_centerX[index] = sphere.center.x;
+    m_centerY[index] = sphere.center.y;
+    m_centerZ[index] = sphere.center.z;
+    m_radius[index] = sphere.radius;
+}
+
+void BoundsSoA::Resize(size_t count)
+{
+    m_count = count;
+    size_t padded = (count + 7) & ~(size_t)7;
+    if (padded == m_minX.size())
+        return;
+    for (auto array : {&m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ,
+                       &m_centerX, &m_centerY, &m_centerZ, &m_radius})
+        array->resize(padded, 0.0f);
+}
+
+void CullBounds(const Frustum &frustum, const BoundsSoA &bounds, std::vector<uint8_t> &visible, CullStats *stats)
+{
+    visible.resize(bounds.GetCount());
+    CullBounds(frustum, bounds, visible, 0, bounds.GetCount(), stats);
+}
+
+void CullBounds(const Frustum &frustum, const BoundsSoA &bounds, std::vector<uint8_t> &visible,
+                size_t begin, size_t end, CullStats *stats)
+{
+    int culled = 0;
+    // 다른 스레드가 맡은 구간을 덮어쓰지 않도록 end까지만 기록
+    auto writeMask = [&](size_t base, int outsideMask, int width)
+    {
+        for (int j = 0; j < width && base + j < end; j++)
+        {
+            bool outside = (outsideMask >> j) & 1;
+            visible[base + j] = outside ? 0 : 1;
+            culled += outside ? 1 : 0;
+        }
+    };
+
+    for (size_t i = begin; i < end; i += 8) // 8개씩 검사
+    {
+#if defined(BOUNDS_USE_AVX)
+        __m256 outside = _mm256_setzero_ps();
+        for (auto &plane : frustum.planes)
+        {
+            __m256 a = _mm256_set1_ps(plane.x);
+            __m256 b = _mm256_set1_ps(plane.y);
+            __m256 c = _mm256_set1_ps(plane.z);
+            __m256 d = _mm256_set1_ps(plane.w);
+
+            // sphere: 중심까지의 거리가 -radius보다 작으면 밖
+            __m256 dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(&bounds.m_centerX[i])), _mm256_mul_ps(b, _mm256_loadu_ps(&bounds.m_centerY[i]))),
+                _mm256_add_ps(_mm256_mul_ps(c, _mm256_loadu_ps(&bounds.m_centerZ[i])), d));
+            __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&bounds.m_radius[i]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, negRadius, _CMP_LT_OQ));
+
+            // box: 평면 법선 방향으로 가장 먼 꼭짓점(p-vertex)까지 밖이면 밖
+            const float *px = plane.x >= 0.0f ? &bounds.m_maxX[i] : &bounds.m_minX[i];
+            const float *py = plane.y >= 0.0f ? &bounds.m_maxY[i] : &bounds.m_minY[i];
+            const float *pz = plane.z >= 0.0f ? &bounds.m_maxZ[i] : &bounds.m_minZ[i];
+            dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(px)), _mm256_mul_ps(b, _mm256_loadu_ps(py))),
+                _mm256_add_ps(_mm256_mul_ps(c, _mm256_loadu_ps(pz)), d));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        writeMask(i, _mm256_movemask_ps(outside), 8);
+#elif defined(BOUNDS_USE_SSE)
+        for (size_t k = i; k < i + 8; k += 4) // SSE는 4개씩 두 번
+        {
+            __m128 outside = _mm_setzero_ps();
+            for (auto &plane : frustum.planes)
+            {
+                __m128 a = _mm_set1_ps(plane.x);
+                __m128 b = _mm_set1_ps(plane.y);
+                __m128 c = _mm_set1_ps(plane.z);
+                __m128 d = _mm_set1_ps(plane.w);
+
+                __m128 dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(&bounds.m_centerX[k])), _mm_mul_ps(b, _mm_loadu_ps(&bounds.m_centerY[k]))),
+                    _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(&bounds.m_centerZ[k])), d));
+                __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&bounds.m_radius[k]));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negRadius));
+
+                const float *px = plane.x >= 0.0f ? &bounds.m_maxX[k] : &bounds.m_minX[k];
+                const float *py = plane.y >= 0.0f ? &bounds.m_maxY[k] : &bounds.m_minY[k];
+                const float *pz = plane.z >= 0.0f ? &bounds.m_maxZ[k] : &bounds.m_minZ[k];
+                dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(px)), _mm_mul_ps(b, _mm_loadu_ps(py))),
+                    _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(pz)), d));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+            }
+            writeMask(k, _mm_movemask_ps(outside), 4);
+        }
+#else
+        for (size_t k = i; k < i + 8 && k < end; k++)
+        {
+            bool outside = false;
+            for (auto &plane : frustum.planes)
+            {
+                float dist = plane.x * bounds.m_centerX[k] + plane.y * bounds.m_centerY[k] + plane.z * bounds.m_centerZ[k] + plane.w;
+                float pdist = plane.x * (plane.x >= 0.0f ? bounds.m_maxX[k] : bounds.m_minX[k]) +
+                              plane.y * (plane.y >= 0.0f ? bounds.m_maxY[k] : bounds.m_minY[k]) +
+                              plane.z * (plane.z >= 0.0f ? bounds.m_maxZ[k] : bounds.m_minZ[k]) + plane.w;
+                outside = outside || dist < -bounds.m_radius[k] || pdist < 0.0f;
+            }
+            writeMask(k, outside ? 1 : 0, 1);
+        }
+#endif
+    }
+
+    if (stats)
+    {
+        stats->tested += (int)(end - begin);
+        stats->culled += culled;
+    }
+}
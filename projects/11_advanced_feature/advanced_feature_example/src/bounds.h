@@ -0,0 +1,71 @@
+#ifndef __BOUNDS_H__
+#define __BOUNDS_H__
+
+#include "common.h"
+#include <cfloat>
+
+// axis aligned bounding box
+struct AABB
+{
+    glm::vec3 min{glm::vec3(FLT_MAX)};
+    glm::vec3 max{glm::vec3(-FLT_MAX)};
+
+    bool IsEmpty() const { return min.x > max.x; }
+    glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    void Expand(const glm::vec3 &point);
+    void Expand(const AABB &box);
+    AABB Transform(const glm::mat4 &transform) const; // 변환된 box를 감싸는 새 AABB
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center{glm::vec3(0.0f)};
+    float radius{0.0f};
+
+    BoundingSphere Transform(const glm::mat4 &transform) const; // 가장 큰 scale 축 기준으로 반지름을 늘림
+};
+
+// view projection 행렬에서 뽑아낸 6개의 평면 (ax + by + cz + d >= 0 이면 안쪽)
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    static Frustum FromMatrix(const glm::mat4 &viewProjection); // model transform까지 곱한 행렬을 넣으면 model space의 frustum이 나온다.
+};
+
+// 프레임마다 검사한 / 걸러낸 오브젝트 수
+struct CullStats
+{
+    int tested{0};
+    int culled{0};
+
+    void Reset() { tested = culled = 0; }
+};
+
+// 여러 bounding volume을 SIMD로 한 번에 검사하기 위한 SoA(Structure of Arrays) 저장소
+class BoundsSoA
+{
+public:
+    void Clear();
+    void Add(const AABB &box, const BoundingSphere &sphere);
+    void Set(size_t index, const AABB &box, const BoundingSphere &sphere);
+    void Resize(size_t count); // SIMD 루프가 8개씩 읽을 수 있도록 배열은 8의 배수로 패딩
+    size_t GetCount() const { return m_count; }
+
+private:
+    friend void CullBounds(const Frustum &, const BoundsSoA &, std::vector<uint8_t> &, size_t, size_t, CullStats *);
+
+    size_t m_count{0};
+    std::vector<float> m_minX, m_minY, m_minZ;
+    std::vector<float> m_maxX, m_maxY, m_maxZ;
+    std::vector<float> m_centerX, m_centerY, m_centerZ, m_radius;
+};
+
+// frustum 밖에 있는 bounding volume은 visible[i] = 0, 안쪽이거나 걸쳐 있으면 1
+void CullBounds(const Frustum &frustum, const BoundsSoA &bounds, std::vector<uint8_t> &visible, CullStats *stats = nullptr);
+// [begin, end) 구간만 검사. visible은 미리 GetCount() 크기여야 하고 begin은 8의 배수
+// 구간이 겹치지 않으면 여러 스레드에서 동시에 불러도 됨
+void CullBounds(const Frustum &frustum, const BoundsSoA &bounds, std::vector<uint8_t> &visible,
+                size_t begin, size_t end, CullStats *stats = nullptr);
+
+#endif // __BOUNDS_H__
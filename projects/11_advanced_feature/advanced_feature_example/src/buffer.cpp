@@ -1,4 +1,6 @@
 #include "buffer.h"
+#include "gl_state.h"
+#include <chrono>
 
 // Buffer 인스턴스 생성
 BufferUPtr Buffer::CreateWithData(uint32_t bufferType, uint32_t usage, const void *data, size_t stride, size_t count)
@@ -14,12 +16,13 @@ Buffer::~Buffer()
     if (m_buffer)
     {
         glDeleteBuffers(1, &m_buffer);
+        GlState::Get().OnDeleteBuffer(m_buffer);
     }
 }
 
 void Buffer::Bind() const
 {
-    glBindBuffer(m_bufferType, m_buffer);
+    GlState::Get().BindBuffer(m_bufferType, m_buffer);
 }
 
 bool Buffer::Init(uint32_t bufferType, uint32_t usage, const void *data, size_t stride, size_t count)
@@ -28,8 +31,179 @@ bool Buffer::Init(uint32_t bufferType, uint32_t usage, const void *data, size_t
     m_usage = usage;
     m_stride = stride;
     m_count = count;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        // SetData / Orphan이 저장 공간을 다시 할당하므로 immutable storage가 아닌 glNamedBufferData 사용
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferData(m_buffer, m_stride * m_count, data, usage);
+        return true;
+    }
     glGenBuffers(1, &m_buffer);                                  // Buffer Object생성
     Bind();                                                      // 바인딩
     glBufferData(m_bufferType, m_stride * m_count, data, usage); // 데이터 추가
     return true;
-}
\ No newline at end of file
+}
+
+void Buffer::SetData(const void *data, size_t stride, size_t count)
+{
+    m_stride = stride;
+    m_count = count;
+    // 새 저장 공간을 할당하므로 GPU가 읽고 있는 이전 내용을 기다리지 않음
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glNamedBufferData(m_buffer, m_stride * m_count, data, m_usage);
+        return;
+    }
+    Bind();
+    glBufferData(m_bufferType, m_stride * m_count, data, m_usage);
+}
+
+void Buffer::SetSubData(size_t offset, const void *data, size_t size)
+{
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glNamedBufferSubData(m_buffer, offset, size, data);
+        return;
+    }
+    Bind();
+    glBufferSubData(m_bufferType, offset, size, data);
+}
+
+void Buffer::Orphan()
+{
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glNamedBufferData(m_buffer, m_stride * m_count, nullptr, m_usage);
+        return;
+    }
+    Bind();
+    glBufferData(m_bufferType, m_stride * m_count, nullptr, m_usage);
+}
+
+StreamBufferUPtr StreamBuffer::Create(uint32_t bufferType, size_t regionSize, int regionCount)
+{
+    auto buffer = StreamBufferUPtr(new StreamBuffer());
+    if (!buffer->Init(bufferType, regionSize, regionCount))
+        return nullptr;
+    return std::move(buffer);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (auto fence : m_fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    if (m_buffer)
+    {
+        if (m_mapped && GlState::Get().IsDirectStateAccess())
+        {
+            glUnmapNamedBuffer(m_buffer);
+        }
+        else if (m_mapped)
+        {
+            GlState::Get().BindBuffer(m_bufferType, m_buffer);
+            glUnmapBuffer(m_bufferType);
+        }
+        glDeleteBuffers(1, &m_buffer);
+        GlState::Get().OnDeleteBuffer(m_buffer);
+    }
+}
+
+bool StreamBuffer::Init(uint32_t bufferType, size_t regionSize, int regionCount)
+{
+    m_bufferType = bufferType;
+    m_regionSize = regionSize;
+    m_regionCount = regionCount;
+    m_fences.assign(regionCount, nullptr);
+
+    size_t size = m_regionSize * m_regionCount;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        // GL 4.5면 buffer storage도 있으므로 항상 영구 매핑
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferStorage(m_buffer, size, nullptr, flags);
+        m_mapped = (uint8_t *)glMapNamedBufferRange(m_buffer, 0, size, flags);
+        if (!m_mapped)
+        {
+            // immutable storage는 glNamedBufferData로 바꿀 수 없으므로 buffer를 새로 만듦
+            SPDLOG_ERROR("failed to map stream buffer persistently, fallback to orphaning");
+            glDeleteBuffers(1, &m_buffer);
+            glCreateBuffers(1, &m_buffer);
+            glNamedBufferData(m_buffer, size, nullptr, GL_STREAM_DRAW);
+            m_staging.resize(m_regionSize);
+        }
+        return true;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    GlState::Get().BindBuffer(m_bufferType, m_buffer);
+    if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+    {
+        // coherent로 매핑해서 쓴 내용을 flush하지 않아도 GPU가 볼 수 있게 함
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(m_bufferType, size, nullptr, flags);
+        m_mapped = (uint8_t *)glMapBufferRange(m_bufferType, 0, size, flags);
+        if (!m_mapped)
+            SPDLOG_ERROR("failed to map stream buffer persistently, fallback to orphaning");
+    }
+    if (!m_mapped)
+    {
+        glBufferData(m_bufferType, size, nullptr, GL_STREAM_DRAW);
+        m_staging.resize(m_regionSize);
+    }
+    return true;
+}
+
+void *StreamBuffer::BeginWrite()
+{
+    if (m_mapped && m_region >= 0) // orphaning 경로는 driver가 동기화하므로 fence 불필요
+    {
+        if (m_fences[m_region])
+            glDeleteSync(m_fences[m_region]);
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_region = (m_region + 1) % m_regionCount;
+
+    // 이 구간을 마지막으로 읽은 draw가 끝날 때까지 대기. 구간이 충분하면 바로 signaled 상태
+    m_lastStallTime = 0.0f;
+    auto &fence = m_fences[m_region];
+    if (fence)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            m_stallCount++;
+            do
+            {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+            } while (result == GL_TIMEOUT_EXPIRED);
+            auto end = std::chrono::high_resolution_clock::now();
+            m_lastStallTime = std::chrono::duration<float, std::milli>(end - start).count();
+            m_totalStallTime += m_lastStallTime;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    return m_mapped ? m_mapped + GetOffset() : m_staging.data();
+}
+
+void StreamBuffer::EndWrite(size_t size)
+{
+    if (m_mapped)
+        return;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        if (m_region == 0)
+            glNamedBufferData(m_buffer, m_regionSize * m_regionCount, nullptr, GL_STREAM_DRAW);
+        glNamedBufferSubData(m_buffer, GetOffset(), size, m_staging.data());
+        return;
+    }
+    GlState::Get().BindBuffer(m_bufferType, m_buffer);
+    if (m_region == 0) // ring 한 바퀴마다 새 저장 공간으로 바꿔서 GPU가 읽는 구간과 겹치지 않게 함
+        glBufferData(m_bufferType, m_regionSize * m_regionCount, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(m_bufferType, GetOffset(), size, m_staging.data());
+}
@@ -13,6 +13,9 @@ public:
     size_t GetStride() const { return m_stride; }
     size_t GetCount() const { return m_count; }
     void Bind() const;
+    void SetData(const void *data, size_t stride, size_t count); // 내용 전체를 새로 지정 (크기가 바뀌어도 됨)
+    void SetSubData(size_t offset, const void *data, size_t size); // byte 단위 구간만 갱신. GPU가 아직 읽는 중이면 driver가 기다릴 수 있음
+    void Orphan(); // 같은 크기의 새 저장 공간으로 교체. 이전 내용은 사라지지만 GPU 사용이 끝날 때까지 기다리지 않음
 
 private:
     Buffer() {}
@@ -27,4 +30,48 @@ private:
     size_t m_count{0};
 };
 
+// 영구 매핑(GL_MAP_PERSISTENT_BIT)한 buffer를 regionCount개 구간으로 나눈 ring
+// 매 프레임 다음 구간에 쓰고, 그 구간을 마지막으로 읽은 draw가 끝났는지는 fence로 확인한다.
+// 구간이 3개면 GPU가 2 프레임 뒤처져도 기다리지 않고 쓸 수 있음.
+// GL 4.4 / ARB_buffer_storage가 없으면 orphaning + glBufferSubData로 대신한다.
+CLASS_PTR(StreamBuffer)
+class StreamBuffer
+{
+public:
+    static StreamBufferUPtr Create(uint32_t bufferType, size_t regionSize, int regionCount = 3);
+    ~StreamBuffer();
+
+    uint32_t Get() const { return m_buffer; }
+    bool IsPersistent() const { return m_mapped != nullptr; }
+    size_t GetRegionSize() const { return m_regionSize; }
+
+    // 다음 구간으로 넘어가서 쓸 수 있는 포인터를 반환. 직전 구간에는 fence를 걸어 둠
+    // (반환 후 직전 구간을 읽는 draw를 더 추가하면 안 됨)
+    void *BeginWrite();
+    void EndWrite(size_t size); // size byte를 썼음. 영구 매핑이 아니면 여기서 업로드
+    size_t GetOffset() const { return m_regionSize * m_region; } // 현재 구간의 buffer 안 byte 위치
+    int GetRegion() const { return m_region; }
+
+    float GetLastStallTime() const { return m_lastStallTime; } // ms, 마지막 BeginWrite에서 fence를 기다린 시간
+    float GetTotalStallTime() const { return m_totalStallTime; }
+    int GetStallCount() const { return m_stallCount; } // fence가 아직 끝나지 않아 기다려야 했던 횟수
+
+private:
+    StreamBuffer() {}
+    bool Init(uint32_t bufferType, size_t regionSize, int regionCount);
+
+    uint32_t m_buffer{0};
+    uint32_t m_bufferType{0};
+    size_t m_regionSize{0};
+    int m_regionCount{0};
+    int m_region{-1}; // 아직 한 번도 쓰지 않았으면 -1
+    uint8_t *m_mapped{nullptr};
+    std::vector<GLsync> m_fences;   // 구간별, 그 구간을 읽는 명령 뒤에 건 fence
+    std::vector<uint8_t> m_staging; // 영구 매핑을 못 쓸 때 CPU 쪽 구간
+
+    float m_lastStallTime{0.0f};
+    float m_totalStallTime{0.0f};
+    int m_stallCount{0};
+};
+
 #endif // __BUFFER_H__
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "bvh.h"
+#include <future>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BVH_USE_SSE
+#endif
+
+static const int kBinCount = 16;
+static const uint32_t kLeafSize = 4;           // 이 개수 이하면 더 나누지 않음
+static const uint32_t kParallelMinCount = 8192; // 이보다 큰 서브트리는 별도 스레드에서 구성
+static const int kParallelMaxDepth = 4;          // 최대 2^4개 스레드까지
+static const int kMaxDepth = 60;                 // traversal stack(64) 크기를 넘지 않도록 제한
+
+static float SurfaceArea(const glm::vec3 &min, const glm::vec3 &max)
+{
+    auto e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+BvhUPtr Bvh::Build(std::vector<BvhTriangle> triangles)
+{
+    auto bvh = BvhUPtr(new Bvh());
+    bvh->Init(std::move(triangles));
+    return std::move(bvh);
+}
+
+void Bvh::Init(std::vector<BvhTriangle> triangles)
+{
+    m_triangles = std::move(triangles);
+    if (m_triangles.empty())
+        return;
+
+    m_centroids.resize(m_triangles.size());
+    for (size_t i = 0; i < m_triangles.size(); i++)
+        m_centroids[i] = (m_triangles[i].v0 + m_triangles[i].v1 + m_triangles[i].v2) / 3.0f;
+
+    m_nodes.resize(m_triangles.size() * 2); // 노드 수는 최대 2N - 1
+    auto &root = m_nodes[0];
+    root.leftOrFirst = 0;
+    root.count = (uint32_t)m_triangles.size();
+    m_nodesUsed = 1;
+    UpdateBounds(0);
+    Subdivide(0, 0);
+
+    m_centroids.clear();
+    m_centroids.shrink_to_fit();
+}
+
+void Bvh::UpdateBounds(uint32_t nodeIndex)
+{
+    auto &node = m_nodes[nodeIndex];
+    node.min = glm::vec3(FLT_MAX);
+    node.max = glm::vec3(-FLT_MAX);
+    for (uint32_t i = 0; i < node.count; i++)
+    {
+        auto &tri = m_triangles[node.leftOrFirst + i];
+        node.min = glm::min(node.min, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+        node.max = glm::max(node.max, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+    }
+}
+
+bool Bvh::FindBestSplit(const BvhNode &node, int &axis, int &splitBin, float &cost) const
+{
+    glm::vec3 cmin(FLT_MAX), cmax(-FLT_MAX);
+    for (uint32_t i = 0; i < node.count; i++)
+    {
+        cmin = glm::min(cmin, m_centroids[node.leftOrFirst + i]);
+        cmax = glm::max(cmax, m_centroids[node.leftOrFirst + i]);
+    }
+
+    bool found = false;
+    cost = FLT_MAX;
+    for (int a = 0; a < 3; a++)
+    {
+        if (cmax[a] == cmin[a])
+            continue;
+
+        // 삼각형을 centroid 기준으로 bin에 나눠 담음
+        struct Bin
+        {
+            glm::vec3 min{glm::vec3(FLT_MAX)};
+            glm::vec3 max{glm::vec3(-FLT_MAX)};
+            uint32_t count{0};
+        } bins[kBinCount];
+        float scale = kBinCount / (cmax[a] - cmin[a]);
+        for (uint32_t i = 0; i < node.count; i++)
+        {
+            auto &tri = m_triangles[node.leftOrFirst + i];
+            int b = glm::min(kBinCount - 1, (int)((m_centroids[node.leftOrFirst + i][a] - cmin[a]) * scale));
+            bins[b].count++;
+            bins[b].min = glm::min(bins[b].min, glm::min(tri.v0, glm::min(tri.v1, tri.v2)));
+            bins[b].max = glm::max(bins[b].max, glm::max(tri.v0, glm::max(tri.v1, tri.v2)));
+        }
+
+        // 왼쪽/오른쪽에서 누적해 가며 각 분할 평면의 SAH 비용 계산
+        float leftArea[kBinCount - 1], rightArea[kBinCount - 1];
+        uint32_t leftCount[kBinCount - 1], rightCount[kBinCount - 1];
+        glm::vec3 lmin(FLT_MAX), lmax(-FLT_MAX), rmin(FLT_MAX), rmax(-FLT_MAX);
+        uint32_t lsum = 0, rsum = 0;
+        for (int i = 0; i < kBinCount - 1; i++)
+        {
+            lsum += bins[i].count;
+            leftCount[i] = lsum;
+            lmin = glm::min(lmin, bins[i].min);
+            lmax = glm::max(lmax, bins[i].max);
+            leftArea[i] = lsum ? SurfaceArea(lmin, lmax) : 0.0f;
+
+            int j = kBinCount - 1 - i;
+            rsum += bins[j].count;
+            rightCount[j - 1] = rsum;
+            rmin = glm::min(rmin, bins[j].min);
+            rmax = glm::max(rmax, bins[j].max);
+            rightArea[j - 1] = rsum ? SurfaceArea(rmin, rmax) : 0.0f;
+        }
+        for (int i = 0; i < kBinCount - 1; i++)
+        {
+            float c = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (leftCount[i] > 0 && rightCount[i] > 0 && c < cost)
+            {
+                cost = c;
+                axis = a;
+                splitBin = i;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+void Bvh::Subdivide(uint32_t nodeIndex, int depth)
+{
+    auto &node = m_nodes[nodeIndex];
+    if (node.count <= kLeafSize || depth >= kMaxDepth)
+        return;
+
+    int axis = 0, splitBin = 0;
+    float splitCost = 0.0f;
+    if (!FindBestSplit(node, axis, splitBin, splitCost))
+        return;
+    if (splitCost >= node.count * SurfaceArea(node.min, node.max)) // 나누는 것이 leaf로 두는 것보다 비싸면 중단
+        return;
+
+    // FindBestSplit과 같은 bin 계산으로 분할해서 부동소수 오차로 한쪽이 비는 것을 막음
+    float cmin = FLT_MAX, cmax = -FLT_MAX;
+    for (uint32_t i = 0; i < node.count; i++)
+    {
+        cmin = glm::min(cmin, m_centroids[node.leftOrFirst + i][axis]);
+        cmax = glm::max(cmax, m_centroids[node.leftOrFirst + i][axis]);
+    }
+    float scale = kBinCount / (cmax - cmin);
+    int i = (int)node.leftOrFirst;
+    int j = i + (int)node.count - 1;
+    while (i <= j)
+    {
+        int b = glm::min(kBinCount - 1, (int)((m_centroids[i][axis] - cmin) * scale));
+        if (b <= splitBin)
+        {
+            i++;
+        }
+        else
+        {
+            std::swap(m_triangles[i], m_triangles[j]);
+            std::swap(m_centroids[i], m_centroids[j]);
+            j--;
+        }
+    }
+    uint32_t leftCount = (uint32_t)i - node.leftOrFirst;
+    if (leftCount == 0 || leftCount == node.count)
+        return;
+
+    uint32_t leftIndex = m_nodesUsed.fetch_add(2);
+    auto &left = m_nodes[leftIndex];
+    auto &right = m_nodes[leftIndex + 1];
+    left.leftOrFirst = node.leftOrFirst;
+    left.count = leftCount;
+    right.leftOrFirst = (uint32_t)i;
+    right.count = node.count - leftCount;
+    node.leftOrFirst = leftIndex;
+    node.count = 0;
+    UpdateBounds(leftIndex);
+    UpdateBounds(leftIndex + 1);
+
+    // 두 서브트리는 서로 다른 삼각형 구간만 건드리므로 병렬로 구성 가능
+    if (depth < kParallelMaxDepth && left.count + right.count >= kParallelMinCount)
+    {
+        auto task = std::async(std::launch::async, [this, leftIndex, depth]()
+                               { Subdivide(leftIndex, depth + 1); });
+        Subdivide(leftIndex + 1, depth + 1);
+        task.wait();
+    }
+    else
+    {
+        Subdivide(leftIndex, depth + 1);
+        Subdivide(leftIndex + 1, depth + 1);
+    }
+}
+
+// Möller–Trumbore ray-triangle 교차
+static bool IntersectTriangle(const BvhTriangle &tri, const glm::vec3 &origin, const glm::vec3 &direction,
+                              float &t, float &u, float &v)
+{
+    auto e1 = tri.v1 - tri.v0;
+    auto e2 = tri.v2 - tri.v0;
+    auto p = glm::cross(direction, e2);
+    float det = glm::dot(e1, p);
+    if (glm::abs(det) < 1e-10f)
+        return false;
+    float invDet = 1.0f / det;
+    auto s = origin - tri.v0;
+    u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+    auto q = glm::cross(s, e1);
+    v = glm::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+    t = glm::dot(e2, q) * invDet;
+    return t > 1e-6f;
+}
+
+std::optional<BvhHit> Bvh::Intersect(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) const
+{
+    if (m_triangles.empty())
+        return {};
+
+    auto invDir = 1.0f / direction;
+
+#if defined(BVH_USE_SSE)
+    // 노드의 min(xyz + leftOrFirst), max(xyz + count)를 한 번에 읽어 slab test. 4번째 lane은 0을 곱해 무시한다.
+    const __m128 o4 = _mm_setr_ps(origin.x, origin.y, origin.z, 0.0f);
+    const __m128 inv4 = _mm_setr_ps(invDir.x, invDir.y, invDir.z, 0.0f);
+    auto intersectBox = [&](const BvhNode &node, float tFar) -> float
+    {
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.min.x), o4), inv4);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.max.x), o4), inv4);
+        __m128 vmin = _mm_min_ps(t1, t2);
+        __m128 vmax = _mm_max_ps(t1, t2);
+        vmin = _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 2, 1, 0)); // 4번째 lane을 z로 덮어씀
+        vmax = _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 2, 1, 0));
+        vmin = _mm_max_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+        vmin = _mm_max_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+        vmax = _mm_min_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+        vmax = _mm_min_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+        float tmin = _mm_cvtss_f32(vmin);
+        float tmax = _mm_cvtss_f32(vmax);
+        return (tmax >= tmin && tmin < tFar && tmax > 0.0f) ? tmin : FLT_MAX;
+    };
+#else
+    auto intersectBox = [&](const BvhNode &node, float tFar) -> float
+    {
+        auto t1 = (node.min - origin) * invDir;
+        auto t2 = (node.max - origin) * invDir;
+        auto vmin = glm::min(t1, t2);
+        auto vmax = glm::max(t1, t2);
+        float tmin = glm::max(vmin.x, glm::max(vmin.y, vmin.z));
+        float tmax = glm::min(vmax.x, glm::min(vmax.y, vmax.z));
+        return (tmax >= tmin && tmin < tFar && tmax > 0.0f) ? tmin : FLT_MAX;
+    };
+#endif
+
+    BvhHit hit{maxDistance, 0, 0, glm::vec3(0.0f)};
+    bool found = false;
+
+    uint32_t stack[64];
+    int stackSize = 0;
+    if (intersectBox(m_nodes[0], hit.distance) == FLT_MAX)
+        return {};
+    stack[stackSize++] = 0;
+    while (stackSize > 0)
+    {
+        auto &node = m_nodes[stack[--stackSize]];
+        if (node.count > 0) // leaf
+        {
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                auto &tri = m_triangles[node.leftOrFirst + i];
+                float t, u, v;
+                if (IntersectTriangle(tri, origin, direction, t, u, v) && t < hit.distance)
+                {
+                    hit = {t, tri.objectId, tri.triangleIndex, glm::vec3(1.0f - u - v, u, v)};
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // 가까운 자식을 먼저 방문하도록 먼 자식을 먼저 push
+        uint32_t nearChild = node.leftOrFirst, farChild = node.leftOrFirst + 1;
+        float tNear = intersectBox(m_nodes[nearChild], hit.distance);
+        float tFar = intersectBox(m_nodes[farChild], hit.distance);
+        if (tFar < tNear)
+        {
+            std::swap(nearChild, farChild);
+            std::swap(tNear, tFar);
+        }
+        if (tFar != FLT_MAX)
+            stack[stackSize++] = farChild;
+        if (tNear != FLT_MAX)
+            stack[stackSize++] = nearChild;
+    }
+
+    if (!found)
+        return {};
+    return hit;
+}
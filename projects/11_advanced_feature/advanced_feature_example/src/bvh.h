@@ -0,0 +1,57 @@
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include "common.h"
+#include <atomic>
+#include <cfloat>
+
+// BVH에 넣을 삼각형. objectId / triangleIndex로 어떤 오브젝트의 몇 번째 삼각형인지 되찾는다.
+struct BvhTriangle
+{
+    glm::vec3 v0, v1, v2;
+    uint32_t objectId;
+    uint32_t triangleIndex;
+};
+
+struct BvhHit
+{
+    float distance;
+    uint32_t objectId;
+    uint32_t triangleIndex;
+    glm::vec3 barycentric; // v0, v1, v2에 대한 가중치
+};
+
+// 32 byte 노드. count > 0이면 leaf(삼각형 [leftOrFirst, leftOrFirst + count)), 아니면 자식은 leftOrFirst, leftOrFirst + 1
+struct BvhNode
+{
+    glm::vec3 min;
+    uint32_t leftOrFirst;
+    glm::vec3 max;
+    uint32_t count;
+};
+
+CLASS_PTR(Bvh)
+class Bvh
+{
+public:
+    static BvhUPtr Build(std::vector<BvhTriangle> triangles); // binned SAH로 구성, 큰 서브트리는 여러 스레드에서 나눠서 만든다.
+
+    std::optional<BvhHit> Intersect(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance = FLT_MAX) const;
+
+    size_t GetNodeCount() const { return m_nodesUsed; }
+    size_t GetTriangleCount() const { return m_triangles.size(); }
+
+private:
+    Bvh() {}
+    void Init(std::vector<BvhTriangle> triangles);
+    void UpdateBounds(uint32_t nodeIndex);
+    void Subdivide(uint32_t nodeIndex, int depth);
+    bool FindBestSplit(const BvhNode &node, int &axis, int &splitBin, float &cost) const;
+
+    std::vector<BvhNode> m_nodes;
+    std::atomic<uint32_t> m_nodesUsed{0}; // 병렬로 만들 때 노드 두 개씩 할당
+    std::vector<BvhTriangle> m_triangles; // leaf 순서대로 재배치됨
+    std::vector<glm::vec3> m_centroids;
+};
+
+#endif // __BVH_H__
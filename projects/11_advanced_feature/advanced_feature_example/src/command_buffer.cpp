@@ -0,0 +1,90 @@
+#include "command_buffer.h"
+
+static constexpr UniformHandle kModelTransform("modelTransform");
+
+CommandBufferUPtr CommandBuffer::Create()
+{
+    return CommandBufferUPtr(new CommandBuffer());
+}
+
+void CommandBuffer::Reset()
+{
+    m_commands.clear();
+    m_transforms.clear();
+    m_drawCount = 0;
+    m_program = nullptr;
+    m_material = nullptr;
+    m_mesh = nullptr;
+    m_positionOnly = false;
+}
+
+void CommandBuffer::UseProgram(const Program *program)
+{
+    if (program == m_program)
+        return;
+    m_program = program;
+    m_material = nullptr; // uniform은 program마다 따로이므로 material을 다시 설정해야 함
+    m_commands.push_back({Op::UseProgram, 0, program});
+}
+
+void CommandBuffer::SetMaterial(const Material *material)
+{
+    if (!material || material == m_material)
+        return;
+    m_material = material;
+    m_commands.push_back({Op::SetMaterial, 0, material});
+}
+
+void CommandBuffer::BindMesh(const Mesh *mesh, bool positionOnly)
+{
+    if (mesh == m_mesh && positionOnly == m_positionOnly)
+        return;
+    m_mesh = mesh;
+    m_positionOnly = positionOnly;
+    m_commands.push_back({positionOnly ? Op::BindMeshPositionOnly : Op::BindMesh, 0, mesh});
+}
+
+void CommandBuffer::SetModelTransform(const glm::mat4 &transform)
+{
+    m_commands.push_back({Op::SetModelTransform, (uint32_t)m_transforms.size(), nullptr});
+    m_transforms.push_back(transform);
+}
+
+void CommandBuffer::Draw()
+{
+    m_commands.push_back({Op::Draw, 0, nullptr});
+    m_drawCount++;
+}
+
+void CommandBuffer::Execute() const
+{
+    const Program *program = nullptr;
+    const Mesh *mesh = nullptr;
+    for (auto &command : m_commands)
+    {
+        switch (command.op)
+        {
+        case Op::UseProgram:
+            program = (const Program *)command.object;
+            program->Use();
+            break;
+        case Op::SetMaterial:
+            ((const Material *)command.object)->SetToProgram(program);
+            break;
+        case Op::BindMesh:
+            mesh = (const Mesh *)command.object;
+            mesh->Bind();
+            break;
+        case Op::BindMeshPositionOnly:
+            mesh = (const Mesh *)command.object;
+            mesh->BindPositionOnly();
+            break;
+        case Op::SetModelTransform:
+            program->SetUniform(kModelTransform, m_transforms[command.transform]);
+            break;
+        case Op::Draw:
+            mesh->DrawCall();
+            break;
+        }
+    }
+}
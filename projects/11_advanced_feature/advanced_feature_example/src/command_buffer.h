@@ -0,0 +1,62 @@
+#ifndef __COMMAND_BUFFER_H__
+#define __COMMAND_BUFFER_H__
+
+#include "common.h"
+#include "mesh.h"
+
+// GL을 호출하지 않고 상태 변경과 draw를 기록해 두었다가 GL 스레드에서 기록한 순서대로 재생하는 buffer
+// 기록은 아무 스레드에서나 할 수 있으므로 scene을 나눠 buffer를 하나씩 맡기면 여러 스레드가 동시에 기록함
+// 명령과 transform은 vector에 이어서 쌓고, Reset해도 capacity가 남으므로 몇 프레임 뒤부터는 할당이 없음
+// 명령은 포인터만 가지므로 program / material / mesh는 Execute까지 살아 있어야 함
+CLASS_PTR(CommandBuffer)
+class CommandBuffer
+{
+public:
+    static CommandBufferUPtr Create();
+
+    void Reset(); // 기록한 명령을 비우고 기록 중 상태도 초기화
+
+    // 바로 앞에 기록한 것과 같은 상태는 다시 기록하지 않음
+    // SetMaterial, SetModelTransform, Draw 전에 UseProgram, Draw 전에 BindMesh가 있어야 함
+    void UseProgram(const Program *program);
+    void SetMaterial(const Material *material);
+    void BindMesh(const Mesh *mesh, bool positionOnly = false);
+    void SetModelTransform(const glm::mat4 &transform);
+    void Draw();
+
+    void Execute() const; // GL 스레드에서 호출
+
+    int GetCommandCount() const { return (int)m_commands.size(); }
+    int GetDrawCount() const { return m_drawCount; }
+
+private:
+    CommandBuffer() {}
+
+    enum class Op : uint8_t
+    {
+        UseProgram,
+        SetMaterial,
+        BindMesh,
+        BindMeshPositionOnly,
+        SetModelTransform,
+        Draw,
+    };
+    struct Command
+    {
+        Op op;
+        uint32_t transform; // SetModelTransform: m_transforms의 인덱스
+        const void *object; // program, material, mesh
+    };
+
+    std::vector<Command> m_commands;
+    std::vector<glm::mat4> m_transforms;
+    int m_drawCount{0};
+
+    // 기록 중인 상태
+    const Program *m_program{nullptr};
+    const Material *m_material{nullptr};
+    const Mesh *m_mesh{nullptr};
+    bool m_positionOnly{false};
+};
+
+#endif // __COMMAND_BUFFER_H__
@@ -1,9 +1,19 @@
 #include "context.h"
+#include "gl_state.h"
+#include "vertex_format.h"
 #include "image.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <glm/gtc/constants.hpp>
 #include <imgui.h> // common.h에 include하면 대부분의 코드는 common.h를 사용하기때문에 모든 파일에서 imgui 사용가능.
                    // context.h에 include하면 main.cpp와 context.cpp에서 imgui 사용가능.
                    // context.cpp에 include하면 context.cpp에서 사용가능. context.cpp에서만 사용할거기때문에 여기에 include.
 
+// 오브젝트마다 설정하는 uniform은 이름 hash를 컴파일 시간에 계산해 둠
+static constexpr UniformHandle kTransform("transform");
+static constexpr UniformHandle kModelTransform("modelTransform");
+
 ContextUPtr Context::Create()
 {
     auto context = ContextUPtr(new Context());
@@ -12,9 +22,18 @@ ContextUPtr Context::Create()
     return std::move(context);
 }
 
+Context::~Context()
+{
+    if (m_timerQuery)
+        glDeleteQueries(1, &m_timerQuery);
+}
+
 bool Context::Init()
 {
-    m_box = Mesh::CreateBox();
+    // 두 번째 실행부터는 링크된 program binary를 읽어서 컴파일을 건너뜀
+    Program::SetBinaryCacheDirectory("./shader_cache");
+
+    m_box = Mesh::CreateBox(true);
 
     // program 생성
     m_simpleProgram = Program::Create("./shader/simple.vs", "./shader/simple.fs");
@@ -22,11 +41,52 @@ bool Context::Init()
         return false;
     SPDLOG_INFO("program id: {}", m_simpleProgram->Get());
 
-    m_program = Program::Create("./shader/lighting.vs", "./shader/lighting.fs");
+    // camera / 광원 uniform block은 모든 program이 같은 binding point에서 읽음
+    m_frameUniforms = FrameUniformBuffer::Create();
+    if (!m_frameUniforms)
+        return false;
+
+    // program을 새로 만들 때마다 (hot reload 포함) 부르는 설정
+    auto fallbackSetup = [](const Program *program)
+    {
+        FrameUniformBuffer::BindBlocks(program);
+        program->Use();
+        program->SetUniform("color", glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+    };
+    auto skinningSetup = [](const Program *program)
+    {
+        program->SetUniformBlockBinding("BonePalette", kBonePaletteBinding);
+        FrameUniformBuffer::BindBlocks(program);
+    };
+    auto lightingSetup = [](const Program *program)
+    {
+        FrameUniformBuffer::BindBlocks(program);
+        MaterialTable::BindBlock(program); // MATERIAL_TABLE이 없는 variant에서는 아무 일도 하지 않음
+    };
 
-    if (!m_program)
+    // lighting program이 준비될 때까지 scene을 단색으로 그리는 program. 작아서 바로 컴파일
+    m_fallbackProgram = Program::Create("./shader/depth.vs", "./shader/simple.fs");
+    if (!m_fallbackProgram)
         return false;
-    SPDLOG_INFO("program id: {}", m_program->Get());
+    fallbackSetup(m_fallbackProgram.get());
+
+    // 나머지 program은 컴파일을 한꺼번에 요청만 해 두고 Render에서 완료를 확인
+    // 광원 종류에 따라 permutation을 골라 씀. POINT_LIGHT면 spot light 원뿔 계산이 빠짐
+    // MATERIAL_TABLE이면 material을 texture array와 uniform block에서 materialIndex로 찾음
+    m_lightingVariants = ProgramVariants::Create("./shader/lighting.vs", "./shader/lighting.fs",
+                                                 {"POINT_LIGHT", "MATERIAL_TABLE"}, lightingSetup);
+    m_lightingProgram = m_lightingVariants->Get(0);
+    if (!m_lightingProgram) // 컴파일 중이면 끝날 때까지 fallback으로 그림
+        m_lightingProgram = m_fallbackProgram.get();
+
+    // 준비되기 전에는 해당 기능을 그리지 않음
+    m_programCompiler = ProgramCompiler::Create();
+    m_programCompiler->Submit(&m_skinningProgram, "./shader/skinning.vs", "./shader/lighting.fs", {}, skinningSetup);
+    m_programCompiler->Submit(&m_vatProgram, "./shader/vat.vs", "./shader/lighting.fs", {}, FrameUniformBuffer::BindBlocks);
+    m_programCompiler->Submit(&m_instancedProgram, "./shader/lighting_instanced.vs", "./shader/lighting.fs", {},
+                              FrameUniformBuffer::BindBlocks);
+    m_programCompiler->Submit(&m_depthProgram, "./shader/depth.vs", "./shader/depth.fs", {}, FrameUniformBuffer::BindBlocks);
+    m_programCompiler->Submit(&m_depthInstancedProgram, "./shader/depth_instanced.vs", "./shader/depth.fs");
 
     glClearColor(0.0f, 0.1f, 0.2f, 0.0f); // 화면을 지울 색상 지정을 컬러버퍼에 설정.
 
@@ -66,11 +126,659 @@ bool Context::Init()
     m_box2Material->specular = Texture::CreateFromImage(Image::Load("./image/container2_specular.png").get());
     m_box2Material->shininess = 64.0f;
 
+    m_materialTable = MaterialTable::Create();
+    if (!m_materialTable)
+        return false;
+    for (auto &material : {m_planeMaterial, m_box1Material, m_box2Material})
+        m_materialTable->Add(material);
+
+    m_sceneObjects = {
+        {glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)) *
+             glm::scale(glm::mat4(1.0f), glm::vec3(10.0f, 1.0f, 10.0f)),
+         m_planeMaterial},
+        {glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, 0.75f, -4.0f)) *
+             glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
+             glm::scale(glm::mat4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f)),
+         m_box1Material},
+        {glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.7f, 2.0f)) *
+             glm::rotate(glm::mat4(1.0f), glm::radians(20.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
+             glm::scale(glm::mat4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f)),
+         m_box2Material},
+    };
+
+    m_renderQueue = RenderQueue::Create();
+    m_workerPool = WorkerPool::Create(std::max(std::thread::hardware_concurrency(), 1u));
+
+    // 정적인 오브젝트는 material별로 합쳐서 그림
+    m_baseObjectCount = (int)m_sceneObjects.size();
+    RebuildScene();
+
+    InitSkinning();
+    InitCubeAnimation();
+    glGenQueries(1, &m_timerQuery);
+
+    // shader / texture 파일을 고쳐서 저장하면 그 파일을 쓰는 object만 다시 만듦 (Linux에서만)
+    m_hotReloader = HotReloader::Create();
+    if (m_hotReloader)
+    {
+        // material table의 texture array에는 복사본이 있으므로 같이 갱신
+        auto onTextureReload = [this](const Texture *texture)
+        { m_materialTable->UpdateTexture(texture); };
+        m_hotReloader->WatchProgram(&m_simpleProgram, "./shader/simple.vs", "./shader/simple.fs");
+        m_hotReloader->WatchProgram(&m_fallbackProgram, "./shader/depth.vs", "./shader/simple.fs", {}, fallbackSetup);
+        m_hotReloader->WatchProgramVariants(m_lightingVariants.get());
+        m_hotReloader->WatchProgram(&m_skinningProgram, "./shader/skinning.vs", "./shader/lighting.fs", {}, skinningSetup);
+        m_hotReloader->WatchProgram(&m_vatProgram, "./shader/vat.vs", "./shader/lighting.fs", {}, FrameUniformBuffer::BindBlocks);
+        m_hotReloader->WatchProgram(&m_instancedProgram, "./shader/lighting_instanced.vs", "./shader/lighting.fs", {},
+                                    FrameUniformBuffer::BindBlocks);
+        m_hotReloader->WatchProgram(&m_depthProgram, "./shader/depth.vs", "./shader/depth.fs", {}, FrameUniformBuffer::BindBlocks);
+        m_hotReloader->WatchProgram(&m_depthInstancedProgram, "./shader/depth_instanced.vs", "./shader/depth.fs");
+        m_hotReloader->WatchTexture(m_planeMaterial->diffuse, "./image/marble.jpg", onTextureReload);
+        m_hotReloader->WatchTexture(m_box1Material->diffuse, "./image/container.jpg", onTextureReload);
+        m_hotReloader->WatchTexture(m_box2Material->diffuse, "./image/container2.png", onTextureReload);
+        m_hotReloader->WatchTexture(m_box2Material->specular, "./image/container2_specular.png", onTextureReload);
+    }
+
+    // 첫 BeginFrame 전이므로 지금까지의 호출 수는 리소스를 만드는 데 쓴 bind (direct state access면 대부분 사라짐)
+    auto &state = GlState::Get();
+    SPDLOG_INFO("init binds: vertex array {}, buffer {}, texture {} (direct state access: {})",
+                state.GetFrameCounter(GlState::VertexArrays).issued, state.GetFrameCounter(GlState::Buffers).issued,
+                state.GetFrameCounter(GlState::Textures).issued, state.IsDirectStateAccess() ? "on" : "off");
     return true;
 }
 
+void Context::BuildSceneBvh()
+{
+    // picking용 BVH: 오브젝트들의 삼각형을 world space로 옮겨서 구성
+    std::vector<Vertex> boxVertices;
+    std::vector<uint32_t> boxIndices;
+    Mesh::GetBoxGeometry(boxVertices, boxIndices);
+    std::vector<BvhTriangle> triangles;
+    for (uint32_t i = 0; i < (uint32_t)m_sceneObjects.size(); i++)
+    {
+        auto &transform = m_sceneObjects[i].transform;
+        auto position = [&](uint32_t index)
+        { return glm::vec3(transform * glm::vec4(boxVertices[index].position, 1.0f)); };
+        for (uint32_t t = 0; t < (uint32_t)boxIndices.size() / 3; t++)
+            triangles.push_back({position(boxIndices[3 * t]), position(boxIndices[3 * t + 1]), position(boxIndices[3 * t + 2]), i, t});
+    }
+    m_sceneBvh = Bvh::Build(std::move(triangles));
+    m_sceneBvhDirty = false;
+}
+
+void Context::RebuildScene()
+{
+    m_staticBatch = StaticBatch::Create();
+    std::vector<Vertex> boxVertices;
+    std::vector<uint32_t> boxIndices;
+    Mesh::GetBoxGeometry(boxVertices, boxIndices);
+    m_sceneBounds.Clear();
+    for (auto &object : m_sceneObjects)
+    {
+        m_staticBatch->Add(boxVertices, boxIndices, object.transform, object.material);
+        AddSceneBounds(object.transform);
+    }
+    m_staticBatch->Build();
+    BuildSceneBvh();
+}
+
+void Context::AddSceneBounds(const glm::mat4 &transform)
+{
+    m_sceneBounds.Add(m_box->GetAABB().Transform(transform), m_box->GetBoundingSphere().Transform(transform));
+}
+
+void Context::PopulateScene(int count)
+{
+    // 처음 만든 오브젝트만 남기고 count개의 상자를 넓게 흩어 놓음. 상자 수에 맞춰 영역을 넓혀 밀도를 비슷하게 유지
+    m_sceneObjects.resize(m_baseObjectCount);
+    float extent = glm::max(8.0f, sqrtf((float)count) * 1.5f);
+    for (int i = 0; i < count; i++)
+    {
+        auto position = glm::vec3(((float)rand() / RAND_MAX - 0.5f) * extent, 0.25f,
+                                  ((float)rand() / RAND_MAX - 0.5f) * extent);
+        auto transform = glm::translate(glm::mat4(1.0f), position) *
+                         glm::rotate(glm::mat4(1.0f), glm::radians((float)(rand() % 360)), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                         glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+        m_sceneObjects.push_back({transform, rand() % 2 ? m_box1Material : m_box2Material});
+    }
+    // 상자를 하나씩 추가할 때와 달리 batch와 BVH는 한 번만 다시 만듦
+    RebuildScene();
+    m_pickResult.reset(); // 이전 picking 결과의 오브젝트 번호는 더 이상 맞지 않음
+    SPDLOG_INFO("scene populated: #object: {}", m_sceneObjects.size());
+}
+
+void Context::AddSceneObject(const glm::mat4 &transform, MaterialPtr material)
+{
+    m_sceneObjects.push_back({transform, material});
+    AddSceneBounds(transform);
+
+    // 해당 material의 batch에 새로 붙은 구간만 올리고, BVH는 다음 picking 때 다시 만듦
+    std::vector<Vertex> boxVertices;
+    std::vector<uint32_t> boxIndices;
+    Mesh::GetBoxGeometry(boxVertices, boxIndices);
+    m_staticBatch->Add(boxVertices, boxIndices, transform, material);
+    m_staticBatch->Build();
+    m_sceneBvhDirty = true;
+}
+
+void Context::InitSkinning()
+{
+    // 세로로 선 원기둥에 bone 8개를 사슬로 연결한 촉수. 벤치마크용이라 외부 파일 없이 만든다.
+    const int boneCount = 8;
+    const int ringCount = 65;
+    const int sideCount = 24;
+    const float length = 2.0f;
+    const float segment = length / boneCount;
+
+    // node 0은 root, node i(1~8)가 bone i - 1. 각 bone은 부모에서 segment만큼 위
+    std::vector<SkeletonNode> nodes = {{"root", -1, glm::mat4(1.0f)}};
+    std::vector<SkeletonBone> bones;
+    for (int i = 0; i < boneCount; i++)
+    {
+        auto local = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, i == 0 ? 0.0f : segment, 0.0f));
+        nodes.push_back({fmt::format("bone{}", i), i, local});
+        bones.push_back({i + 1, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -segment * i, 0.0f))});
+    }
+    m_tentacleSkeleton = Skeleton::Create(std::move(nodes), std::move(bones));
+
+    std::vector<SkinnedVertex> vertices;
+    std::vector<uint32_t> indices;
+    for (int r = 0; r < ringCount; r++)
+    {
+        float v = (float)r / (ringCount - 1);
+        float y = v * length;
+        float radius = glm::mix(0.15f, 0.03f, v);
+
+        // 가장 가까운 두 bone 사이를 선형으로 섞음
+        float t = glm::clamp(y / segment - 0.5f, 0.0f, (float)(boneCount - 1));
+        int bone = std::min((int)t, boneCount - 2);
+        float blend = glm::clamp(t - bone, 0.0f, 1.0f);
+        for (int s = 0; s <= sideCount; s++)
+        {
+            float angle = glm::two_pi<float>() * s / sideCount;
+            SkinnedVertex vertex;
+            vertex.normal = glm::vec3(cosf(angle), 0.0f, sinf(angle));
+            vertex.position = glm::vec3(vertex.normal.x * radius, y, vertex.normal.z * radius);
+            vertex.texCoord = glm::vec2((float)s / sideCount, v);
+            vertex.boneIds = glm::ivec4(bone, bone + 1, 0, 0);
+            vertex.boneWeights = glm::vec4(1.0f - blend, blend, 0.0f, 0.0f);
+            vertices.push_back(vertex);
+        }
+    }
+    for (int r = 0; r + 1 < ringCount; r++)
+    {
+        for (int s = 0; s < sideCount; s++)
+        {
+            uint32_t i0 = r * (sideCount + 1) + s;
+            uint32_t i1 = i0 + sideCount + 1;
+            indices.insert(indices.end(), {i0, i1, i0 + 1, i0 + 1, i1, i1 + 1});
+        }
+    }
+    m_tentacleMesh = SkinnedMesh::Create(vertices, indices);
+    m_tentacleMesh->SetMaterial(m_box1Material);
+
+    // bone마다 위상이 다른 z축 흔들림, 16 tick을 초당 8 tick으로 재생 (2초 반복)
+    const int keyCount = 17;
+    std::vector<AnimationChannel> channels;
+    for (int i = 0; i < boneCount; i++)
+    {
+        AnimationChannel channel;
+        channel.node = i + 1;
+        channel.positions.push_back({0.0f, glm::vec3(0.0f, i == 0 ? 0.0f : segment, 0.0f)});
+        for (int k = 0; k < keyCount; k++)
+        {
+            float phase = glm::two_pi<float>() * k / (keyCount - 1);
+            float angle = 0.35f * sinf(phase + 0.7f * i);
+            channel.rotations.push_back({(float)k, glm::angleAxis(angle, glm::vec3(0.0f, 0.0f, 1.0f))});
+        }
+        channels.push_back(std::move(channel));
+    }
+    m_tentacleAnimation = Animation::Create("wave", (float)(keyCount - 1), 8.0f, channels);
+
+    m_bonePalettes = BonePaletteBuffer::Create(boneCount);
+
+    // 군중용으로 같은 키에 진폭만 키워 빠르게 재생하는 clip을 하나 더 만들어 두 clip을 구움
+    for (auto &channel : channels)
+    {
+        for (auto &key : channel.rotations)
+            key.value = glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), key.value, 2.0f);
+    }
+    auto curlAnimation = Animation::Create("curl", (float)(keyCount - 1), 16.0f, std::move(channels));
+    auto baked = VertexAnimation::Bake(vertices, indices, *m_tentacleSkeleton,
+                                       {m_tentacleAnimation.get(), curlAnimation.get()}, 30.0f);
+    if (baked)
+        m_crowd = VertexAnimation::Create(*baked, m_box1Material);
+}
+
+void Context::SetupCrowd(int count)
+{
+    // 상자들 오른쪽 바닥 위의 격자. clip과 시작 시점을 인스턴스마다 다르게
+    int columns = (int)ceilf(sqrtf((float)count));
+    int clipCount = (int)m_crowd->GetClips().size();
+    std::vector<glm::mat4> transforms(count);
+    std::vector<glm::vec2> clipTimes(count);
+    for (int i = 0; i < count; i++)
+    {
+        transforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3(6.0f + 0.4f * (i % columns), -0.1f, 5.0f - 0.4f * (i / columns)));
+        clipTimes[i] = glm::vec2((float)(i % clipCount), 0.173f * i);
+    }
+    m_crowd->SetInstances(transforms, clipTimes);
+    m_crowdInstanceCount = count;
+}
+
+void Context::InitCubeAnimation()
+{
+    // 예전 예제처럼 (1, 0.5, 0)축으로 도는 clip, 통통 튀는 clip, 원을 그리는 clip
+    const float cubeScale = 0.4f;
+    const int keyCount = 24;
+    std::vector<glm::vec3> positions(keyCount), scales(keyCount);
+    std::vector<glm::quat> rotations(keyCount);
+    m_cubeAnimation = TransformAnimation::Create();
+
+    for (int k = 0; k < keyCount; k++)
+    {
+        positions[k] = glm::vec3(0.0f);
+        rotations[k] = glm::angleAxis(glm::two_pi<float>() * k / keyCount, glm::normalize(glm::vec3(1.0f, 0.5f, 0.0f)));
+        scales[k] = glm::vec3(cubeScale);
+    }
+    m_cubeAnimation->AddClip("spin", 8.0f, positions, rotations, scales);
+
+    for (int k = 0; k < keyCount; k++)
+    {
+        float phase = glm::pi<float>() * k / keyCount;
+        float height = sinf(phase);
+        float squash = 0.3f * std::max(1.0f - 4.0f * height, 0.0f); // 바닥에 닿을 때 납작해짐
+        positions[k] = glm::vec3(0.0f, height, 0.0f);
+        rotations[k] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        scales[k] = cubeScale * glm::vec3(1.0f + squash, 1.0f - squash, 1.0f + squash);
+    }
+    m_cubeAnimation->AddClip("bounce", 24.0f, positions, rotations, scales);
+
+    for (int k = 0; k < keyCount; k++)
+    {
+        float angle = glm::two_pi<float>() * k / keyCount;
+        positions[k] = 0.3f * glm::vec3(cosf(angle), 0.0f, sinf(angle));
+        rotations[k] = glm::angleAxis(-angle, glm::vec3(0.0f, 1.0f, 0.0f));
+        scales[k] = glm::vec3(cubeScale);
+    }
+    m_cubeAnimation->AddClip("orbit", 12.0f, positions, rotations, scales);
+
+    m_animatedBox = Mesh::CreateBox(true); // depth prepass는 위치 stream으로 (depth_instanced.vs)
+    m_animatedBox->SetMaterial(m_box2Material);
+}
+
+void Context::SetupAnimatedCubes(int count)
+{
+    // 상자들 뒤쪽 공중의 격자. clip, 속도, 시작 시점을 node마다 다르게
+    int columns = (int)ceilf(sqrtf((float)count));
+    int clipCount = m_cubeAnimation->GetClipCount();
+    m_cubeAnimation->ClearNodes();
+    for (int i = 0; i < count; i++)
+    {
+        auto offset = glm::vec3(1.2f * (i % columns - columns / 2), 3.0f, -10.0f - 1.2f * (i / columns));
+        m_cubeAnimation->AddNode(i % clipCount, 0.37f * i, 0.8f + 0.05f * (i % 9), offset);
+    }
+    m_cubeTransforms.resize(count);
+    m_cubeNodeCount = count;
+}
+
+void Context::UpdateWave(float time)
+{
+    const int resolution = 128;
+    const float size = 4.0f;
+    if (!m_waveMesh || m_waveMeshMode != m_waveUpdateMode)
+    {
+        std::vector<uint32_t> indices;
+        for (int z = 0; z < resolution; z++)
+        {
+            for (int x = 0; x < resolution; x++)
+            {
+                uint32_t i0 = z * (resolution + 1) + x;
+                uint32_t i1 = i0 + resolution + 1;
+                indices.insert(indices.end(), {i0, i1, i0 + 1, i0 + 1, i1, i1 + 1});
+            }
+        }
+        m_waveVertices.assign((resolution + 1) * (resolution + 1), Vertex{});
+        m_waveMesh = Mesh::CreateDynamic(m_waveVertices, indices, GL_TRIANGLES, (MeshUpdateMode)m_waveUpdateMode);
+        m_waveMesh->SetMaterial(m_planeMaterial);
+        m_waveMeshMode = m_waveUpdateMode;
+    }
+
+    // y = a * sin(kx + t) * cos(kz + 0.7t), normal은 편미분으로 계산
+    const float amplitude = 0.15f;
+    const float frequency = 3.0f;
+    for (int z = 0; z <= resolution; z++)
+    {
+        for (int x = 0; x <= resolution; x++)
+        {
+            float u = (float)x / resolution;
+            float v = (float)z / resolution;
+            float px = (u - 0.5f) * size;
+            float pz = (v - 0.5f) * size;
+            float sx = sinf(frequency * px + time), cx = cosf(frequency * px + time);
+            float sz = sinf(frequency * pz + 0.7f * time), cz = cosf(frequency * pz + 0.7f * time);
+            auto &vertex = m_waveVertices[z * (resolution + 1) + x];
+            vertex.position = glm::vec3(px, amplitude * sx * cz, pz);
+            vertex.normal = glm::normalize(glm::vec3(-amplitude * frequency * cx * cz, 1.0f, amplitude * frequency * sx * sz));
+            vertex.texCoord = glm::vec2(u, v);
+        }
+    }
+    m_waveMesh->UpdateVertices(m_waveVertices.data(), m_waveVertices.size());
+}
+
+void Context::RenderSceneDirect(float time)
+{
+    const size_t objectCount = m_sceneObjects.size();
+    if (m_depthPrepass && m_depthProgram)
+    {
+        GlState::Get().ColorMask(false, false, false, false);
+        m_depthProgram->Use();
+        if (m_staticBatching)
+        {
+            m_depthProgram->SetUniform(kModelTransform, glm::mat4(1.0f));
+            m_staticBatch->DrawPositionOnly();
+        }
+        else
+        {
+            for (size_t i = 0; i < objectCount; i++)
+            {
+                if (!m_sceneVisible[i])
+                    continue;
+                m_depthProgram->SetUniform(kModelTransform, m_sceneObjects[i].transform);
+                m_box->DrawPositionOnly();
+            }
+        }
+        GlState::Get().ColorMask(true, true, true, true);
+        GlState::Get().DepthFunc(GL_LEQUAL);
+    }
+
+    m_lightingProgram->Use();
+    if (m_staticBatching)
+    {
+        // 정점이 이미 world space에 있으므로 material당 draw call 하나
+        m_lightingProgram->SetUniform(kModelTransform, glm::mat4(1.0f));
+        m_staticBatch->Draw(m_lightingProgram);
+    }
+    else
+    {
+        for (size_t i = 0; i < objectCount; i++)
+        {
+            if (!m_sceneVisible[i])
+                continue;
+            auto &object = m_sceneObjects[i];
+            m_lightingProgram->SetUniform(kModelTransform, object.transform);
+            object.material->SetToProgram(m_lightingProgram);
+            m_box->Draw(m_lightingProgram);
+        }
+    }
+    GlState::Get().DepthFunc(GL_LESS);
+
+    if (m_waveEnabled)
+    {
+        UpdateWave(time);
+        auto modelTransform = glm::translate(glm::mat4(1.0f), glm::vec3(-8.0f, 0.0f, 0.0f));
+        m_lightingProgram->Use();
+        m_lightingProgram->SetUniform(kModelTransform, modelTransform);
+        m_waveMesh->Draw(m_lightingProgram);
+    }
+}
+
+void Context::RenderSceneQueued(float time)
+{
+    // sort key의 depth는 카메라에서 오브젝트 원점까지의 거리를 far plane(300)으로 나눈 값
+    auto depthOf = [&](const glm::mat4 &transform)
+    { return glm::length(glm::vec3(transform[3]) - m_cameraPos) / 300.0f; };
+
+    bool prepass = m_depthPrepass && m_depthProgram;
+    m_renderQueue->Clear();
+    if (m_staticBatching)
+    {
+        if (prepass)
+            m_staticBatch->Submit(m_renderQueue.get(), RenderQueue::DepthPrepass, m_depthProgram.get());
+        m_staticBatch->Submit(m_renderQueue.get(), RenderQueue::Opaque, m_lightingProgram);
+    }
+    else
+    {
+        for (size_t i = 0; i < m_sceneObjects.size(); i++)
+        {
+            if (!m_sceneVisible[i])
+                continue;
+            auto &object = m_sceneObjects[i];
+            float depth = depthOf(object.transform);
+            if (prepass)
+                m_renderQueue->Submit(RenderQueue::DepthPrepass, m_depthProgram.get(), nullptr,
+                                      m_box.get(), object.transform, depth);
+            m_renderQueue->Submit(RenderQueue::Opaque, m_lightingProgram, object.material.get(),
+                                  m_box.get(), object.transform, depth);
+        }
+    }
+    if (m_waveEnabled)
+    {
+        UpdateWave(time);
+        auto modelTransform = glm::translate(glm::mat4(1.0f), glm::vec3(-8.0f, 0.0f, 0.0f));
+        m_renderQueue->Submit(RenderQueue::Opaque, m_lightingProgram, m_waveMesh->GetMaterial().get(),
+                              m_waveMesh.get(), modelTransform, depthOf(modelTransform));
+    }
+    m_renderQueue->Sort();
+
+    if (prepass)
+    {
+        GlState::Get().ColorMask(false, false, false, false);
+        m_renderQueue->Execute(RenderQueue::DepthPrepass);
+        GlState::Get().ColorMask(true, true, true, true);
+        GlState::Get().DepthFunc(GL_LEQUAL);
+    }
+    m_renderQueue->Execute(RenderQueue::Opaque);
+    GlState::Get().DepthFunc(GL_LESS);
+}
+
+void Context::RenderSceneParallel(const glm::mat4 &viewProjection, float time)
+{
+    // worker를 깨우는 비용보다 기록이 싸지 않도록 task당 최소 오브젝트 수를 둠
+    static const size_t kMinObjectsPerTask = 256;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool prepass = m_depthPrepass && m_depthProgram;
+    bool culling = m_frustumCulling;
+    auto frustum = Frustum::FromMatrix(viewProjection);
+    size_t objectCount = m_sceneObjects.size();
+    size_t threadCount = m_recordThreadLimit > 0 ? (size_t)m_recordThreadLimit : m_workerPool->GetThreadCount();
+    size_t taskCount = std::max<size_t>(std::min(threadCount, objectCount / kMinObjectsPerTask), 1);
+    while (m_sceneCommands.size() < taskCount)
+    {
+        m_depthCommands.push_back(CommandBuffer::Create());
+        m_sceneCommands.push_back(CommandBuffer::Create());
+    }
+    m_recordCullStats.resize(taskCount);
+
+    // task마다 연속된 범위를 culling하고 기록하므로 buffer를 task 순서대로 재생하면 한 스레드에서 그린 것과 순서가 같음
+    // CullBounds가 8개씩 검사하므로 경계는 8의 배수로 맞춤
+    auto rangeBegin = [&](size_t task)
+    { return task == taskCount ? objectCount : (objectCount * task / taskCount) & ~(size_t)7; };
+    auto record = [&](size_t task)
+    {
+        size_t begin = rangeBegin(task);
+        size_t end = rangeBegin(task + 1);
+        m_recordCullStats[task].Reset();
+        if (culling)
+            CullBounds(frustum, m_sceneBounds, m_sceneVisible, begin, end, &m_recordCullStats[task]);
+
+        auto depthCommands = m_depthCommands[task].get();
+        auto sceneCommands = m_sceneCommands[task].get();
+        depthCommands->Reset();
+        sceneCommands->Reset();
+        if (prepass)
+        {
+            depthCommands->UseProgram(m_depthProgram.get());
+            depthCommands->BindMesh(m_box.get(), true);
+        }
+        sceneCommands->UseProgram(m_lightingProgram);
+        sceneCommands->BindMesh(m_box.get());
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!m_sceneVisible[i])
+                continue;
+            auto &object = m_sceneObjects[i];
+            if (prepass)
+            {
+                depthCommands->SetModelTransform(object.transform);
+                depthCommands->Draw();
+            }
+            sceneCommands->SetMaterial(object.material.get());
+            sceneCommands->SetModelTransform(object.transform);
+            sceneCommands->Draw();
+        }
+    };
+    m_workerPool->Run(taskCount, record);
+    for (size_t i = 0; i < taskCount; i++)
+    {
+        m_cullStats.tested += m_recordCullStats[i].tested;
+        m_cullStats.culled += m_recordCullStats[i].culled;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_recordTime = std::chrono::duration<float, std::milli>(end - start).count();
+    m_recordTaskCount = (int)taskCount;
+
+    if (prepass)
+    {
+        GlState::Get().ColorMask(false, false, false, false);
+        for (size_t i = 0; i < taskCount; i++)
+            m_depthCommands[i]->Execute();
+        GlState::Get().ColorMask(true, true, true, true);
+        GlState::Get().DepthFunc(GL_LEQUAL);
+    }
+    for (size_t i = 0; i < taskCount; i++)
+        m_sceneCommands[i]->Execute();
+    GlState::Get().DepthFunc(GL_LESS);
+
+    // 물결은 GL 스레드에서 정점을 올려야 하므로 바로 그림
+    if (m_waveEnabled)
+    {
+        UpdateWave(time);
+        auto modelTransform = glm::translate(glm::mat4(1.0f), glm::vec3(-8.0f, 0.0f, 0.0f));
+        m_lightingProgram->Use();
+        m_lightingProgram->SetUniform(kModelTransform, modelTransform);
+        m_waveMesh->Draw(m_lightingProgram);
+    }
+}
+
+void Context::RenderSkinning(const glm::mat4 &viewProjection, float time)
+{
+    static const int kBenchmarkCounts[] = {1, 10, 100, 1000};
+    static const int kBenchmarkFrames = 120;
+    if (m_benchmarkStep >= 0)
+    {
+        m_characterCount = kBenchmarkCounts[m_benchmarkStep / 2];
+        m_gpuSkinning = m_benchmarkStep % 2 == 1;
+    }
+
+    // 이전 프레임의 GPU 시간. 결과가 준비되었을 때만 읽어서 대기하지 않음
+    if (m_timerQueryPending)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &elapsed);
+            m_skinningGpuTime = (float)(elapsed / 1.0e6);
+            m_timerQueryPending = false;
+            if (m_benchmarkStep >= 0 && m_benchmarkFrame > 0)
+            {
+                m_benchmarkGpuSum += m_skinningGpuTime;
+                m_benchmarkGpuSamples++;
+            }
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const int boneCount = m_tentacleSkeleton->GetBoneCount();
+    m_palettes.resize((size_t)m_characterCount * boneCount);
+    for (int i = 0; i < m_characterCount; i++)
+    {
+        // 캐릭터마다 시작 시점을 어긋나게 해서 같은 pose가 되지 않도록 함
+        m_tentacleAnimation->Evaluate(time + 0.173f * i, *m_tentacleSkeleton, m_localTransforms);
+        m_tentacleSkeleton->ComputePalette(m_localTransforms.data(), &m_palettes[(size_t)i * boneCount]);
+    }
+    if (m_gpuSkinning)
+        m_bonePalettes->Upload(m_palettes.data(), m_characterCount);
+    else
+        m_tentacleMesh->SkinOnCpu(m_palettes.data(), boneCount, m_characterCount);
+    auto end = std::chrono::high_resolution_clock::now();
+    m_skinningCpuTime = std::chrono::duration<float, std::milli>(end - start).count();
+
+    bool measure = !m_timerQueryPending;
+    if (measure)
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+
+    auto program = m_gpuSkinning ? m_skinningProgram.get() : m_lightingProgram;
+    program->Use();
+    int columns = (int)ceilf(sqrtf((float)m_characterCount));
+    for (int i = 0; i < m_characterCount; i++)
+    {
+        // 바닥 위 격자에 배치
+        auto modelTransform = glm::translate(glm::mat4(1.0f),
+                                             glm::vec3(0.5f * (i % columns - columns / 2), 0.0f, -2.0f - 0.5f * (i / columns)));
+        program->SetUniform(kTransform, viewProjection * modelTransform);
+        program->SetUniform(kModelTransform, modelTransform);
+        if (m_gpuSkinning)
+        {
+            m_bonePalettes->Bind(i);
+            m_tentacleMesh->DrawGpu(program);
+        }
+        else
+        {
+            m_tentacleMesh->DrawCpu(program, i);
+        }
+    }
+
+    if (measure)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_timerQueryPending = true;
+    }
+
+    if (m_benchmarkStep < 0)
+        return;
+    // 첫 프레임은 buffer 크기가 바뀌는 등 준비 비용이 섞이므로 제외
+    if (m_benchmarkFrame > 0)
+        m_benchmarkCpuSum += m_skinningCpuTime;
+    if (++m_benchmarkFrame <= kBenchmarkFrames)
+        return;
+    SPDLOG_INFO("skinning benchmark: {} x{}, cpu {:.3f} ms, gpu {:.3f} ms",
+                m_gpuSkinning ? "gpu" : "cpu", m_characterCount,
+                m_benchmarkCpuSum / kBenchmarkFrames,
+                m_benchmarkGpuSamples > 0 ? m_benchmarkGpuSum / m_benchmarkGpuSamples : 0.0);
+    m_benchmarkFrame = 0;
+    m_benchmarkCpuSum = 0.0;
+    m_benchmarkGpuSum = 0.0;
+    m_benchmarkGpuSamples = 0;
+    if (++m_benchmarkStep >= 2 * (int)(sizeof(kBenchmarkCounts) / sizeof(kBenchmarkCounts[0])))
+        m_benchmarkStep = -1;
+}
+
+// 다른 옵션 때문에 지금은 효과가 없는 checkbox는 흐리게 그리고 이유를 옆에 표시 (1.82에는 BeginDisabled가 없음)
+static void OverriddenCheckbox(const char *label, bool *value, bool overridden, const char *reason)
+{
+    if (overridden)
+        ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+    ImGui::Checkbox(label, value);
+    if (overridden)
+    {
+        ImGui::PopStyleVar();
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%s)", reason);
+    }
+}
+
 void Context::Render()
 {
+    GlState::Get().BeginFrame();
+    m_programCompiler->Poll();
+    if (m_hotReloader)
+        m_hotReloader->Update();
+
     if (ImGui::Begin("ui window")) // begin ~ end사이의 코드가 imgui 윈도우 내용, my first ImGui window가 제목.
                                    // 윈도우를 접으면 ImGui::Begin()의 값이 false가 되고 if문 안의 내용이 실행되지 않는다.
     {
@@ -90,6 +798,12 @@ void Context::Render()
             m_cameraPitch = 0.0f;
             m_cameraPos = glm::vec3(0.0f, 0.0f, 3.0f);
         }
+        if (m_programCompiler->GetPendingCount() > 0 || m_lightingProgram == m_fallbackProgram.get())
+            ImGui::Text("compiling programs... (%d pending)", m_programCompiler->GetPendingCount());
+        if (m_programCompiler->GetFailedCount() > 0)
+            ImGui::Text("failed programs: %d", m_programCompiler->GetFailedCount());
+        if (m_hotReloader && m_hotReloader->GetReloadCount() > 0)
+            ImGui::Text("hot reloads: %d, last %.3f ms", m_hotReloader->GetReloadCount(), m_hotReloader->GetLastReloadTime());
 
         // ImGuiTreeNodeFlags_DefaultOpen를 ImGui::CollapsingHeader의 두번째 인자로 주면 처음에 접혀있지 않고 열려있음.
         if (ImGui::CollapsingHeader("light", ImGuiTreeNodeFlags_DefaultOpen))
@@ -97,6 +811,9 @@ void Context::Render()
             ImGui::DragFloat3("l.position", glm::value_ptr(m_light.position), 0.01f);
             ImGui::DragFloat3("l.direction", glm::value_ptr(m_light.direction), 0.01f);
             ImGui::DragFloat2("l.cutoff", glm::value_ptr(m_light.cutoff), 0.5f, 0.0f, 180.0f); // max 값이 180.0f가 되면 point light랑 같아짐.
+            ImGui::Text("lighting variants: %d", m_lightingVariants->GetVariantCount());
+            ImGui::Checkbox("material table", &m_materialTableEnabled);
+            ImGui::Text("materials: %d, texture layers: %d", m_materialTable->GetMaterialCount(), m_materialTable->GetLayerCount());
             ImGui::DragFloat("l.distance", &m_light.distance, 0.5f, 0.0f, 3000.0f);
             ImGui::ColorEdit3("l.ambient", glm::value_ptr(m_light.ambient));
             ImGui::ColorEdit3("l.diffuse", glm::value_ptr(m_light.diffuse));
@@ -105,6 +822,140 @@ void Context::Render()
         }
 
         ImGui::Checkbox("animation", &m_animation);
+        ImGui::Checkbox("depth prepass", &m_depthPrepass);
+
+        if (ImGui::CollapsingHeader("static batching"))
+        {
+            ImGui::Checkbox("static batch", &m_staticBatching);
+            ImGui::Text("objects: %d, draw calls: %d", m_staticBatch->GetObjectCount(),
+                        m_staticBatching ? m_staticBatch->GetBatchCount() : (int)m_sceneObjects.size());
+            ImGui::Text("last build: %d batches, %.3f ms", m_staticBatch->GetLastRebuildCount(), m_staticBatch->GetLastBuildTime());
+            if (ImGui::Button("add box"))
+            {
+                // 바닥 위의 임의 위치에 상자를 하나 추가
+                auto position = glm::vec3((float)(rand() % 80) / 10.0f - 4.0f, 0.25f, (float)(rand() % 80) / 10.0f - 4.0f);
+                auto transform = glm::translate(glm::mat4(1.0f), position) *
+                                 glm::rotate(glm::mat4(1.0f), glm::radians((float)(rand() % 360)), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                                 glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+                AddSceneObject(transform, rand() % 2 ? m_box1Material : m_box2Material);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("render queue")) // 정렬한 뒤 실제로 바뀐 상태 수
+        {
+            OverriddenCheckbox("sort draws", &m_renderQueueEnabled, m_parallelRecording && !m_staticBatching,
+                               "ignored while parallel recording is on");
+            auto &stats = m_renderQueue->GetStats();
+            ImGui::Text("packets: %d", stats.packets);
+            ImGui::Text("program: %d, material: %d, mesh: %d changes",
+                        stats.programChanges, stats.materialChanges, stats.meshChanges);
+        }
+
+        if (ImGui::CollapsingHeader("command buffers")) // static batch가 꺼져 있을 때만 사용
+        {
+            OverriddenCheckbox("parallel recording", &m_parallelRecording, m_staticBatching,
+                               "ignored while static batch is on");
+            int commandCount = 0;
+            for (size_t i = 0; i < (size_t)m_recordTaskCount; i++)
+                commandCount += m_depthCommands[i]->GetCommandCount() + m_sceneCommands[i]->GetCommandCount();
+            ImGui::Text("threads: %d, commands: %d", m_recordTaskCount, commandCount);
+            ImGui::Text("record time: %.3f ms", m_recordTime);
+            ImGui::SliderInt("max threads (0: all cores)", &m_recordThreadLimit, 0, 32);
+            // 상자를 한꺼번에 배치 (batch와 BVH는 한 번만 다시 만듦)
+            ImGui::SliderInt("boxes", &m_populateCount, 0, 100000);
+            if (ImGui::Button("populate"))
+                PopulateScene(m_populateCount);
+        }
+
+        if (ImGui::CollapsingHeader("gl state")) // 지난 프레임에 실제로 호출한 수 / 같은 상태라서 생략한 수
+        {
+            auto &state = GlState::Get();
+            ImGui::Text("direct state access: %s", state.IsDirectStateAccess() ? "on" : "off");
+            if (VertexFormatRegistry::Get().IsEnabled())
+                ImGui::Text("shared vertex arrays: %d formats", VertexFormatRegistry::Get().GetFormatCount());
+            for (int i = 0; i < GlState::CategoryCount; i++)
+            {
+                auto category = (GlState::Category)i;
+                auto &counter = state.GetLastFrameCounter(category);
+                ImGui::Text("%s: issued %d, skipped %d", GlState::GetCategoryName(category), counter.issued, counter.skipped);
+            }
+        }
+        if (ImGui::CollapsingHeader("culling"))
+        {
+            // static batch는 통째로 그리므로 오브젝트별로 검사하지 않음
+            OverriddenCheckbox("frustum culling", &m_frustumCulling, m_staticBatching,
+                               "ignored while static batch is on");
+            ImGui::Text("tested: %d, culled: %d", m_cullStats.tested, m_cullStats.culled); // 이전 프레임 결과
+        }
+
+        if (ImGui::CollapsingHeader("picking")) // 왼쪽 클릭으로 선택
+        {
+            if (m_pickResult)
+            {
+                ImGui::Text("object: %u, triangle: %u", m_pickResult->objectId, m_pickResult->triangleIndex);
+                ImGui::Text("barycentric: (%.3f, %.3f, %.3f)", m_pickResult->barycentric.x, m_pickResult->barycentric.y, m_pickResult->barycentric.z);
+                ImGui::Text("distance: %.3f", m_pickResult->distance);
+            }
+            else
+            {
+                ImGui::Text("no hit");
+            }
+            ImGui::Text("pick time: %.2f us", m_pickTime);
+        }
+
+        if (ImGui::CollapsingHeader("skinning"))
+        {
+            ImGui::Checkbox("skinned characters", &m_skinning);
+            ImGui::SliderInt("characters", &m_characterCount, 1, 1000);
+            if (ImGui::RadioButton("cpu", !m_gpuSkinning))
+                m_gpuSkinning = false;
+            ImGui::SameLine();
+            if (ImGui::RadioButton("gpu", m_gpuSkinning))
+                m_gpuSkinning = true;
+            ImGui::Text("cpu: %.3f ms, gpu: %.3f ms", m_skinningCpuTime, m_skinningGpuTime);
+            if (m_benchmarkStep < 0 && ImGui::Button("run benchmark"))
+            {
+                m_skinning = true;
+                m_benchmarkStep = 0;
+            }
+            else if (m_benchmarkStep >= 0)
+            {
+                ImGui::Text("benchmark running... (see log)");
+            }
+        }
+
+        if (ImGui::CollapsingHeader("dynamic mesh"))
+        {
+            ImGui::Checkbox("wave", &m_waveEnabled);
+            ImGui::RadioButton("sub data", &m_waveUpdateMode, (int)MeshUpdateMode::SubData);
+            ImGui::SameLine();
+            ImGui::RadioButton("orphan", &m_waveUpdateMode, (int)MeshUpdateMode::Orphan);
+            ImGui::SameLine();
+            ImGui::RadioButton("persistent ring", &m_waveUpdateMode, (int)MeshUpdateMode::PersistentRing);
+            if (m_waveMesh)
+            {
+                ImGui::Text("update: %.3f ms", m_waveMesh->GetLastUpdateTime());
+                if (auto stream = m_waveMesh->GetStreamBuffer())
+                {
+                    ImGui::Text("%s, stall: %.3f ms (total %.1f ms, %d times)",
+                                stream->IsPersistent() ? "persistent mapped" : "orphaning fallback",
+                                stream->GetLastStallTime(), stream->GetTotalStallTime(), stream->GetStallCount());
+                }
+            }
+        }
+
+        if (ImGui::CollapsingHeader("keyframe animation"))
+        {
+            ImGui::Checkbox("animated cubes", &m_cubeAnimationEnabled);
+            ImGui::SliderInt("cubes", &m_cubeCount, 1, 100000);
+            ImGui::Text("evaluate: %.3f ms", m_cubeAnimation->GetLastEvaluateTime());
+        }
+
+        if (ImGui::CollapsingHeader("crowd (vertex animation)"))
+        {
+            ImGui::Checkbox("crowd", &m_crowdEnabled);
+            ImGui::SliderInt("instances", &m_crowdCount, 1, 100000);
+        }
     }
     ImGui::End();
 
@@ -114,7 +965,7 @@ void Context::Render()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // 각 픽셀의 컬러 값을 저장하는 버퍼 외에, 해당 픽셀의 깊이값 (z축값)을 저장.
                                                         // OpenGL의 Depth Buffer 초기값은 1. 1이 가장 뒤에 있고, 0이 가장 앞을 의미 (왼손 좌표계)
 
-    glEnable(GL_DEPTH_TEST); // 깊이 테스트를 켠다.
+    GlState::Get().SetEnabled(GL_DEPTH_TEST, true); // 깊이 테스트를 켠다. 이미 켜져 있으면 GL 호출 생략
     // glDepthFunc()을 이용하여 깊이 테스트 통과 조건을 변경할 수 있음. 깊이 테스트 통과 조건의 기본값은 GL_LESS.
     // depth가 작은 값을 화면에 그림
 
@@ -129,6 +980,8 @@ void Context::Render()
         m_cameraPos + m_cameraFront,                                                                         // EYE + n = AT
         m_cameraUp);                                                                                         // UP
     auto projection = glm::perspective(glm::radians(45.0f), (float)m_width / (float)m_height, 0.1f, 300.0f); // (fovy, aspect, near, far) far를 크게해주면 잘리는것을 막을 수 있음.
+    m_view = view;
+    m_projection = projection;
 
     // model에 대한 uniform변수들 설정.
     glm::vec3 lightPos = m_light.position;
@@ -145,50 +998,94 @@ void Context::Render()
         auto lightModelTransform = glm::translate(glm::mat4(1.0), m_light.position) * glm::scale(glm::mat4(1.0), glm::vec3(0.1f));
         m_simpleProgram->Use();
         m_simpleProgram->SetUniform("color", glm::vec4(m_light.ambient + m_light.diffuse, 1.0f));
-        m_simpleProgram->SetUniform("transform", projection * view * lightModelTransform);
+        m_simpleProgram->SetUniform(kTransform, projection * view * lightModelTransform);
         m_box->Draw(m_simpleProgram.get());
     }
 
-    m_program->Use();
-    m_program->SetUniform("viewPos", m_cameraPos);
-    m_program->SetUniform("light.position", lightPos);
-    m_program->SetUniform("light.direction", lightDir);
-    m_program->SetUniform("light.cutoff", glm::vec2(
-                                              cosf(glm::radians(m_light.cutoff[0])),
-                                              cosf(glm::radians(m_light.cutoff[0] + m_light.cutoff[1]))));
-    m_program->SetUniform("light.attenuation", GetAttenuationCoeff(m_light.distance));
-    m_program->SetUniform("light.ambient", m_light.ambient);
-    m_program->SetUniform("light.diffuse", m_light.diffuse);
-    m_program->SetUniform("light.specular", m_light.specular);
-
-    auto modelTransform =
-        glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)) *
-        glm::scale(glm::mat4(1.0f), glm::vec3(10.0f, 1.0f, 10.0f));
-    auto transform = projection * view * modelTransform;
-    m_program->SetUniform("transform", transform);
-    m_program->SetUniform("modelTransform", modelTransform);
-    m_planeMaterial->SetToProgram(m_program.get());
-    m_box->Draw(m_program.get());
-
-    modelTransform =
-        glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, 0.75f, -4.0f)) *
-        glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
-        glm::scale(glm::mat4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f));
-    transform = projection * view * modelTransform;
-    m_program->SetUniform("transform", transform);
-    m_program->SetUniform("modelTransform", modelTransform);
-    m_box1Material->SetToProgram(m_program.get());
-    m_box->Draw(m_program.get());
-
-    modelTransform =
-        glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.7f, 2.0f)) *
-        glm::rotate(glm::mat4(1.0f), glm::radians(20.0f), glm::vec3(0.0f, 1.0f, 0.0f)) *
-        glm::scale(glm::mat4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f));
-    transform = projection * view * modelTransform;
-    m_program->SetUniform("transform", transform);
-    m_program->SetUniform("modelTransform", modelTransform);
-    m_box2Material->SetToProgram(m_program.get());
-    m_box->Draw(m_program.get());
+    // camera / 광원은 프레임마다 한 번 uniform block으로 올리고 모든 program이 같이 읽음
+    CameraUniforms camera;
+    camera.view = view;
+    camera.projection = projection;
+    camera.viewProjection = projection * view;
+    camera.viewPos = glm::vec4(m_cameraPos, 1.0f);
+    LightUniforms light;
+    light.position = glm::vec4(lightPos, 1.0f);
+    light.direction = glm::vec4(lightDir, 0.0f);
+    light.cutoff = glm::vec4(cosf(glm::radians(m_light.cutoff[0])),
+                             cosf(glm::radians(m_light.cutoff[0] + m_light.cutoff[1])), 0.0f, 0.0f);
+    light.attenuation = glm::vec4(GetAttenuationCoeff(m_light.distance), 0.0f);
+    light.ambient = glm::vec4(m_light.ambient, 1.0f);
+    light.diffuse = glm::vec4(m_light.diffuse, 1.0f);
+    light.specular = glm::vec4(m_light.specular, 1.0f);
+    m_frameUniforms->Update(camera, light);
+
+    // inner cutoff가 180도면 모든 방향의 intensity가 1이라 point light와 같으므로 원뿔 계산이 없는 variant 사용
+    uint32_t lightingKey = m_light.cutoff[0] >= 180.0f ? 1 : 0;
+    if (m_materialTableEnabled)
+    {
+        lightingKey |= 2;
+        m_materialTable->Bind();
+    }
+    if (auto program = m_lightingVariants->Get(lightingKey))
+        m_lightingProgram = program;
+
+    const size_t objectCount = m_sceneObjects.size();
+
+    // frustum 밖의 오브젝트는 그리지 않음 (static batch는 통째로 그리므로 검사하지 않음)
+    m_cullStats.Reset();
+    m_sceneVisible.assign(objectCount, 1);
+    // bounds는 오브젝트가 바뀔 때만 갱신하므로 (RebuildScene, AddSceneObject) 여기서는 검사만 함
+    // 병렬 기록은 task마다 자기 범위를 검사하므로 여기서는 건너뜀
+    bool parallel = m_parallelRecording && !m_staticBatching;
+    if (m_frustumCulling && !m_staticBatching && !parallel)
+        CullBounds(Frustum::FromMatrix(projection * view), m_sceneBounds, m_sceneVisible, &m_cullStats);
+
+    float time = m_animation ? (float)glfwGetTime() : 0.0f;
+    if (parallel)
+        RenderSceneParallel(projection * view, time);
+    else if (m_renderQueueEnabled)
+        RenderSceneQueued(time);
+    else
+        RenderSceneDirect(time);
+
+    if (m_cubeAnimationEnabled && m_instancedProgram)
+    {
+        if (m_cubeNodeCount != m_cubeCount)
+            SetupAnimatedCubes(m_cubeCount);
+        m_cubeAnimation->Evaluate(time, m_cubeTransforms.data());
+        m_animatedBox->SetInstanceTransforms(m_cubeTransforms);
+
+        // 상자끼리 많이 겹치므로 위치 stream만으로 depth를 먼저 채우고 본 pass는 GL_LEQUAL로 그림
+        bool prepass = m_depthPrepass && m_depthInstancedProgram;
+        if (prepass)
+        {
+            GlState::Get().ColorMask(false, false, false, false);
+            m_depthInstancedProgram->Use();
+            m_depthInstancedProgram->SetUniform(kTransform, projection * view);
+            m_animatedBox->DrawPositionOnly();
+            GlState::Get().ColorMask(true, true, true, true);
+            GlState::Get().DepthFunc(GL_LEQUAL);
+        }
+        m_instancedProgram->Use();
+        m_instancedProgram->SetUniform(kTransform, projection * view);
+        m_instancedProgram->SetUniform(kModelTransform, glm::mat4(1.0f));
+        m_animatedBox->Draw(m_instancedProgram.get());
+        if (prepass)
+            GlState::Get().DepthFunc(GL_LESS);
+    }
+
+    if (m_skinning && (m_skinningProgram || !m_gpuSkinning))
+        RenderSkinning(projection * view, time);
+
+    if (m_crowdEnabled && m_vatProgram && m_crowd)
+    {
+        if (m_crowdInstanceCount != m_crowdCount)
+            SetupCrowd(m_crowdCount);
+        m_vatProgram->Use();
+        m_vatProgram->SetUniform(kTransform, projection * view);
+        m_vatProgram->SetUniform(kModelTransform, glm::mat4(1.0f));
+        m_crowd->Draw(m_vatProgram.get(), time);
+    }
 }
 
 void Context::ProcessInput(GLFWwindow *window)
@@ -252,6 +1149,11 @@ void Context::MouseMove(double x, double y)
 
 void Context::MouseButton(int button, int action, double x, double y)
 {
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !ImGui::GetIO().WantCaptureMouse)
+    {
+        Pick(x, y);
+    }
+
     if (button == GLFW_MOUSE_BUTTON_RIGHT)
     {
         if (action == GLFW_PRESS)
@@ -265,4 +1167,33 @@ void Context::MouseButton(int button, int action, double x, double y)
             m_cameraControl = false;
         }
     }
-}
\ No newline at end of file
+}
+void Context::Pick(double x, double y)
+{
+    // 커서 좌표는 window 좌표라서 HiDPI에서는 framebuffer 크기(m_width, m_height)와 배율이 다르므로 window 크기로 나눔
+    int windowWidth = m_width;
+    int windowHeight = m_height;
+    if (auto window = glfwGetCurrentContext())
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    if (windowWidth <= 0 || windowHeight <= 0) // 최소화된 창
+        return;
+
+    // 커서 위치를 NDC로 바꾼 뒤 near / far 평면 위의 점을 world space로 되돌려 ray를 만든다.
+    float ndcX = 2.0f * (float)x / (float)windowWidth - 1.0f;
+    float ndcY = 1.0f - 2.0f * (float)y / (float)windowHeight;
+    auto invViewProjection = glm::inverse(m_projection * m_view);
+    auto nearPoint = invViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    auto farPoint = invViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    auto origin = glm::vec3(nearPoint) / nearPoint.w;
+    auto direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+
+    if (m_sceneBvhDirty)
+        BuildSceneBvh();
+    auto start = std::chrono::high_resolution_clock::now();
+    m_pickResult = m_sceneBvh->Intersect(origin, direction);
+    auto end = std::chrono::high_resolution_clock::now();
+    m_pickTime = std::chrono::duration<float, std::micro>(end - start).count();
+
+    if (m_pickResult)
+        SPDLOG_INFO("picked object: {}, triangle: {}, distance: {}", m_pickResult->objectId, m_pickResult->triangleIndex, m_pickResult->distance);
+}
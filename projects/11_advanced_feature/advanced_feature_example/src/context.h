@@ -4,17 +4,30 @@
 #include "common.h"
 #include "shader.h"
 #include "program.h"
+#include "program_compiler.h"
+#include "hot_reload.h"
 #include "buffer.h"
 #include "vertex_layout.h"
 #include "texture.h"
 #include "mesh.h"
 #include "model.h"
+#include "skeleton.h"
+#include "skinning.h"
+#include "vertex_animation.h"
+#include "static_batch.h"
+#include "transform_animation.h"
+#include "frame_uniforms.h"
+#include "material_table.h"
+#include "render_queue.h"
+#include "command_buffer.h"
+#include "worker_pool.h"
 
 CLASS_PTR(Context)
 class Context
 {
 public:
     static ContextUPtr Create();
+    ~Context();
     void Render();
     void ProcessInput(GLFWwindow *window);
     void Reshape(int width, int height);
@@ -24,8 +37,34 @@ public:
 private:
     Context() {}
     bool Init();
-    ProgramUPtr m_program;
+    void Pick(double x, double y); // 커서 위치의 오브젝트 / 삼각형 찾기
+    void RebuildScene();           // m_sceneObjects로 static batch와 BVH를 처음부터 다시 만듦
+    void PopulateScene(int count); // 처음 오브젝트에 임의 위치의 상자 count개를 더해 한 번에 다시 만듦
+    void BuildSceneBvh();          // m_sceneObjects로 picking용 BVH를 다시 만듦
+    void AddSceneObject(const glm::mat4 &transform, MaterialPtr material); // 상자 추가, static batch / BVH 갱신
+    void AddSceneBounds(const glm::mat4 &transform); // 상자 하나의 world space bounds를 m_sceneBounds 끝에 추가
+    void InitSkinning();           // skinning 벤치마크용 촉수 캐릭터 생성
+    void RenderSkinning(const glm::mat4 &viewProjection, float time);
+    void SetupCrowd(int count); // vertex animation 군중 인스턴스 배치
+    void InitCubeAnimation();   // 키프레임 clip 생성
+    void SetupAnimatedCubes(int count);
+    void UpdateWave(float time); // 매 프레임 CPU에서 물결 정점을 다시 계산해서 dynamic mesh에 올림
+    void RenderSceneDirect(float time); // 바닥, 상자들, 물결을 제출 순서대로 바로 그림
+    void RenderSceneQueued(float time); // 같은 내용을 render queue로 모아 정렬한 뒤 그림
+    void RenderSceneParallel(const glm::mat4 &viewProjection, float time); // 상자들을 여러 스레드에서 나눠 culling하고 command buffer에 기록한 뒤 재생
+    ProgramCompilerUPtr m_programCompiler; // 아래 program들을 한꺼번에 컴파일, 준비되면 채워짐
+    HotReloaderUPtr m_hotReloader;         // 파일이 바뀌면 program / texture 교체, 지원하지 않는 플랫폼이면 nullptr
+    ProgramUPtr m_fallbackProgram;         // depth.vs + simple.fs, lighting variant가 준비될 때까지 단색으로 그림
+    ProgramVariantsUPtr m_lightingVariants; // lighting.vs + lighting.fs, POINT_LIGHT / MATERIAL_TABLE permutation
+    const Program *m_lightingProgram{nullptr}; // 이번 프레임에 쓰는 variant
     ProgramUPtr m_simpleProgram;
+    ProgramUPtr m_skinningProgram; // skinning.vs + lighting.fs
+    ProgramUPtr m_vatProgram;      // vat.vs + lighting.fs
+    ProgramUPtr m_instancedProgram; // lighting_instanced.vs + lighting.fs
+    ProgramUPtr m_depthProgram;    // depth.vs + depth.fs, 위치 stream만 읽음
+    ProgramUPtr m_depthInstancedProgram; // depth_instanced.vs + depth.fs, 애니메이션 상자의 위치 stream만 읽음
+
+    FrameUniformBufferUPtr m_frameUniforms; // Camera, Light uniform block
 
     MeshUPtr m_box;
 
@@ -55,9 +94,100 @@ private:
     MaterialPtr m_box1Material;
     MaterialPtr m_box2Material;
 
+    // 위 material들을 uniform block + texture array 하나에 모음. 켜면 draw마다 materialIndex만 바꿈
+    MaterialTableUPtr m_materialTable;
+    bool m_materialTableEnabled{true};
+
+    // 바닥, 상자들 (m_box를 각자의 transform, material로 그림)
+    struct SceneObject
+    {
+        glm::mat4 transform;
+        MaterialPtr material;
+    };
+    std::vector<SceneObject> m_sceneObjects;
+    int m_baseObjectCount{0}; // Init에서 만든 오브젝트 수 (PopulateScene이 남겨 둠)
+    int m_populateCount{10000};
+
+    // static batching: m_sceneObjects를 world space로 합쳐 material당 draw call 하나로 그림
+    StaticBatchUPtr m_staticBatch;
+    bool m_staticBatching{false}; // 켜면 오브젝트별 frustum culling과 병렬 기록은 쓰지 않음
+
     Light m_light;
     bool m_flashLightMode{false};
 
+    // depth prepass: 위치 stream으로 depth를 먼저 채워 두고 본 pass는 GL_LEQUAL로 가려진 fragment를 건너뜀
+    bool m_depthPrepass{false};
+
+    // 켜면 scene의 draw를 packet으로 모아 program / material / mesh 순으로 정렬해서 그림
+    RenderQueueUPtr m_renderQueue;
+    bool m_renderQueueEnabled{true};
+
+    // 켜면 (static batch가 아닐 때) scene 오브젝트를 스레드 수만큼 나눠 스레드마다 command buffer에 기록
+    // pass가 섞이지 않도록 depth prepass와 본 pass의 buffer를 따로 둠
+    bool m_parallelRecording{false};
+    WorkerPoolUPtr m_workerPool; // Init에서 코어 수만큼 한 번만 띄워서 매 프레임 재사용
+    std::vector<CommandBufferUPtr> m_depthCommands;
+    std::vector<CommandBufferUPtr> m_sceneCommands;
+    std::vector<CullStats> m_recordCullStats; // task별 culling 결과. 기록이 끝나면 m_cullStats에 합침
+    int m_recordTaskCount{0};
+    int m_recordThreadLimit{0}; // 0이면 코어 수만큼
+    float m_recordTime{0.0f}; // ms, 기록에 걸린 CPU 시간 (재생 제외)
+
+    // frustum culling
+    bool m_frustumCulling{true};
+    BoundsSoA m_sceneBounds; // 바닥, 상자들의 world space bounding volume. m_sceneObjects와 같은 순서, 바뀔 때만 갱신
+    std::vector<uint8_t> m_sceneVisible;
+    CullStats m_cullStats;
+
+    // picking
+    BvhUPtr m_sceneBvh; // world space 삼각형, objectId는 m_sceneObjects의 인덱스
+    bool m_sceneBvhDirty{false}; // AddSceneObject 후 다음 picking 때 한 번만 다시 만듦
+    std::optional<BvhHit> m_pickResult;
+    float m_pickTime{0.0f}; // microseconds
+
+    // skeletal animation: 같은 캐릭터를 격자로 여러 개 그려서 CPU / GPU skinning 비교
+    SkeletonUPtr m_tentacleSkeleton;
+    AnimationUPtr m_tentacleAnimation;
+    SkinnedMeshUPtr m_tentacleMesh;
+    BonePaletteBufferUPtr m_bonePalettes;
+    std::vector<glm::mat4> m_localTransforms;
+    std::vector<glm::mat4> m_palettes; // 캐릭터 수 * bone 수
+    bool m_skinning{false};
+    bool m_gpuSkinning{true};
+    int m_characterCount{100};
+    float m_skinningCpuTime{0.0f}; // ms, pose 계산 + (CPU 경로면) skinning과 업로드
+    float m_skinningGpuTime{0.0f}; // ms, GL_TIME_ELAPSED로 잰 캐릭터 draw 시간
+    uint32_t m_timerQuery{0};
+    bool m_timerQueryPending{false};
+
+    // 벤치마크: 캐릭터 수 {1, 10, 100, 1000} x {CPU, GPU}를 차례로 일정 프레임씩 측정
+    int m_benchmarkStep{-1}; // -1이면 측정 중이 아님
+    int m_benchmarkFrame{0};
+    double m_benchmarkCpuSum{0.0};
+    double m_benchmarkGpuSum{0.0};
+    int m_benchmarkGpuSamples{0};
+
+    // vertex animation texture 군중: 촉수 animation을 미리 구워 instanced draw 한 번으로 그림
+    VertexAnimationUPtr m_crowd;
+    bool m_crowdEnabled{false};
+    int m_crowdCount{10000};
+    int m_crowdInstanceCount{0}; // 현재 instance buffer에 배치된 수
+
+    // 키프레임 animation: 상자 수만큼의 node transform을 매 프레임 SIMD로 계산해서 instanced draw
+    TransformAnimationUPtr m_cubeAnimation;
+    MeshUPtr m_animatedBox; // instance buffer를 가지므로 m_box와 따로 둠
+    std::vector<glm::mat4> m_cubeTransforms;
+    bool m_cubeAnimationEnabled{false};
+    int m_cubeCount{1000};
+    int m_cubeNodeCount{0}; // 현재 m_cubeAnimation에 추가된 node 수
+
+    // dynamic mesh: 매 프레임 정점이 바뀌는 물결 격자, 갱신 방식(MeshUpdateMode)별 비용 비교
+    MeshUPtr m_waveMesh;
+    std::vector<Vertex> m_waveVertices;
+    bool m_waveEnabled{false};
+    int m_waveUpdateMode{(int)MeshUpdateMode::PersistentRing};
+    int m_waveMeshMode{-1}; // m_waveMesh가 만들어진 방식, 없으면 -1
+
     // camera parameter
     bool m_cameraControl{false};
     glm::vec2 m_prevMousePos{glm::vec2(0.0f)};
@@ -66,6 +196,8 @@ private:
     glm::vec3 m_cameraPos{glm::vec3(0.0f, 0.0f, 3.0f)};
     glm::vec3 m_cameraFront{glm::vec3(0.0f, 2.5f, 8.0f)}; // AT이 아니라 EYE가 바라보고있는 방향 = AT-EYE
     glm::vec3 m_cameraUp{glm::vec3(0.0f, 1.0f, 0.0f)};
+    glm::mat4 m_view{glm::mat4(1.0f)};       // 마지막 Render()의 값, picking ray 계산에 사용
+    glm::mat4 m_projection{glm::mat4(1.0f)};
 
     // window size
     int m_width{WINDOW_WIDTH};
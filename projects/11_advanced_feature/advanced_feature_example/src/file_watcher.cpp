@@ -0,0 +1,100 @@
+#include "file_watcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcherUPtr FileWatcher::Create()
+{
+#ifdef __linux__
+    auto watcher = FileWatcherUPtr(new FileWatcher());
+    watcher->m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC); // Poll에서 read가 기다리지 않도록
+    if (watcher->m_fd < 0)
+    {
+        SPDLOG_ERROR("failed to initialize inotify: {}", strerror(errno));
+        return nullptr;
+    }
+    return std::move(watcher);
+#else
+    SPDLOG_INFO("file watcher is not supported on this platform");
+    return nullptr;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (m_fd >= 0)
+        close(m_fd); // 등록한 watch도 함께 해제됨
+#endif
+}
+
+std::string FileWatcher::NormalizePath(const std::string &filename)
+{
+    return std::filesystem::path(filename).lexically_normal().generic_string();
+}
+
+bool FileWatcher::Watch(const std::string &filename)
+{
+#ifdef __linux__
+    auto path = NormalizePath(filename);
+    auto directory = std::filesystem::path(path).parent_path().generic_string();
+    if (directory.empty())
+        directory = ".";
+    m_files.insert(path);
+
+    for (auto &pair : m_directories)
+    {
+        if (pair.second == directory)
+            return true;
+    }
+    int wd = inotify_add_watch(m_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+    {
+        SPDLOG_ERROR("failed to watch directory: {} ({})", directory, strerror(errno));
+        return false;
+    }
+    m_directories[wd] = directory;
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<std::string> FileWatcher::Poll()
+{
+    std::vector<std::string> changed;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        auto length = read(m_fd, buffer, sizeof(buffer));
+        if (length <= 0) // EAGAIN: 남은 event 없음
+            break;
+        for (char *ptr = buffer; ptr < buffer + length;)
+        {
+            auto event = (const inotify_event *)ptr;
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) // event를 놓쳤으므로 전부 바뀐 것으로 취급
+            {
+                changed.assign(m_files.begin(), m_files.end());
+                continue;
+            }
+            auto it = m_directories.find(event->wd);
+            if (it == m_directories.end() || event->len == 0)
+                continue;
+            auto path = NormalizePath(it->second + "/" + event->name);
+            // 저장 한 번에 event가 여러 개 올 수 있으므로 중복 제거
+            if (m_files.count(path) && std::find(changed.begin(), changed.end(), path) == changed.end())
+                changed.push_back(path);
+        }
+    }
+#endif
+    return changed;
+}
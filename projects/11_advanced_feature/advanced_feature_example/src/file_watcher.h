@@ -0,0 +1,33 @@
+#ifndef __FILE_WATCHER_H__
+#define __FILE_WATCHER_H__
+
+#include "common.h"
+#include <unordered_map>
+#include <unordered_set>
+
+// Linux inotify로 파일이 다시 저장된 것을 감지
+// 편집기가 임시 파일에 쓰고 이름을 바꾸면 파일 자체의 watch는 사라지므로 파일이 아니라 디렉토리를 감시하고,
+// 등록한 파일 이름만 골라서 알려준다. 쓰는 중간이 아니라 다 쓰고 닫았을 때(IN_CLOSE_WRITE)나 이름이 바뀌었을 때만 보고
+CLASS_PTR(FileWatcher)
+class FileWatcher
+{
+public:
+    static FileWatcherUPtr Create(); // inotify를 쓸 수 없는 플랫폼이면 nullptr
+    ~FileWatcher();
+
+    bool Watch(const std::string &filename);
+    // 기다리지 않고 지난 호출 이후 바뀐 파일 목록을 반환 (NormalizePath된 경로, 중복 없음)
+    std::vector<std::string> Poll();
+
+    // "./shader/../shader/a.fs"와 "shader/a.fs"가 같은 문자열이 되도록 정리
+    static std::string NormalizePath(const std::string &filename);
+
+private:
+    FileWatcher() {}
+
+    int m_fd{-1};
+    std::unordered_map<int, std::string> m_directories; // watch descriptor -> 디렉토리
+    std::unordered_set<std::string> m_files;            // 등록한 파일. 같은 디렉토리의 다른 파일 변경은 무시
+};
+
+#endif // __FILE_WATCHER_H__
@@ -0,0 +1,42 @@
+#include "frame_uniforms.h"
+#include <cstring>
+
+FrameUniformBufferUPtr FrameUniformBuffer::Create()
+{
+    auto buffer = FrameUniformBufferUPtr(new FrameUniformBuffer());
+    if (!buffer->Init())
+        return nullptr;
+    return std::move(buffer);
+}
+
+void FrameUniformBuffer::BindBlocks(const Program *program)
+{
+    program->SetUniformBlockBinding("Camera", kCameraBinding);
+    program->SetUniformBlockBinding("Light", kLightBinding);
+}
+
+bool FrameUniformBuffer::Init()
+{
+    // glBindBufferRange의 offset은 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT의 배수여야 함
+    int alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    auto Align = [&](size_t size)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    };
+    m_lightOffset = Align(sizeof(CameraUniforms));
+    m_buffer = StreamBuffer::Create(GL_UNIFORM_BUFFER, Align(m_lightOffset + sizeof(LightUniforms)));
+    return m_buffer != nullptr;
+}
+
+void FrameUniformBuffer::Update(const CameraUniforms &camera, const LightUniforms &light)
+{
+    auto data = (uint8_t *)m_buffer->BeginWrite();
+    memcpy(data, &camera, sizeof(CameraUniforms));
+    memcpy(data + m_lightOffset, &light, sizeof(LightUniforms));
+    m_buffer->EndWrite(m_lightOffset + sizeof(LightUniforms));
+
+    size_t offset = m_buffer->GetOffset();
+    glBindBufferRange(GL_UNIFORM_BUFFER, kCameraBinding, m_buffer->Get(), offset, sizeof(CameraUniforms));
+    glBindBufferRange(GL_UNIFORM_BUFFER, kLightBinding, m_buffer->Get(), offset + m_lightOffset, sizeof(LightUniforms));
+}
@@ -0,0 +1,55 @@
+#ifndef __FRAME_UNIFORMS_H__
+#define __FRAME_UNIFORMS_H__
+
+#include "common.h"
+#include "buffer.h"
+#include "program.h"
+
+// 모든 program이 같이 쓰는 uniform block의 binding point (0은 BonePalette)
+static const uint32_t kCameraBinding = 1;
+static const uint32_t kLightBinding = 2;
+
+// std140 배치와 같도록 vec3 / vec2도 vec4로 둠 (shader 쪽도 같은 순서의 vec4)
+struct CameraUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 viewPos; // xyz
+};
+static_assert(sizeof(CameraUniforms) == 64 * 3 + 16, "CameraUniforms must match std140 layout");
+
+struct LightUniforms
+{
+    glm::vec4 position;    // xyz
+    glm::vec4 direction;   // xyz
+    glm::vec4 cutoff;      // (cos(inner), cos(outer))
+    glm::vec4 attenuation; // (Kc, Kl, Kq)
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+};
+static_assert(sizeof(LightUniforms) == 16 * 7, "LightUniforms must match std140 layout");
+
+// 프레임마다 한 번 camera / light block을 ring buffer(StreamBuffer)의 다음 구간에 쓰고
+// 고정된 binding point에 연결. program마다 같은 uniform을 반복해서 올리지 않아도 된다.
+CLASS_PTR(FrameUniformBuffer)
+class FrameUniformBuffer
+{
+public:
+    static FrameUniformBufferUPtr Create();
+
+    // Camera, Light block을 쓰는 program의 block을 binding point에 연결 (block이 없으면 무시됨)
+    static void BindBlocks(const Program *program);
+
+    void Update(const CameraUniforms &camera, const LightUniforms &light);
+
+private:
+    FrameUniformBuffer() {}
+    bool Init();
+
+    StreamBufferUPtr m_buffer;
+    size_t m_lightOffset{0}; // 구간 안에서 Light block의 위치 (offset alignment 배수)
+};
+
+#endif // __FRAME_UNIFORMS_H__
@@ -0,0 +1,144 @@
+#include "geometry_registry.h"
+#include <cstring>
+
+// 8 byte씩 섞는 간단한 곱셈 hash. 충돌은 GeometryRegistry에서 내용 비교로 걸러낸다.
+static uint64_t HashBytes(const void *data, size_t size, uint64_t hash)
+{
+    const uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+    auto bytes = (const uint8_t *)data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * kMultiplier;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ bytes[i]) * kMultiplier;
+    return hash ^ (hash >> 29);
+}
+
+size_t WeldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    // open addressing table: 정점 hash 위치에 welded의 인덱스를 저장
+    size_t capacity = 16;
+    while (capacity < vertices.size() * 2)
+        capacity <<= 1;
+    const uint32_t kEmpty = UINT32_MAX;
+    std::vector<uint32_t> table(capacity, kEmpty);
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        auto &vertex = vertices[i];
+        size_t slot = HashBytes(&vertex, sizeof(Vertex), 0) & (capacity - 1);
+        while (table[slot] != kEmpty && memcmp(&welded[table[slot]], &vertex, sizeof(Vertex)) != 0)
+            slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == kEmpty)
+        {
+            table[slot] = (uint32_t)welded.size();
+            welded.push_back(vertex);
+        }
+        remap[i] = table[slot];
+    }
+
+    for (auto &index : indices)
+        index = remap[index];
+    size_t removed = vertices.size() - welded.size();
+    vertices.swap(welded);
+    return removed;
+}
+
+GeometryRegistry &GeometryRegistry::Get()
+{
+    static GeometryRegistry registry;
+    return registry;
+}
+
+MeshUPtr GeometryRegistry::CreateMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                                      uint32_t primitiveType, bool positionStream)
+{
+    uint64_t hash = HashBytes(vertices.data(), vertices.size() * sizeof(Vertex), primitiveType * 2 + (positionStream ? 1 : 0));
+    hash = HashBytes(indices.data(), indices.size() * sizeof(uint32_t), hash);
+
+    auto range = m_entries.equal_range(hash);
+    for (auto it = range.first; it != range.second;)
+    {
+        auto &entry = it->second;
+        auto vertexBuffer = entry.vertexBuffer.lock();
+        auto indexBuffer = entry.indexBuffer.lock();
+        if (!vertexBuffer || !indexBuffer) // 사용하던 Mesh가 모두 사라짐
+        {
+            it = m_entries.erase(it);
+            continue;
+        }
+        auto positionBuffer = entry.positionBuffer.lock();
+        if (entry.primitiveType == primitiveType && (!positionStream || positionBuffer) &&
+            Matches(entry, vertices, indices))
+        {
+            m_hitCount++;
+            return Mesh::CreateWithBuffers(vertexBuffer, indexBuffer, positionBuffer,
+                                           entry.aabb, entry.boundingSphere, primitiveType);
+        }
+        ++it;
+    }
+
+    auto mesh = Mesh::Create(vertices, indices, primitiveType, positionStream);
+    Entry entry;
+    entry.vertexCount = vertices.size();
+    entry.indexCount = indices.size();
+    entry.primitiveType = primitiveType;
+    entry.vertexBuffer = mesh->GetVertexBuffer();
+    entry.indexBuffer = mesh->GetIndexBuffer();
+    entry.positionBuffer = mesh->GetPositionBuffer();
+    entry.aabb = mesh->GetAABB();
+    entry.boundingSphere = mesh->GetBoundingSphere();
+    entry.bytes = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t) +
+                  (positionStream ? vertices.size() * sizeof(glm::vec3) : 0);
+    m_entries.emplace(hash, std::move(entry));
+    return mesh;
+}
+
+bool GeometryRegistry::Matches(const Entry &entry, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices) const
+{
+    if (entry.vertexCount != vertices.size() || entry.indexCount != indices.size())
+        return false;
+
+    // hash가 같을 때만 GPU에서 읽어와 비교. VAO의 element buffer 연결을 건드리지 않도록 GL_COPY_READ_BUFFER 사용
+    auto Compare = [](const BufferPtr &buffer, const void *data, size_t size)
+    {
+        std::vector<uint8_t> stored(size);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer->Get());
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, stored.data());
+        return memcmp(stored.data(), data, size) == 0;
+    };
+    return Compare(entry.vertexBuffer.lock(), vertices.data(), vertices.size() * sizeof(Vertex)) &&
+           Compare(entry.indexBuffer.lock(), indices.data(), indices.size() * sizeof(uint32_t));
+}
+
+int GeometryRegistry::GetGeometryCount() const
+{
+    int count = 0;
+    for (auto &pair : m_entries)
+    {
+        if (!pair.second.vertexBuffer.expired())
+            count++;
+    }
+    return count;
+}
+
+size_t GeometryRegistry::GetSavedBytes() const
+{
+    size_t saved = 0;
+    for (auto &pair : m_entries)
+    {
+        // Mesh마다 vertex buffer를 하나씩 참조하므로 참조 수 - 1벌이 절약된 양
+        long meshCount = pair.second.vertexBuffer.use_count();
+        if (meshCount > 1)
+            saved += (meshCount - 1) * pair.second.bytes;
+    }
+    return saved;
+}
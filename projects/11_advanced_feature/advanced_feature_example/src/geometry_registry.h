@@ -0,0 +1,48 @@
+#ifndef __GEOMETRY_REGISTRY_H__
+#define __GEOMETRY_REGISTRY_H__
+
+#include "common.h"
+#include "mesh.h"
+#include <unordered_map>
+
+// 비트 단위로 같은 정점을 하나로 합치고 index를 다시 매김. 제거한 정점 수를 반환
+// (assimp를 aiProcess_JoinIdenticalVertices 없이 부르면 면마다 정점이 따로 나옴)
+size_t WeldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+// 정점 / index 내용의 hash로 GPU buffer를 공유하는 프로세스 전역 registry
+// 같은 mesh가 여러 Model에 있으면 buffer는 한 벌만 올리고, Model마다 VAO / instance / material만 따로 가진 Mesh를 만든다.
+// registry는 buffer를 weak_ptr로만 가지므로 마지막 Mesh가 사라지면 buffer도 해제된다.
+class GeometryRegistry
+{
+public:
+    static GeometryRegistry &Get();
+
+    MeshUPtr CreateMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                        uint32_t primitiveType, bool positionStream);
+
+    int GetGeometryCount() const;  // 살아 있는 고유 geometry 수
+    size_t GetSavedBytes() const;  // 공유 덕분에 올리지 않은 GPU 메모리 (현재 공유 중인 것 기준)
+    int GetHitCount() const { return m_hitCount; } // 누적 공유 횟수
+
+private:
+    GeometryRegistry() {}
+
+    struct Entry
+    {
+        size_t vertexCount;
+        size_t indexCount;
+        uint32_t primitiveType;
+        std::weak_ptr<Buffer> vertexBuffer;
+        std::weak_ptr<Buffer> indexBuffer;
+        std::weak_ptr<Buffer> positionBuffer;
+        AABB aabb;
+        BoundingSphere boundingSphere;
+        size_t bytes; // 이 geometry의 GPU buffer 크기 합
+    };
+    bool Matches(const Entry &entry, const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices) const;
+
+    std::unordered_multimap<uint64_t, Entry> m_entries;
+    int m_hitCount{0};
+};
+
+#endif // __GEOMETRY_REGISTRY_H__
@@ -0,0 +1,202 @@
+#include "gl_state.h"
+
+GlState &GlState::Get()
+{
+    static GlState state;
+    return state;
+}
+
+bool GlState::Check(Category category, uint32_t &cached, uint32_t value)
+{
+    if (cached == value)
+    {
+        m_frame[category].skipped++;
+        return false;
+    }
+    cached = value;
+    m_frame[category].issued++;
+    return true;
+}
+
+void GlState::UseProgram(uint32_t program)
+{
+    if (Check(Programs, m_program, program))
+        glUseProgram(program);
+}
+
+void GlState::BindVertexArray(uint32_t vertexArray)
+{
+    if (Check(VertexArrays, m_vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+        ForgetVertexArrayState();
+    }
+}
+
+void GlState::BindBuffer(uint32_t target, uint32_t buffer)
+{
+    uint32_t *cached = target == GL_ARRAY_BUFFER           ? &m_arrayBuffer
+                       : target == GL_ELEMENT_ARRAY_BUFFER ? &m_elementArrayBuffer
+                                                           : nullptr;
+    if (!cached)
+    {
+        m_frame[Buffers].issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (Check(Buffers, *cached, buffer))
+        glBindBuffer(target, buffer);
+}
+
+void GlState::BindVertexBuffer(uint32_t binding, uint32_t buffer, uint64_t offset, size_t stride)
+{
+    if (binding < (uint32_t)kMaxVertexBindings)
+    {
+        auto &cached = m_vertexBindings[binding];
+        if (cached.buffer == buffer && cached.offset == offset && cached.stride == stride)
+        {
+            m_frame[Buffers].skipped++;
+            return;
+        }
+        cached = {buffer, offset, stride};
+    }
+    m_frame[Buffers].issued++;
+    glBindVertexBuffer(binding, buffer, (GLintptr)offset, (GLsizei)stride);
+}
+
+void GlState::ActiveTexture(int unit)
+{
+    if (Check(Textures, m_activeTexture, (uint32_t)unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GlState::BindTexture(uint32_t texture)
+{
+    if (m_activeTexture >= (uint32_t)kMaxTextureUnits) // active unit을 모름
+    {
+        m_frame[Textures].issued++;
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+    if (Check(Textures, m_textures[m_activeTexture], texture))
+        glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GlState::BindTexture(int unit, uint32_t texture)
+{
+    if (unit < kMaxTextureUnits && m_textures[unit] == texture)
+    {
+        m_frame[Textures].skipped++;
+        return;
+    }
+    ActiveTexture(unit);
+    BindTexture(texture);
+}
+
+void GlState::SetEnabled(uint32_t capability, bool enabled)
+{
+    auto it = m_capabilities.begin();
+    for (; it != m_capabilities.end() && it->first != capability; ++it)
+        ;
+    if (it == m_capabilities.end())
+        it = m_capabilities.insert(it, {capability, kUnknown});
+    if (!Check(Capabilities, it->second, enabled ? 1 : 0))
+        return;
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GlState::DepthFunc(uint32_t func)
+{
+    if (Check(Capabilities, m_depthFunc, func))
+        glDepthFunc(func);
+}
+
+void GlState::ColorMask(bool red, bool green, bool blue, bool alpha)
+{
+    uint32_t mask = (red ? 1 : 0) | (green ? 2 : 0) | (blue ? 4 : 0) | (alpha ? 8 : 0);
+    if (Check(Capabilities, m_colorMask, mask))
+        glColorMask(red, green, blue, alpha);
+}
+
+void GlState::OnDeleteProgram(uint32_t program)
+{
+    // 사용 중인 program은 지워도 다른 program을 쓸 때까지 남아 있으므로 0이 아니라 모르는 값으로
+    if (m_program == program)
+        m_program = kUnknown;
+}
+
+void GlState::OnDeleteVertexArray(uint32_t vertexArray)
+{
+    if (m_vertexArray == vertexArray)
+    {
+        m_vertexArray = kUnknown;
+        ForgetVertexArrayState();
+    }
+}
+
+void GlState::OnDeleteBuffer(uint32_t buffer)
+{
+    if (m_arrayBuffer == buffer)
+        m_arrayBuffer = kUnknown;
+    if (m_elementArrayBuffer == buffer)
+        m_elementArrayBuffer = kUnknown;
+    for (auto &binding : m_vertexBindings)
+    {
+        if (binding.buffer == buffer)
+            binding.buffer = kUnknown;
+    }
+}
+
+void GlState::OnDeleteTexture(uint32_t texture)
+{
+    for (auto &cached : m_textures)
+    {
+        if (cached == texture)
+            cached = kUnknown;
+    }
+}
+
+void GlState::OnVertexArrayElementBuffer(uint32_t vertexArray, uint32_t buffer)
+{
+    if (m_vertexArray == vertexArray)
+        m_elementArrayBuffer = buffer;
+}
+
+void GlState::Invalidate()
+{
+    m_program = kUnknown;
+    m_vertexArray = kUnknown;
+    m_arrayBuffer = kUnknown;
+    ForgetVertexArrayState();
+    m_activeTexture = kUnknown;
+    for (auto &cached : m_textures)
+        cached = kUnknown;
+    m_capabilities.clear();
+    m_depthFunc = kUnknown;
+    m_colorMask = kUnknown;
+}
+
+void GlState::ForgetVertexArrayState()
+{
+    m_elementArrayBuffer = kUnknown;
+    for (auto &binding : m_vertexBindings)
+        binding.buffer = kUnknown;
+}
+
+void GlState::BeginFrame()
+{
+    for (int i = 0; i < CategoryCount; i++)
+    {
+        m_lastFrame[i] = m_frame[i];
+        m_frame[i] = {};
+    }
+}
+
+const char *GlState::GetCategoryName(Category category)
+{
+    static const char *kNames[CategoryCount] = {"program", "vertex array", "buffer", "texture", "capability"};
+    return kNames[category];
+}
@@ -0,0 +1,89 @@
+#ifndef __GL_STATE_H__
+#define __GL_STATE_H__
+
+#include "common.h"
+
+// 현재 GL context의 bind / enable 상태를 기억해 두고 이미 같은 값이면 GL 호출을 생략
+// Program::Use, Texture::Bind, VertexLayout::Bind, Buffer::Bind가 모두 이곳을 거친다.
+// 이 class를 거치지 않고 상태를 바꾸는 코드 뒤에는 Invalidate()로 기억한 값을 버려야 함
+// (ImGui의 OpenGL backend는 그린 뒤 이전 상태를 되돌려 놓으므로 매 프레임 Invalidate하지 않아도 됨)
+class GlState
+{
+public:
+    enum Category
+    {
+        Programs,
+        VertexArrays,
+        Buffers,
+        Textures,     // glActiveTexture 포함
+        Capabilities, // glEnable / glDisable, glDepthFunc, glColorMask
+        CategoryCount,
+    };
+    struct Counter
+    {
+        int issued{0};  // 실제로 GL을 호출한 수
+        int skipped{0}; // 같은 상태라서 생략한 수
+    };
+
+    static GlState &Get();
+
+    // GL 4.5 / ARB_direct_state_access가 있으면 Buffer, Texture, VertexLayout이 bind 없이 object를 직접 생성 / 수정
+    bool IsDirectStateAccess() const { return m_directStateAccess && (GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access); }
+    void SetDirectStateAccess(bool enabled) { m_directStateAccess = enabled; } // false면 지원해도 GL 3.3 경로 사용 (비교용)
+
+    void UseProgram(uint32_t program);
+    void BindVertexArray(uint32_t vertexArray);
+    void BindBuffer(uint32_t target, uint32_t buffer); // GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER만 기억하고 나머지는 항상 호출
+    void BindVertexBuffer(uint32_t binding, uint32_t buffer, uint64_t offset, size_t stride); // 현재 VAO의 vertex buffer binding
+    void ActiveTexture(int unit);
+    void BindTexture(uint32_t texture);           // 현재 active unit의 GL_TEXTURE_2D
+    void BindTexture(int unit, uint32_t texture); // 이미 unit에 연결되어 있으면 active unit도 바꾸지 않음
+    void SetEnabled(uint32_t capability, bool enabled);
+    void DepthFunc(uint32_t func);
+    void ColorMask(bool red, bool green, bool blue, bool alpha);
+
+    // 지운 object의 이름은 다시 쓰일 수 있으므로 기억한 값에서 지움
+    void OnDeleteProgram(uint32_t program);
+    void OnDeleteVertexArray(uint32_t vertexArray);
+    void OnDeleteBuffer(uint32_t buffer);
+    void OnDeleteTexture(uint32_t texture);
+    void OnVertexArrayElementBuffer(uint32_t vertexArray, uint32_t buffer); // DSA로 VAO의 element buffer를 바꾼 뒤 호출
+    void Invalidate(); // 기억한 값을 모두 버림. 다음 호출은 모두 GL로 보냄
+
+    void BeginFrame(); // 프레임 시작에서 호출. 지난 프레임의 호출 수를 보관하고 새로 셈
+    const Counter &GetLastFrameCounter(Category category) const { return m_lastFrame[category]; }
+    const Counter &GetFrameCounter(Category category) const { return m_frame[category]; } // 이번 프레임 (첫 BeginFrame 전이면 초기화 중) 호출 수
+    static const char *GetCategoryName(Category category);
+
+private:
+    GlState() { Invalidate(); }
+    bool Check(Category category, uint32_t &cached, uint32_t value); // GL 호출이 필요하면 true
+    void ForgetVertexArrayState(); // VAO에 속한 element buffer / vertex buffer binding을 모르는 값으로
+
+    static constexpr uint32_t kUnknown = 0xFFFFFFFF; // 실제 값을 모름
+    static constexpr int kMaxTextureUnits = 32;      // 그 이상의 unit은 기억하지 않고 항상 호출
+    static constexpr int kMaxVertexBindings = 16;    // GL_MAX_VERTEX_ATTRIB_BINDINGS의 최소 보장값
+
+    uint32_t m_program;
+    uint32_t m_vertexArray;
+    uint32_t m_arrayBuffer;
+    uint32_t m_elementArrayBuffer; // VAO 상태의 일부라서 VAO가 바뀌면 모르는 값이 됨
+    struct VertexBinding
+    {
+        uint32_t buffer;
+        uint64_t offset;
+        size_t stride;
+    };
+    VertexBinding m_vertexBindings[kMaxVertexBindings]; // 이것도 VAO 상태
+    uint32_t m_activeTexture;
+    uint32_t m_textures[kMaxTextureUnits];
+    std::vector<std::pair<uint32_t, uint32_t>> m_capabilities; // (capability, 켜짐 여부)
+    uint32_t m_depthFunc;
+    uint32_t m_colorMask; // rgba를 bit 4개로
+    bool m_directStateAccess{true};
+
+    Counter m_frame[CategoryCount];
+    Counter m_lastFrame[CategoryCount];
+};
+
+#endif // __GL_STATE_H__
@@ -0,0 +1,634 @@
+#include "gltf_loader.h"
+#include "gl_state.h"
+#include "mapped_file.h"
+#include <glm/gtc/quaternion.hpp>
+#include <nlohmann/json.hpp>
+#include <cstring>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+static const uint32_t kGlbMagic = 0x46546C67;     // "glTF"
+static const uint32_t kGlbChunkJson = 0x4E4F534A; // "JSON"
+static const uint32_t kGlbChunkBin = 0x004E4942;  // "BIN\0"
+
+// 파일 안의 byte 구간 (mmap된 메모리 또는 base64를 푼 메모리를 가리킴)
+struct GltfSpan
+{
+    const uint8_t *data{nullptr};
+    size_t size{0};
+};
+
+struct GltfContext
+{
+    json document;
+    std::string dirname;
+    std::vector<MappedFileUPtr> files;            // span이 가리키는 메모리의 소유자
+    std::vector<std::vector<uint8_t>> decoded;    // data: uri를 푼 buffer
+    std::vector<GltfSpan> buffers;
+    std::unordered_map<int, BufferPtr> glBuffers; // bufferView -> GL buffer
+    std::unordered_map<int, TexturePtr> textures; // image -> texture
+};
+
+// accessor 하나를 해석한 결과
+struct GltfAccessor
+{
+    const uint8_t *data{nullptr}; // 첫 원소
+    size_t count{0};
+    size_t stride{0};
+    int bufferView{-1};
+    size_t byteOffset{0}; // bufferView 안에서의 위치
+    uint32_t componentType{0};
+    int componentCount{0};
+    bool normalized{false};
+};
+
+// const json의 operator[]는 없는 key에 쓰면 안 되므로 배열은 이 함수로 꺼낸다.
+static const json &GetArray(const json &object, const char *key)
+{
+    static const json empty = json::array();
+    auto found = object.find(key);
+    return found != object.end() && found->is_array() ? *found : empty;
+}
+
+// ---------------------------------------------------------------------------------------
+// buffer
+
+static std::vector<uint8_t> DecodeBase64(const char *text, size_t length)
+{
+    auto Value = [](char c) -> int
+    {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        return c == '+' ? 62 : c == '/' ? 63 : -1;
+    };
+    std::vector<uint8_t> result;
+    result.reserve(length / 4 * 3);
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        int value = Value(text[i]);
+        if (value < 0) // '=' 패딩
+            break;
+        bits = (bits << 6) | value;
+        bitCount += 6;
+        if (bitCount >= 8)
+        {
+            bitCount -= 8;
+            result.push_back((uint8_t)(bits >> bitCount));
+        }
+    }
+    return result;
+}
+
+// uri가 data:...;base64,면 풀어서, 아니면 gltf 파일 기준 상대 경로의 파일을 mmap해서 읽는다.
+static bool LoadUri(GltfContext &context, const std::string &uri, GltfSpan &span)
+{
+    if (uri.compare(0, 5, "data:") == 0)
+    {
+        auto comma = uri.find(";base64,");
+        if (comma == std::string::npos)
+            return false;
+        auto payload = uri.c_str() + comma + 8;
+        context.decoded.push_back(DecodeBase64(payload, strlen(payload)));
+        span = {context.decoded.back().data(), context.decoded.back().size()};
+        return true;
+    }
+    auto file = MappedFile::Open(fmt::format("{}/{}", context.dirname, uri));
+    if (!file)
+        return false;
+    span = {file->GetData(), file->GetSize()};
+    context.files.push_back(std::move(file));
+    return true;
+}
+
+static bool GetBufferView(const GltfContext &context, int viewIndex, GltfSpan &span, size_t &stride)
+{
+    auto &views = GetArray(context.document, "bufferViews");
+    if (viewIndex < 0 || viewIndex >= (int)views.size())
+        return false;
+    auto &view = views[viewIndex];
+    int bufferIndex = view.value("buffer", -1);
+    if (bufferIndex < 0 || bufferIndex >= (int)context.buffers.size())
+        return false;
+    auto &buffer = context.buffers[bufferIndex];
+    size_t offset = view.value("byteOffset", (size_t)0);
+    size_t length = view.value("byteLength", (size_t)0);
+    if (offset + length > buffer.size)
+        return false;
+    span = {buffer.data + offset, length};
+    stride = view.value("byteStride", (size_t)0);
+    return true;
+}
+
+static size_t GetComponentSize(uint32_t componentType)
+{
+    switch (componentType)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static int GetComponentCount(const std::string &type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    if (type == "MAT4")
+        return 16;
+    return 0;
+}
+
+// glTF의 componentType 값은 GL enum (GL_FLOAT = 5126 등)과 같으므로 그대로 GL에 넘길 수 있다.
+static bool GetAccessor(const GltfContext &context, int accessorIndex, GltfAccessor &accessor)
+{
+    auto &accessors = GetArray(context.document, "accessors");
+    if (accessorIndex < 0 || accessorIndex >= (int)accessors.size())
+        return false;
+    auto &desc = accessors[accessorIndex];
+    if (!desc.contains("bufferView") || desc.contains("sparse")) // 0으로 채운 accessor, sparse는 미지원
+    {
+        SPDLOG_ERROR("unsupported gltf accessor: {}", accessorIndex);
+        return false;
+    }
+
+    accessor.bufferView = desc["bufferView"].get<int>();
+    accessor.byteOffset = desc.value("byteOffset", (size_t)0);
+    accessor.count = desc.value("count", (size_t)0);
+    accessor.componentType = desc.value("componentType", 0u);
+    accessor.componentCount = GetComponentCount(desc.value("type", std::string()));
+    accessor.normalized = desc.value("normalized", false);
+
+    GltfSpan view;
+    size_t viewStride = 0;
+    if (!GetBufferView(context, accessor.bufferView, view, viewStride))
+        return false;
+    size_t elementSize = GetComponentSize(accessor.componentType) * accessor.componentCount;
+    accessor.stride = viewStride ? viewStride : elementSize;
+    if (elementSize == 0 ||
+        (accessor.count > 0 && accessor.byteOffset + (accessor.count - 1) * accessor.stride + elementSize > view.size))
+    {
+        SPDLOG_ERROR("invalid gltf accessor: {}", accessorIndex);
+        return false;
+    }
+    accessor.data = view.data + accessor.byteOffset;
+    return true;
+}
+
+// picking용으로만 CPU에서 읽음. 정수형은 normalized면 [-1, 1] / [0, 1]로 변환
+static float ReadComponent(const GltfAccessor &accessor, const uint8_t *ptr)
+{
+    switch (accessor.componentType)
+    {
+    case GL_FLOAT:
+    {
+        float value;
+        memcpy(&value, ptr, 4);
+        return value;
+    }
+    case GL_BYTE:
+        return accessor.normalized ? glm::max(*(const int8_t *)ptr / 127.0f, -1.0f) : *(const int8_t *)ptr;
+    case GL_UNSIGNED_BYTE:
+        return accessor.normalized ? *ptr / 255.0f : *ptr;
+    case GL_SHORT:
+    {
+        int16_t value;
+        memcpy(&value, ptr, 2);
+        return accessor.normalized ? glm::max(value / 32767.0f, -1.0f) : value;
+    }
+    case GL_UNSIGNED_SHORT:
+    {
+        uint16_t value;
+        memcpy(&value, ptr, 2);
+        return accessor.normalized ? value / 65535.0f : value;
+    }
+    default:
+    {
+        uint32_t value;
+        memcpy(&value, ptr, 4);
+        return (float)value;
+    }
+    }
+}
+
+static void ReadPositions(const GltfAccessor &accessor, std::vector<glm::vec3> &positions)
+{
+    size_t componentSize = GetComponentSize(accessor.componentType);
+    positions.resize(accessor.count);
+    for (size_t i = 0; i < accessor.count; i++)
+    {
+        auto ptr = accessor.data + i * accessor.stride;
+        for (int c = 0; c < 3; c++)
+            positions[i][c] = ReadComponent(accessor, ptr + c * componentSize);
+    }
+}
+
+// index가 vertexCount 이상이면 picking의 위치 배열과 GPU의 vertex fetch가 범위를 벗어나므로 실패 처리
+static bool ReadIndices(const GltfAccessor &accessor, size_t vertexCount, std::vector<uint32_t> &indices)
+{
+    size_t componentSize = GetComponentSize(accessor.componentType);
+    if (accessor.componentCount != 1 ||
+        (accessor.componentType != GL_UNSIGNED_BYTE && accessor.componentType != GL_UNSIGNED_SHORT &&
+         accessor.componentType != GL_UNSIGNED_INT))
+    {
+        SPDLOG_ERROR("invalid gltf index type: {}", accessor.componentType);
+        return false;
+    }
+    // GetAccessor에서 count * stride가 bufferView 안에 들어가는지 확인했지만 memcpy 크기도 한 번 더 확인
+    if (accessor.stride < componentSize)
+    {
+        SPDLOG_ERROR("invalid gltf index stride: {}", accessor.stride);
+        return false;
+    }
+    indices.resize(accessor.count);
+    for (size_t i = 0; i < accessor.count; i++)
+    {
+        uint32_t value = 0; // little endian이므로 하위 byte부터 componentSize만큼 복사
+        memcpy(&value, accessor.data + i * accessor.stride, componentSize);
+        if (value >= vertexCount)
+        {
+            SPDLOG_ERROR("gltf index {} out of range (vertex count {})", value, vertexCount);
+            return false;
+        }
+        indices[i] = value;
+    }
+    return true;
+}
+
+// bufferView 하나를 통째로 GL buffer로 올림. 여러 primitive가 같은 view를 공유하면 buffer도 공유
+static BufferPtr GetGLBuffer(GltfContext &context, int viewIndex)
+{
+    auto found = context.glBuffers.find(viewIndex);
+    if (found != context.glBuffers.end())
+        return found->second;
+
+    GltfSpan view;
+    size_t stride;
+    if (!GetBufferView(context, viewIndex, view, stride))
+        return nullptr;
+    // GL buffer에는 타입이 없으므로 VAO 상태를 건드리지 않는 GL_ARRAY_BUFFER로 만들고 index buffer로도 사용
+    BufferPtr buffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW, view.data, 1, view.size);
+    context.glBuffers[viewIndex] = buffer;
+    return buffer;
+}
+
+// ---------------------------------------------------------------------------------------
+// material
+
+static TexturePtr LoadTexture(GltfContext &context, const json &textureInfo)
+{
+    int textureIndex = textureInfo.value("index", -1);
+    auto &textures = GetArray(context.document, "textures");
+    if (textureIndex < 0 || textureIndex >= (int)textures.size())
+        return nullptr;
+    int imageIndex = textures[textureIndex].value("source", -1);
+    auto &images = GetArray(context.document, "images");
+    if (imageIndex < 0 || imageIndex >= (int)images.size())
+        return nullptr;
+
+    auto found = context.textures.find(imageIndex);
+    if (found != context.textures.end())
+        return found->second;
+
+    // glTF의 uv는 좌상단이 원점이므로 uv를 뒤집는 대신 이미지를 뒤집지 않고 올린다.
+    auto &desc = images[imageIndex];
+    ImageUPtr image;
+    if (desc.contains("bufferView"))
+    {
+        GltfSpan view;
+        size_t stride;
+        if (GetBufferView(context, desc["bufferView"].get<int>(), view, stride))
+            image = Image::LoadFromMemory(view.data, view.size, false);
+    }
+    else if (desc.contains("uri"))
+    {
+        auto uri = desc["uri"].get<std::string>();
+        if (uri.compare(0, 5, "data:") == 0)
+        {
+            GltfSpan span;
+            if (LoadUri(context, uri, span))
+                image = Image::LoadFromMemory(span.data, span.size, false);
+        }
+        else
+        {
+            image = Image::Load(fmt::format("{}/{}", context.dirname, uri), false);
+        }
+    }
+
+    TexturePtr texture = image ? Texture::CreateFromImage(image.get()) : nullptr;
+    context.textures[imageIndex] = texture;
+    return texture;
+}
+
+// ---------------------------------------------------------------------------------------
+// mesh
+
+static const std::pair<const char *, uint32_t> kAttributeLocations[] = {
+    {"POSITION", 0},
+    {"NORMAL", 1},
+    {"TEXCOORD_0", 2},
+};
+
+static bool LoadPrimitive(GltfContext &context, const json &primitive, GltfData &data)
+{
+    if (!primitive.contains("attributes") || !primitive["attributes"].contains("POSITION"))
+        return false;
+    auto &attributes = primitive["attributes"];
+
+    GltfAccessor position;
+    if (!GetAccessor(context, attributes["POSITION"].get<int>(), position))
+        return false;
+
+    auto vertexLayout = VertexLayout::Create();
+    for (auto &attribute : kAttributeLocations)
+    {
+        if (!attributes.contains(attribute.first))
+            continue;
+        GltfAccessor accessor;
+        if (!GetAccessor(context, attributes[attribute.first].get<int>(), accessor))
+            return false;
+        if (accessor.count < position.count) // 모든 attribute는 POSITION과 정점 수가 같아야 함
+        {
+            SPDLOG_ERROR("gltf attribute {} has {} elements, expected {}", attribute.first, accessor.count, position.count);
+            return false;
+        }
+        auto buffer = GetGLBuffer(context, accessor.bufferView);
+        if (!buffer)
+            return false;
+        vertexLayout->SetAttrib(attribute.second, buffer->Get(), accessor.componentCount, accessor.componentType,
+                                accessor.normalized, accessor.stride, accessor.byteOffset);
+    }
+
+    uint32_t mode = primitive.value("mode", (uint32_t)GL_TRIANGLES); // glTF mode 값도 GL enum과 같음
+    BufferPtr indexBuffer;
+    GltfAccessor indices;
+    Model::MeshGeometry geometry;
+    if (primitive.contains("indices"))
+    {
+        if (!GetAccessor(context, primitive["indices"].get<int>(), indices))
+            return false;
+        indexBuffer = GetGLBuffer(context, indices.bufferView);
+        if (!indexBuffer)
+            return false;
+        // 삼각형이 아닌 mode도 GPU가 같은 index로 정점을 읽으므로 범위는 항상 검사
+        std::vector<uint32_t> indexData;
+        if (!ReadIndices(indices, position.count, indexData))
+            return false;
+        if (mode == GL_TRIANGLES)
+            geometry.indices = std::move(indexData);
+    }
+    else if (mode == GL_TRIANGLES)
+    {
+        geometry.indices.resize(position.count);
+        for (uint32_t i = 0; i < (uint32_t)position.count; i++)
+            geometry.indices[i] = i;
+    }
+    if (mode == GL_TRIANGLES)
+        ReadPositions(position, geometry.positions);
+
+    // POSITION accessor는 min / max가 필수
+    AABB aabb;
+    auto &positionDesc = GetArray(context.document, "accessors")[attributes["POSITION"].get<int>()];
+    if (positionDesc.contains("min") && positionDesc.contains("max"))
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            aabb.min[c] = positionDesc["min"][c].get<float>();
+            aabb.max[c] = positionDesc["max"][c].get<float>();
+        }
+    }
+    else
+    {
+        if (geometry.positions.empty())
+            ReadPositions(position, geometry.positions);
+        for (auto &p : geometry.positions)
+            aabb.Expand(p);
+    }
+
+    auto mesh = indexBuffer
+                    ? Mesh::CreateFromLayout(std::move(vertexLayout), indexBuffer, indices.componentType,
+                                             indices.count, indices.byteOffset, aabb, mode)
+                    : Mesh::CreateFromLayout(std::move(vertexLayout), nullptr, 0, position.count, 0, aabb, mode);
+    int materialIndex = primitive.value("material", -1);
+    if (materialIndex >= 0 && materialIndex < (int)data.materials.size())
+        mesh->SetMaterial(data.materials[materialIndex]);
+
+    data.meshes.push_back(std::move(mesh));
+    data.geometries.push_back(std::move(geometry));
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// node
+
+static glm::mat4 GetLocalTransform(const json &node)
+{
+    if (node.contains("matrix")) // column-major 16개
+    {
+        float values[16];
+        for (int i = 0; i < 16; i++)
+            values[i] = node["matrix"][i].get<float>();
+        return glm::make_mat4(values);
+    }
+
+    glm::vec3 translation(0.0f), scale(1.0f);
+    glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+    if (node.contains("translation"))
+        translation = glm::vec3(node["translation"][0].get<float>(), node["translation"][1].get<float>(), node["translation"][2].get<float>());
+    if (node.contains("rotation")) // glTF는 (x, y, z, w), glm::quat 생성자는 (w, x, y, z)
+        rotation = glm::quat(node["rotation"][3].get<float>(), node["rotation"][0].get<float>(), node["rotation"][1].get<float>(), node["rotation"][2].get<float>());
+    if (node.contains("scale"))
+        scale = glm::vec3(node["scale"][0].get<float>(), node["scale"][1].get<float>(), node["scale"][2].get<float>());
+    return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+}
+
+static void ProcessNode(const GltfContext &context, int nodeIndex, const glm::mat4 &parentTransform,
+                        const std::vector<std::vector<int>> &meshPrimitives, GltfData &data, int depth)
+{
+    auto &nodes = GetArray(context.document, "nodes");
+    if (nodeIndex < 0 || nodeIndex >= (int)nodes.size() || depth > 256) // 잘못된 파일의 순환 참조 방지
+        return;
+    auto &node = nodes[nodeIndex];
+    auto transform = parentTransform * GetLocalTransform(node);
+
+    int meshIndex = node.value("mesh", -1);
+    if (meshIndex >= 0 && meshIndex < (int)meshPrimitives.size())
+    {
+        for (int primitive : meshPrimitives[meshIndex])
+            data.nodes.push_back({primitive, transform});
+    }
+    for (auto &child : GetArray(node, "children"))
+        ProcessNode(context, child.get<int>(), transform, meshPrimitives, data, depth + 1);
+}
+
+// ---------------------------------------------------------------------------------------
+
+static bool ParseDocument(GltfContext &context, const MappedFile &file, const std::string &filename)
+{
+    auto bytes = file.GetData();
+    auto size = file.GetSize();
+    const uint8_t *jsonBegin = bytes;
+    size_t jsonSize = size;
+    GltfSpan binChunk;
+
+    uint32_t magic = 0;
+    if (size >= 12)
+        memcpy(&magic, bytes, 4);
+    if (magic == kGlbMagic)
+    {
+        // GLB: 12 byte 헤더 + (length, type, data) chunk들. 첫 chunk는 JSON, 두 번째는 BIN(선택)
+        jsonBegin = nullptr;
+        for (size_t offset = 12; offset + 8 <= size;)
+        {
+            uint32_t chunkLength, chunkType;
+            memcpy(&chunkLength, bytes + offset, 4);
+            memcpy(&chunkType, bytes + offset + 4, 4);
+            if (offset + 8 + chunkLength > size)
+                break;
+            if (chunkType == kGlbChunkJson && !jsonBegin)
+            {
+                jsonBegin = bytes + offset + 8;
+                jsonSize = chunkLength;
+            }
+            else if (chunkType == kGlbChunkBin && !binChunk.data)
+            {
+                binChunk = {bytes + offset + 8, chunkLength};
+            }
+            offset += 8 + ((chunkLength + 3) & ~3u);
+        }
+        if (!jsonBegin)
+        {
+            SPDLOG_ERROR("no json chunk in glb: {}", filename);
+            return false;
+        }
+    }
+
+    context.document = json::parse(jsonBegin, jsonBegin + jsonSize, nullptr, false);
+    if (context.document.is_discarded() || !context.document.is_object())
+    {
+        SPDLOG_ERROR("failed to parse gltf json: {}", filename);
+        return false;
+    }
+
+    auto &buffers = GetArray(context.document, "buffers");
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        GltfSpan span;
+        if (buffers[i].contains("uri"))
+        {
+            if (!LoadUri(context, buffers[i]["uri"].get<std::string>(), span))
+            {
+                SPDLOG_ERROR("failed to load gltf buffer {}: {}", i, filename);
+                return false;
+            }
+        }
+        else if (i == 0 && binChunk.data) // uri가 없는 첫 buffer는 GLB의 BIN chunk
+        {
+            span = binChunk;
+        }
+        context.buffers.push_back(span);
+    }
+    return true;
+}
+
+std::optional<GltfData> GltfLoader::Load(const std::string &filename)
+{
+    auto file = MappedFile::Open(filename);
+    if (!file)
+        return {};
+
+    GltfContext context;
+    context.dirname = filename.substr(0, filename.find_last_of("/"));
+    GltfData data;
+    try // nlohmann::json은 타입이 맞지 않으면 예외를 던지므로 로더 경계에서 잡는다.
+    {
+        if (!ParseDocument(context, *file, filename))
+            return {};
+        auto &document = context.document;
+
+        for (auto &material : GetArray(document, "materials"))
+        {
+            auto glMaterial = Material::Create();
+            // glTF 코어에는 specular map이 없으므로 base color만 diffuse로 사용
+            if (material.contains("pbrMetallicRoughness") && material["pbrMetallicRoughness"].contains("baseColorTexture"))
+                glMaterial->diffuse = LoadTexture(context, material["pbrMetallicRoughness"]["baseColorTexture"]);
+            data.materials.push_back(std::move(glMaterial));
+        }
+
+        std::vector<std::vector<int>> meshPrimitives; // glTF mesh -> data.meshes 인덱스들
+        for (auto &mesh : GetArray(document, "meshes"))
+        {
+            meshPrimitives.emplace_back();
+            for (auto &primitive : GetArray(mesh, "primitives"))
+            {
+                if (!LoadPrimitive(context, primitive, data))
+                {
+                    SPDLOG_ERROR("failed to load gltf primitive: {}", filename);
+                    return {};
+                }
+                meshPrimitives.back().push_back((int)data.meshes.size() - 1);
+            }
+        }
+        GlState::Get().BindVertexArray(0);
+
+        // scene이 없으면 어떤 node의 자식도 아닌 node들을 root로 사용
+        std::vector<int> roots;
+        auto &scenes = GetArray(document, "scenes");
+        int sceneIndex = document.value("scene", 0);
+        if (sceneIndex >= 0 && sceneIndex < (int)scenes.size())
+        {
+            for (auto &root : GetArray(scenes[sceneIndex], "nodes"))
+                roots.push_back(root.get<int>());
+        }
+        else
+        {
+            auto &nodes = GetArray(document, "nodes");
+            std::vector<bool> isChild(nodes.size(), false);
+            for (auto &node : nodes)
+            {
+                for (auto &child : GetArray(node, "children"))
+                {
+                    int childIndex = child.get<int>();
+                    if (childIndex >= 0 && childIndex < (int)nodes.size())
+                        isChild[childIndex] = true;
+                }
+            }
+            for (int i = 0; i < (int)nodes.size(); i++)
+            {
+                if (!isChild[i])
+                    roots.push_back(i);
+            }
+        }
+        for (int root : roots)
+            ProcessNode(context, root, glm::mat4(1.0f), meshPrimitives, data, 0);
+    }
+    catch (const json::exception &e)
+    {
+        SPDLOG_ERROR("invalid gltf: {}, {}", filename, e.what());
+        return {};
+    }
+
+    SPDLOG_INFO("gltf loaded: {}, #buffer view: {}, #primitive: {}, #node: {}",
+                filename, context.glBuffers.size(), data.meshes.size(), data.nodes.size());
+    return data;
+}
@@ -0,0 +1,28 @@
+#ifndef __GLTF_LOADER_H__
+#define __GLTF_LOADER_H__
+
+#include "common.h"
+#include "model.h"
+
+// glTF를 읽은 결과. Model이 그대로 넘겨받아 instance / bounds / BVH를 구성한다.
+struct GltfData
+{
+    std::vector<MaterialPtr> materials;
+    std::vector<MeshPtr> meshes;                    // primitive 하나당 Mesh 하나
+    std::vector<Model::MeshGeometry> geometries;    // meshes와 같은 인덱스, picking용 CPU 쪽 위치 / 인덱스
+    std::vector<ModelNode> nodes;
+};
+
+// glTF 2.0 (.gltf + .bin, .glb) 로더
+// 파일을 mmap해서 bufferView를 변환 없이 그대로 GL buffer로 올리고, accessor 정의로 VertexLayout을 설정한다.
+// attribute 연결: POSITION -> 0, NORMAL -> 1, TEXCOORD_0 -> 2 (lighting.vs와 같은 location)
+class GltfLoader
+{
+public:
+    static std::optional<GltfData> Load(const std::string &filename);
+
+private:
+    GltfLoader() {}
+};
+
+#endif // __GLTF_LOADER_H__
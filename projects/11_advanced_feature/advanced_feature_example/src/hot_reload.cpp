@@ -0,0 +1,190 @@
+#include "hot_reload.h"
+#include <algorithm>
+
+HotReloaderUPtr HotReloader::Create()
+{
+    auto reloader = HotReloaderUPtr(new HotReloader());
+    reloader->m_watcher = FileWatcher::Create();
+    if (!reloader->m_watcher)
+        return nullptr;
+    return std::move(reloader);
+}
+
+std::vector<std::string> HotReloader::WatchProgramFiles(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                                                        const std::vector<std::string> &defines)
+{
+    // 지금 읽고 있는 파일만으로는 새로 include한 파일을 모르므로 다시 읽을 때마다 갱신
+    std::vector<std::string> files;
+    for (auto &filename : {vertShaderFilename, fragShaderFilename})
+    {
+        std::vector<std::string> sourceFiles;
+        if (!Shader::Preprocess(filename, defines, &sourceFiles))
+            sourceFiles = {filename}; // 읽지 못해도 고쳐서 저장하면 다시 시도할 수 있도록 감시
+        for (auto &sourceFile : sourceFiles)
+        {
+            auto path = FileWatcher::NormalizePath(sourceFile);
+            if (std::find(files.begin(), files.end(), path) == files.end())
+            {
+                m_watcher->Watch(path);
+                files.push_back(path);
+            }
+        }
+    }
+    return files;
+}
+
+void HotReloader::WatchProgram(ProgramUPtr *target, const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                               const std::vector<std::string> &defines,
+                               std::function<void(const Program *)> setup)
+{
+    ProgramEntry entry;
+    entry.target = target;
+    entry.vertShaderFilename = vertShaderFilename;
+    entry.fragShaderFilename = fragShaderFilename;
+    entry.defines = defines;
+    entry.setup = std::move(setup);
+    entry.files = WatchProgramFiles(vertShaderFilename, fragShaderFilename, defines);
+    m_programs.push_back(std::move(entry));
+}
+
+void HotReloader::WatchProgramVariants(ProgramVariants *variants)
+{
+    // #ifdef 안의 include도 모두 펼쳐지므로 define 없이 읽은 목록이 모든 variant의 파일을 포함함
+    VariantsEntry entry;
+    entry.variants = variants;
+    entry.files = WatchProgramFiles(variants->GetVertShaderFilename(), variants->GetFragShaderFilename(), {});
+    m_variants.push_back(std::move(entry));
+}
+
+void HotReloader::WatchTexture(TexturePtr texture, const std::string &filename,
+                               std::function<void(const Texture *)> onReload)
+{
+    TextureEntry entry;
+    entry.texture = texture;
+    entry.filename = FileWatcher::NormalizePath(filename);
+    entry.onReload = onReload;
+    m_watcher->Watch(entry.filename);
+    m_textures.push_back(std::move(entry));
+}
+
+void HotReloader::WatchModel(ModelUPtr *target, const std::string &filename)
+{
+    auto path = FileWatcher::NormalizePath(filename);
+    m_watcher->Watch(path);
+    m_models.push_back({target, path});
+}
+
+void HotReloader::Report(const std::string &name, Clock::time_point start)
+{
+    m_lastReloadTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    m_reloadCount++;
+    SPDLOG_INFO("hot reloaded: {} ({:.3f} ms)", name, m_lastReloadTime);
+}
+
+void HotReloader::Update()
+{
+    auto changed = m_watcher->Poll();
+    auto now = Clock::now();
+    auto Changed = [&](const std::string &file)
+    { return std::find(changed.begin(), changed.end(), file) != changed.end(); };
+    auto AnyChanged = [&](const std::vector<std::string> &files)
+    { return std::any_of(files.begin(), files.end(), Changed); };
+
+    for (auto &entry : m_programs)
+    {
+        auto Name = [&]()
+        { return fmt::format("{}, {}", entry.vertShaderFilename, entry.fragShaderFilename); };
+        if (!changed.empty() && AnyChanged(entry.files))
+        {
+            // 컴파일 중에 또 바뀌었으면 이전 요청은 버리고 새로 요청
+            entry.files = WatchProgramFiles(entry.vertShaderFilename, entry.fragShaderFilename, entry.defines);
+            entry.pending = Program::Submit(entry.vertShaderFilename, entry.fragShaderFilename, entry.defines);
+            entry.start = now;
+            if (!entry.pending)
+                SPDLOG_ERROR("hot reload failed, keeping previous program: {}", Name());
+        }
+        if (!entry.pending || !entry.pending->IsCompleted())
+            continue;
+        auto program = std::move(entry.pending);
+        if (!program->Finish())
+        {
+            SPDLOG_ERROR("hot reload failed, keeping previous program: {}", Name());
+            continue;
+        }
+        if (entry.setup)
+            entry.setup(program.get());
+        if (*entry.target)
+            (*entry.target)->Swap(*program); // 다른 곳에서 들고 있는 포인터도 새 program을 쓰게 됨
+        else
+            *entry.target = std::move(program);
+        Report(Name(), entry.start);
+    }
+
+    for (auto &entry : m_variants)
+    {
+        auto variants = entry.variants;
+        if (!changed.empty() && AnyChanged(entry.files))
+        {
+            entry.files = WatchProgramFiles(variants->GetVertShaderFilename(), variants->GetFragShaderFilename(), {});
+            variants->Reload();
+            entry.reloading = true;
+            entry.start = now;
+        }
+        if (entry.reloading && variants->PollReload() == 0)
+        {
+            entry.reloading = false;
+            Report(fmt::format("{}, {} (variants)", variants->GetVertShaderFilename(), variants->GetFragShaderFilename()),
+                   entry.start);
+        }
+    }
+
+    for (auto &entry : m_textures)
+    {
+        auto LoadAsync = [&]()
+        {
+            entry.start = Clock::now();
+            entry.pending = std::async(std::launch::async, [filename = entry.filename]()
+                                       { return Image::Load(filename); });
+        };
+        if (!changed.empty() && Changed(entry.filename))
+        {
+            if (entry.pending.valid())
+                entry.changedAgain = true;
+            else
+                LoadAsync();
+        }
+        if (!entry.pending.valid() || entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            continue;
+        auto image = entry.pending.get();
+        if (image)
+        {
+            entry.texture->SetImage(image.get());
+            if (entry.onReload)
+                entry.onReload(entry.texture.get());
+            Report(entry.filename, entry.start);
+        }
+        else
+        {
+            SPDLOG_ERROR("hot reload failed, keeping previous texture: {}", entry.filename);
+        }
+        if (entry.changedAgain)
+        {
+            entry.changedAgain = false;
+            LoadAsync();
+        }
+    }
+
+    for (auto &entry : m_models)
+    {
+        if (changed.empty() || !Changed(entry.filename))
+            continue;
+        auto model = Model::Load(entry.filename);
+        if (!model)
+        {
+            SPDLOG_ERROR("hot reload failed, keeping previous model: {}", entry.filename);
+            continue;
+        }
+        *entry.target = std::move(model);
+        Report(entry.filename, now);
+    }
+}
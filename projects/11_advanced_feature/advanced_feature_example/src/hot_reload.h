@@ -0,0 +1,89 @@
+#ifndef __HOT_RELOAD_H__
+#define __HOT_RELOAD_H__
+
+#include "common.h"
+#include "file_watcher.h"
+#include "program.h"
+#include "texture.h"
+#include "model.h"
+#include <chrono>
+#include <future>
+
+// 실행 중에 shader / texture / model 파일이 다시 저장되면 그 파일을 쓰는 object만 다시 만들어서 교체
+// 교체는 항상 Update() 안, 즉 프레임 경계에서만 일어나고 준비가 끝나기 전에는 이전 object로 계속 그린다.
+// 다시 만드는 데 실패하면 이전 object를 그대로 둠 (shader를 고치는 중에 오타가 있어도 화면이 깨지지 않도록)
+CLASS_PTR(HotReloader)
+class HotReloader
+{
+public:
+    static HotReloaderUPtr Create(); // 파일 감시를 쓸 수 없으면 nullptr
+
+    // shader나 shader가 include한 파일이 바뀌면 driver에 컴파일을 요청하고, 끝나면 setup을 부른 뒤 같은 Program object에 Swap
+    // *target이 비어 있으면 (처음 컴파일이 실패한 경우 등) 새 program을 넣음
+    void WatchProgram(ProgramUPtr *target, const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                      const std::vector<std::string> &defines = {},
+                      std::function<void(const Program *)> setup = nullptr);
+    void WatchProgramVariants(ProgramVariants *variants);
+    // 이미지 decode는 worker 스레드에서 하고 GL 업로드만 Update에서 같은 Texture object에 함
+    // onReload는 업로드 직후 호출 (texture를 복사해 둔 곳을 갱신할 때)
+    void WatchTexture(TexturePtr texture, const std::string &filename,
+                      std::function<void(const Texture *)> onReload = nullptr);
+    // Model::Load는 GL buffer를 만들기 때문에 Update 안에서 읽어서 *target을 교체
+    void WatchModel(ModelUPtr *target, const std::string &filename);
+
+    void Update(); // 프레임 시작에서 호출
+    int GetReloadCount() const { return m_reloadCount; }
+    float GetLastReloadTime() const { return m_lastReloadTime; } // ms, 파일 변경을 감지한 때부터 교체까지
+
+private:
+    HotReloader() {}
+    using Clock = std::chrono::high_resolution_clock;
+
+    // vertex / fragment shader가 읽는 모든 파일 (include 포함)을 감시 목록에 추가하고 반환
+    std::vector<std::string> WatchProgramFiles(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                                               const std::vector<std::string> &defines);
+    void Report(const std::string &name, Clock::time_point start);
+
+    struct ProgramEntry
+    {
+        ProgramUPtr *target;
+        std::string vertShaderFilename;
+        std::string fragShaderFilename;
+        std::vector<std::string> defines;
+        std::function<void(const Program *)> setup;
+        std::vector<std::string> files;
+        ProgramUPtr pending; // 컴파일 중인 새 program
+        Clock::time_point start;
+    };
+    struct VariantsEntry
+    {
+        ProgramVariants *variants;
+        std::vector<std::string> files;
+        bool reloading{false};
+        Clock::time_point start;
+    };
+    struct TextureEntry
+    {
+        TexturePtr texture;
+        std::string filename;
+        std::function<void(const Texture *)> onReload;
+        std::future<ImageUPtr> pending; // worker 스레드에서 읽는 중인 이미지
+        bool changedAgain{false};       // 읽는 중에 또 바뀜. 끝나면 한 번 더 읽음
+        Clock::time_point start;
+    };
+    struct ModelEntry
+    {
+        ModelUPtr *target;
+        std::string filename;
+    };
+
+    FileWatcherUPtr m_watcher;
+    std::vector<ProgramEntry> m_programs;
+    std::vector<VariantsEntry> m_variants;
+    std::vector<TextureEntry> m_textures;
+    std::vector<ModelEntry> m_models;
+    int m_reloadCount{0};
+    float m_lastReloadTime{0.0f};
+};
+
+#endif // __HOT_RELOAD_H__
@@ -2,10 +2,18 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
-ImageUPtr Image::Load(const std::string &filepath)
+ImageUPtr Image::Load(const std::string &filepath, bool flipVertical)
 {
     auto image = ImageUPtr(new Image());
-    if (!image->LoadWithStb(filepath))
+    if (!image->LoadWithStb(filepath, flipVertical))
+        return nullptr;
+    return std::move(image);
+}
+
+ImageUPtr Image::LoadFromMemory(const uint8_t *data, size_t size, bool flipVertical)
+{
+    auto image = ImageUPtr(new Image());
+    if (!image->LoadFromMemoryWithStb(data, size, flipVertical))
         return nullptr;
     return std::move(image);
 }
@@ -18,10 +26,12 @@ Image::~Image()
     }
 }
 
-bool Image::LoadWithStb(const std::string &filepath)
+bool Image::LoadWithStb(const std::string &filepath, bool flipVertical)
 {
     // 이미지 상하 반전의 이유 : 보통의 이미지는 좌상단을 원점으로 함. OpenGL은 좌하단을 원점으로 함.
-    stbi_set_flip_vertically_on_load(true); // 이미지 로딩시 상하를 반전시켜서 문제를 해결할 수 있음
+    // 이미지 로딩시 상하를 반전시켜서 문제를 해결할 수 있음
+    // hot reload가 worker 스레드에서 읽으므로 전역 설정 대신 스레드별 설정을 사용
+    stbi_set_flip_vertically_on_load_thread(flipVertical);
 
     m_data = stbi_load(filepath.c_str(), &m_width, &m_height, &m_channelCount, 0);
     if (!m_data)
@@ -32,6 +42,19 @@ bool Image::LoadWithStb(const std::string &filepath)
     return true;
 }
 
+bool Image::LoadFromMemoryWithStb(const uint8_t *data, size_t size, bool flipVertical)
+{
+    stbi_set_flip_vertically_on_load_thread(flipVertical);
+
+    m_data = stbi_load_from_memory(data, (int)size, &m_width, &m_height, &m_channelCount, 0);
+    if (!m_data)
+    {
+        SPDLOG_ERROR("failed to load image from memory: {} bytes", size);
+        return false;
+    }
+    return true;
+}
+
 ImageUPtr Image::Create(int width, int height, int channelCount)
 {
     auto image = ImageUPtr(new Image());
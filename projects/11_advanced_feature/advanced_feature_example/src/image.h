@@ -7,7 +7,8 @@ CLASS_PTR(Image)
 class Image
 {
 public:
-    static ImageUPtr Load(const std::string &filepath);
+    static ImageUPtr Load(const std::string &filepath, bool flipVertical = true);
+    static ImageUPtr LoadFromMemory(const uint8_t *data, size_t size, bool flipVertical = true); // png, jpg 등 인코딩된 파일 내용
     static ImageUPtr Create(int width, int height, int channelCount = 4);
     ~Image();
 
@@ -21,7 +22,8 @@ public:
 
 private:
     Image(){};
-    bool LoadWithStb(const std::string &filepath);
+    bool LoadWithStb(const std::string &filepath, bool flipVertical);
+    bool LoadFromMemoryWithStb(const uint8_t *data, size_t size, bool flipVertical);
     bool Allocate(int width, int height, int channelCount);
 
     int m_width{0};
@@ -1,5 +1,8 @@
 #include "common.h"
 #include "context.h"
+#include "gl_state.h"
+#include "vertex_format.h"
+#include <cmath>
 
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -64,6 +67,37 @@ int main(int argc, const char **argv)
 {
     SPDLOG_INFO("start program");
 
+    // --compress-model <원본 model> <출력 .mshc>: 창을 띄우지 않고 model을 압축 포맷으로 변환만 하고 종료
+    if (argc >= 4 && std::string(argv[1]) == "--compress-model")
+        return Model::Compress(argv[2], argv[3]) ? 0 : -1;
+
+    // --bake-vat <원본 model> <출력 .vat> [frame rate]: skinned model의 animation을 vertex animation texture로 굽고 종료
+    if (argc >= 4 && std::string(argv[1]) == "--bake-vat")
+    {
+        float frameRate = 30.0f;
+        if (argc >= 5)
+        {
+            char *end = nullptr;
+            frameRate = strtof(argv[4], &end);
+            if (end == argv[4] || *end != '\0' || !(frameRate > 0.0f) || !std::isfinite(frameRate))
+            {
+                SPDLOG_ERROR("invalid frame rate: {}", argv[4]);
+                return -1;
+            }
+        }
+        return Model::BakeVertexAnimation(argv[2], argv[3], frameRate) ? 0 : -1;
+    }
+
+    // --no-dsa: GL 4.5 direct state access를 지원해도 GL 3.3의 bind 방식으로 리소스를 만듦 (bind 수 비교용)
+    // --no-shared-vao: 같은 정점 형식끼리 VAO를 공유하지 않고 mesh마다 VAO를 만듦 (VAO 전환 수 비교용)
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--no-dsa")
+            GlState::Get().SetDirectStateAccess(false);
+        else if (std::string(argv[i]) == "--no-shared-vao")
+            VertexFormatRegistry::Get().SetEnabled(false);
+    }
+
     // glfw 라이브러리 초기화, 실패하면 에러 출력후 종료
     SPDLOG_INFO("Initialize glfw");
     if (!glfwInit()) // glfw 라이브러리 초기화를 실패하면
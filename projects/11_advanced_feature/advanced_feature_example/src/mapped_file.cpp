@@ -0,0 +1,109 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFileUPtr MappedFile::Open(const std::string &filename)
+{
+    auto file = MappedFileUPtr(new MappedFile());
+    if (!file->Map(filename))
+        return nullptr;
+    return std::move(file);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Map(const std::string &filename)
+{
+    m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+        return false;
+    m_size = (size_t)size.QuadPart;
+    if (m_size == 0) // 빈 파일은 매핑할 수 없음
+        return true;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    m_data = (const uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_data)
+    {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+}
+
+#else
+
+bool MappedFile::Map(const std::string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_size = (size_t)info.st_size;
+    if (m_size == 0) // 빈 파일은 매핑할 수 없음
+    {
+        close(fd);
+        return true;
+    }
+
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // 매핑은 fd를 닫아도 유지됨
+    if (data == MAP_FAILED)
+    {
+        SPDLOG_ERROR("failed to map file: {}", filename);
+        return false;
+    }
+    madvise(data, m_size, MADV_SEQUENTIAL); // 앞에서부터 순서대로 읽으므로 read-ahead를 늘림
+    m_data = (const uint8_t *)data;
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        munmap((void *)m_data, m_size);
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include "common.h"
+
+// 파일을 읽기 전용으로 메모리에 매핑. 복사 없이 파일 내용을 포인터로 바로 접근한다.
+CLASS_PTR(MappedFile)
+class MappedFile
+{
+public:
+    static MappedFileUPtr Open(const std::string &filename);
+    ~MappedFile();
+
+    const uint8_t *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    MappedFile() {}
+    bool Map(const std::string &filename);
+
+    const uint8_t *m_data{nullptr};
+    size_t m_size{0};
+#ifdef _WIN32
+    void *m_file{nullptr};
+    void *m_mapping{nullptr};
+#endif
+};
+
+#endif // __MAPPED_FILE_H__
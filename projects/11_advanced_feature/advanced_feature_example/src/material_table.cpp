@@ -0,0 +1,128 @@
+#include "material_table.h"
+#include "gl_state.h"
+#include <algorithm>
+
+MaterialTableUPtr MaterialTable::Create(int layerSize, int maxLayers)
+{
+    auto table = MaterialTableUPtr(new MaterialTable());
+    if (!table->Init(layerSize, maxLayers))
+        return nullptr;
+    return std::move(table);
+}
+
+MaterialTable::~MaterialTable()
+{
+    if (m_textureArray)
+        glDeleteTextures(1, &m_textureArray);
+    if (m_framebuffers[0])
+        glDeleteFramebuffers(2, m_framebuffers);
+}
+
+bool MaterialTable::Init(int layerSize, int maxLayers)
+{
+    m_layerSize = layerSize;
+    m_maxLayers = maxLayers;
+    m_buffer = Buffer::CreateWithData(GL_UNIFORM_BUFFER, GL_DYNAMIC_DRAW, nullptr, sizeof(MaterialEntry), kMaxMaterials);
+    if (!m_buffer)
+        return false;
+
+    // mipmap 공간은 glGenerateMipmap이 할당
+    glGenTextures(1, &m_textureArray);
+    GlState::Get().ActiveTexture(kMaterialTextureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_layerSize, m_layerSize, m_maxLayers, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GlState::Get().ActiveTexture(0);
+
+    glGenFramebuffers(2, m_framebuffers);
+    return true;
+}
+
+void MaterialTable::BindBlock(const Program *program)
+{
+    program->SetUniformBlockBinding("Materials", kMaterialBinding);
+    program->Use();
+    program->SetUniform("materialTextures", kMaterialTextureUnit);
+}
+
+int MaterialTable::Add(const MaterialPtr &material)
+{
+    if (material->tableIndex >= 0)
+        return material->tableIndex;
+    if ((int)m_entries.size() >= kMaxMaterials)
+    {
+        SPDLOG_ERROR("material table is full: {}", kMaxMaterials);
+        return -1;
+    }
+    int diffuseLayer = FindOrAddLayer(material->diffuse.get());
+    int specularLayer = FindOrAddLayer(material->specular.get());
+    if ((material->diffuse && diffuseLayer < 0) || (material->specular && specularLayer < 0))
+        return -1;
+
+    MaterialEntry entry;
+    entry.params = glm::vec4(material->shininess, (float)diffuseLayer, (float)specularLayer, 0.0f);
+    int index = (int)m_entries.size();
+    m_entries.push_back(entry);
+    m_buffer->SetSubData(index * sizeof(MaterialEntry), &entry, sizeof(MaterialEntry));
+    material->tableIndex = index;
+    return index;
+}
+
+int MaterialTable::FindOrAddLayer(const Texture *texture)
+{
+    if (!texture)
+        return -1;
+    auto it = std::find(m_layers.begin(), m_layers.end(), texture);
+    if (it != m_layers.end())
+        return (int)(it - m_layers.begin());
+    if ((int)m_layers.size() >= m_maxLayers)
+    {
+        SPDLOG_ERROR("material texture array is full: {} layers", m_maxLayers);
+        return -1;
+    }
+    int layer = (int)m_layers.size();
+    m_layers.push_back(texture);
+    CopyToLayer(texture, layer);
+    return layer;
+}
+
+void MaterialTable::UpdateTexture(const Texture *texture)
+{
+    auto it = std::find(m_layers.begin(), m_layers.end(), texture);
+    if (it != m_layers.end())
+        CopyToLayer(texture, (int)(it - m_layers.begin()));
+}
+
+void MaterialTable::CopyToLayer(const Texture *texture, int layer)
+{
+    // 원본 크기를 읽어서 framebuffer blit으로 layer 크기에 맞춰 복사 (GL 3.3에서 GPU 안에서만 복사하는 방법)
+    int width = 0, height = 0;
+    texture->Bind();
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffers[0]);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->Get(), 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffers[1]);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, m_textureArray, 0, layer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, m_layerSize, m_layerSize, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_mipmapDirty = true;
+}
+
+void MaterialTable::Bind()
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, kMaterialBinding, m_buffer->Get());
+    GlState::Get().ActiveTexture(kMaterialTextureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray); // GlState는 GL_TEXTURE_2D만 기억하므로 직접 bind
+    if (m_mipmapDirty)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        m_mipmapDirty = false;
+    }
+    GlState::Get().ActiveTexture(0);
+}
@@ -0,0 +1,60 @@
+#ifndef __MATERIAL_TABLE_H__
+#define __MATERIAL_TABLE_H__
+
+#include "common.h"
+#include "buffer.h"
+#include "mesh.h"
+
+// 모든 material을 uniform block 하나에, texture를 GL_TEXTURE_2D_ARRAY 하나에 모아 둔 table
+// MATERIAL_TABLE로 컴파일한 program(include/material.glsl)은 draw마다 materialIndex uniform 하나만 바꾸면 되므로
+// material이 바뀌어도 texture를 다시 bind하지 않고, 여러 material을 한 buffer에 합쳐 그릴 수도 있다.
+// texture는 layerSize x layerSize로 늘리거나 줄여서 복사하므로 크기가 비슷한 texture끼리 쓰는 것이 좋음
+static const uint32_t kMaterialBinding = 3; // uniform block binding point (0: BonePalette, 1: Camera, 2: Light)
+static const int kMaterialTextureUnit = 4;   // 0, 1은 material, 2, 3은 vertex animation이 사용
+static const int kMaxMaterials = 256;         // include/material.glsl의 MAX_MATERIALS
+
+// std140 배치와 같도록 vec4 하나
+struct MaterialEntry
+{
+    glm::vec4 params; // shininess, diffuse layer, specular layer (texture가 없으면 -1)
+};
+static_assert(sizeof(MaterialEntry) == 16, "MaterialEntry must match std140 layout");
+
+CLASS_PTR(MaterialTable)
+class MaterialTable
+{
+public:
+    static MaterialTableUPtr Create(int layerSize = 512, int maxLayers = 16);
+    ~MaterialTable();
+
+    // program의 Materials block과 materialTextures sampler를 binding point / texture unit에 연결
+    static void BindBlock(const Program *program);
+
+    // material을 table에 넣고 material->tableIndex를 설정. 같은 texture는 layer 하나를 공유
+    // table이나 texture array가 가득 차면 -1 (material은 기존 방식으로 그려야 함)
+    int Add(const MaterialPtr &material);
+    // 내용이 바뀐 texture (hot reload 등)를 쓰는 layer를 다시 복사
+    void UpdateTexture(const Texture *texture);
+    // uniform block과 texture array를 연결. 새로 복사한 layer가 있으면 mipmap도 여기서 다시 만듦
+    void Bind();
+
+    int GetMaterialCount() const { return (int)m_entries.size(); }
+    int GetLayerCount() const { return (int)m_layers.size(); }
+
+private:
+    MaterialTable() {}
+    bool Init(int layerSize, int maxLayers);
+    int FindOrAddLayer(const Texture *texture); // texture가 없으면 -1
+    void CopyToLayer(const Texture *texture, int layer);
+
+    BufferUPtr m_buffer; // MaterialEntry * kMaxMaterials
+    std::vector<MaterialEntry> m_entries;
+    uint32_t m_textureArray{0};
+    uint32_t m_framebuffers[2]{0, 0}; // 복사용 read / draw framebuffer
+    int m_layerSize{0};
+    int m_maxLayers{0};
+    std::vector<const Texture *> m_layers; // layer마다 복사해 온 texture. GL 이름은 SetImage에서 바뀔 수 있어 Texture로 구분
+    bool m_mipmapDirty{false};
+};
+
+#endif // __MATERIAL_TABLE_H__
@@ -1,20 +1,27 @@
 #include "mesh.h"
+#include "gl_state.h"
+#include <chrono>
+#include <cstring>
 
 MeshUPtr Mesh::Create(
     const std::vector<Vertex> &vertices,
     const std::vector<uint32_t> &indices,
-    uint32_t primitiveType)
+    uint32_t primitiveType,
+    bool positionStream)
 {
     auto mesh = MeshUPtr(new Mesh());
-    mesh->Init(vertices, indices, primitiveType);
+    mesh->Init(vertices, indices, primitiveType, positionStream);
     return std::move(mesh);
 }
 
 void Mesh::Init(
     const std::vector<Vertex> &vertices,
     const std::vector<uint32_t> &indices,
-    uint32_t primitiveType)
+    uint32_t primitiveType,
+    bool positionStream)
 {
+    m_primitiveType = primitiveType;
+    m_count = indices.size();
     m_vertexLayout = VertexLayout::Create();
     m_vertexBuffer = Buffer::CreateWithData(
         GL_ARRAY_BUFFER, GL_STATIC_DRAW,
@@ -22,9 +29,154 @@ void Mesh::Init(
     m_indexBuffer = Buffer::CreateWithData(
         GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
         indices.data(), sizeof(uint32_t), indices.size());
-    m_vertexLayout->SetAttrib(0, 3, GL_FLOAT, false, sizeof(Vertex), 0);
-    m_vertexLayout->SetAttrib(1, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
-    m_vertexLayout->SetAttrib(2, 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
+    m_vertexLayout->SetAttrib(0, m_vertexBuffer->Get(), 3, GL_FLOAT, false, sizeof(Vertex), 0);
+    m_vertexLayout->SetAttrib(1, m_vertexBuffer->Get(), 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
+    m_vertexLayout->SetAttrib(2, m_vertexBuffer->Get(), 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
+    m_vertexLayout->SetIndexBuffer(m_indexBuffer->Get());
+
+    if (positionStream)
+    {
+        // normal, texCoord를 건너뛰는 32 byte stride 대신 12 byte 간격으로 위치만 읽도록 따로 복사
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+            positions[i] = vertices[i].position;
+        m_positionLayout = VertexLayout::Create();
+        m_positionBuffer = Buffer::CreateWithData(
+            GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+            positions.data(), sizeof(glm::vec3), positions.size());
+        m_positionLayout->SetAttrib(0, m_positionBuffer->Get(), 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+        m_positionLayout->SetIndexBuffer(m_indexBuffer->Get());
+    }
+
+    ComputeBounds(vertices);
+}
+
+void Mesh::ComputeBounds(const std::vector<Vertex> &vertices)
+{
+    // culling에 쓸 bounding volume 계산. sphere는 box 중심에서 가장 먼 정점까지를 반지름으로 한다.
+    for (auto &vertex : vertices)
+        m_aabb.Expand(vertex.position);
+    m_boundingSphere.center = m_aabb.GetCenter();
+    for (auto &vertex : vertices)
+        m_boundingSphere.radius = glm::max(m_boundingSphere.radius, glm::length(vertex.position - m_boundingSphere.center));
+}
+
+MeshUPtr Mesh::CreateDynamic(
+    const std::vector<Vertex> &vertices,
+    const std::vector<uint32_t> &indices,
+    uint32_t primitiveType,
+    MeshUpdateMode updateMode)
+{
+    auto mesh = MeshUPtr(new Mesh());
+    mesh->InitDynamic(vertices, indices, primitiveType, updateMode);
+    return std::move(mesh);
+}
+
+void Mesh::InitDynamic(
+    const std::vector<Vertex> &vertices,
+    const std::vector<uint32_t> &indices,
+    uint32_t primitiveType,
+    MeshUpdateMode updateMode)
+{
+    m_primitiveType = primitiveType;
+    m_count = indices.size();
+    m_dynamic = true;
+    m_updateMode = updateMode;
+    m_vertexCount = vertices.size();
+
+    m_vertexLayout = VertexLayout::Create();
+    if (updateMode == MeshUpdateMode::PersistentRing)
+    {
+        // 구간 하나에 정점 전체가 들어가고, 구간 전환은 base vertex로 처리하므로 attribute offset은 고정
+        m_streamBuffer = StreamBuffer::Create(GL_ARRAY_BUFFER, sizeof(Vertex) * m_vertexCount);
+    }
+    else
+    {
+        m_vertexBuffer = Buffer::CreateWithData(
+            GL_ARRAY_BUFFER, updateMode == MeshUpdateMode::Orphan ? GL_STREAM_DRAW : GL_DYNAMIC_DRAW,
+            nullptr, sizeof(Vertex), m_vertexCount);
+    }
+    m_indexBuffer = Buffer::CreateWithData(
+        GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+        indices.data(), sizeof(uint32_t), indices.size());
+    uint32_t vertexBuffer = m_streamBuffer ? m_streamBuffer->Get() : m_vertexBuffer->Get();
+    m_vertexLayout->SetAttrib(0, vertexBuffer, 3, GL_FLOAT, false, sizeof(Vertex), 0);
+    m_vertexLayout->SetAttrib(1, vertexBuffer, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
+    m_vertexLayout->SetAttrib(2, vertexBuffer, 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
+    m_vertexLayout->SetIndexBuffer(m_indexBuffer->Get());
+
+    UpdateVertices(vertices.data(), vertices.size());
+    ComputeBounds(vertices);
+}
+
+void Mesh::UpdateVertices(const Vertex *vertices, size_t count, size_t firstVertex)
+{
+    if (!m_dynamic || firstVertex + count > m_vertexCount ||
+        (m_updateMode != MeshUpdateMode::SubData && firstVertex != 0))
+    {
+        SPDLOG_ERROR("invalid vertex update: first {}, count {}, capacity {}", firstVertex, count, m_vertexCount);
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t size = sizeof(Vertex) * count;
+    switch (m_updateMode)
+    {
+    case MeshUpdateMode::SubData:
+        m_vertexBuffer->SetSubData(sizeof(Vertex) * firstVertex, vertices, size);
+        break;
+    case MeshUpdateMode::Orphan:
+        m_vertexBuffer->Orphan();
+        m_vertexBuffer->SetSubData(0, vertices, size);
+        break;
+    case MeshUpdateMode::PersistentRing:
+        memcpy(m_streamBuffer->BeginWrite(), vertices, size);
+        m_streamBuffer->EndWrite(size);
+        m_baseVertex = (int)(m_streamBuffer->GetRegion() * m_vertexCount);
+        break;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastUpdateTime = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void Mesh::SetInstanceTransforms(const std::vector<glm::mat4> &transforms)
+{
+    // 매 프레임 갱신하는 경우: attribute는 이미 연결되어 있으므로 내용만 교체
+    // (glBufferData로 새 저장 공간을 받으므로 GPU가 이전 내용을 읽는 중이어도 기다리지 않음)
+    if (m_instanceBuffer)
+    {
+        m_instanceBuffer->SetData(transforms.data(), sizeof(glm::mat4), transforms.size());
+        return;
+    }
+
+    m_instanceBuffer = Buffer::CreateWithData(
+        GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+        transforms.data(), sizeof(glm::mat4), transforms.size());
+    // mat4 attribute는 vec4 4개의 attribute 슬롯을 차지한다.
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        m_vertexLayout->SetAttrib(3 + i, m_instanceBuffer->Get(), 4, GL_FLOAT, false, sizeof(glm::mat4), sizeof(glm::vec4) * i);
+        m_vertexLayout->SetAttribDivisor(3 + i, 1);
+    }
+
+    // 위치 전용 VAO도 같은 instance buffer를 읽음
+    if (m_positionLayout)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            m_positionLayout->SetAttrib(3 + i, m_instanceBuffer->Get(), 4, GL_FLOAT, false, sizeof(glm::mat4), sizeof(glm::vec4) * i);
+            m_positionLayout->SetAttribDivisor(3 + i, 1);
+        }
+    }
+}
+
+void Mesh::SetInstanceAnimations(const std::vector<glm::vec2> &clipTimes)
+{
+    m_instanceAnimationBuffer = Buffer::CreateWithData(
+        GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+        clipTimes.data(), sizeof(glm::vec2), clipTimes.size());
+    m_vertexLayout->SetAttrib(9, m_instanceAnimationBuffer->Get(), 2, GL_FLOAT, false, sizeof(glm::vec2), 0);
+    m_vertexLayout->SetAttribDivisor(9, 1);
 }
 
 void Mesh::Draw(const Program *program) const
@@ -34,12 +186,100 @@ void Mesh::Draw(const Program *program) const
     {
         m_material->SetToProgram(program);
     }
-    glDrawElements(m_primitiveType, m_indexBuffer->GetCount(), GL_UNSIGNED_INT, 0);
+    DrawCall();
+}
+
+void Mesh::DrawPositionOnly() const
+{
+    m_positionLayout->Bind();
+    DrawCall();
+}
+
+void Mesh::DrawCall() const
+{
+    auto indices = (const void *)m_indexOffset;
+    if (!m_indexBuffer) // index 없이 정점 순서대로 그리는 mesh (glTF)
+    {
+        if (m_instanceBuffer)
+            glDrawArraysInstanced(m_primitiveType, m_baseVertex, (GLsizei)m_count, (GLsizei)m_instanceBuffer->GetCount());
+        else
+            glDrawArrays(m_primitiveType, m_baseVertex, (GLsizei)m_count);
+    }
+    else if (m_baseVertex != 0) // ring buffer의 현재 구간
+    {
+        if (m_instanceBuffer)
+            glDrawElementsInstancedBaseVertex(m_primitiveType, (GLsizei)m_count, m_indexType, indices, (GLsizei)m_instanceBuffer->GetCount(), m_baseVertex);
+        else
+            glDrawElementsBaseVertex(m_primitiveType, (GLsizei)m_count, m_indexType, indices, m_baseVertex);
+    }
+    else if (m_instanceBuffer) // 같은 mesh를 참조하는 node들을 draw call 한 번으로 그림
+        glDrawElementsInstanced(m_primitiveType, (GLsizei)m_count, m_indexType, indices, (GLsizei)m_instanceBuffer->GetCount());
+    else
+        glDrawElements(m_primitiveType, (GLsizei)m_count, m_indexType, indices);
 }
 
-MeshUPtr Mesh::CreateBox()
+MeshUPtr Mesh::CreateFromLayout(
+    VertexLayoutUPtr vertexLayout, BufferPtr indexBuffer,
+    uint32_t indexType, size_t count, size_t indexOffset,
+    const AABB &aabb, uint32_t primitiveType)
 {
-    std::vector<Vertex> vertices = {
+    auto mesh = MeshUPtr(new Mesh());
+    mesh->m_vertexLayout = std::move(vertexLayout);
+    mesh->m_indexBuffer = indexBuffer;
+    mesh->m_indexType = indexType;
+    mesh->m_count = count;
+    mesh->m_indexOffset = indexOffset;
+    mesh->m_primitiveType = primitiveType;
+
+    // 정점을 CPU에서 보지 않으므로 sphere는 box를 감싸는 구로 잡는다.
+    mesh->m_aabb = aabb;
+    mesh->m_boundingSphere.center = aabb.GetCenter();
+    mesh->m_boundingSphere.radius = glm::length(aabb.max - aabb.min) * 0.5f;
+
+    // VAO에 묶인 element buffer는 VAO 상태의 일부이므로 여기서 연결
+    if (indexBuffer)
+        mesh->m_vertexLayout->SetIndexBuffer(indexBuffer->Get());
+    return std::move(mesh);
+}
+
+MeshUPtr Mesh::CreateWithBuffers(
+    BufferPtr vertexBuffer, BufferPtr indexBuffer, BufferPtr positionBuffer,
+    const AABB &aabb, const BoundingSphere &boundingSphere, uint32_t primitiveType)
+{
+    auto mesh = MeshUPtr(new Mesh());
+    mesh->m_primitiveType = primitiveType;
+    mesh->m_count = indexBuffer->GetCount();
+    mesh->m_vertexBuffer = vertexBuffer;
+    mesh->m_indexBuffer = indexBuffer;
+    mesh->m_positionBuffer = positionBuffer;
+    mesh->m_aabb = aabb;
+    mesh->m_boundingSphere = boundingSphere;
+
+    mesh->m_vertexLayout = VertexLayout::Create();
+    mesh->m_vertexLayout->SetAttrib(0, vertexBuffer->Get(), 3, GL_FLOAT, false, sizeof(Vertex), 0);
+    mesh->m_vertexLayout->SetAttrib(1, vertexBuffer->Get(), 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
+    mesh->m_vertexLayout->SetAttrib(2, vertexBuffer->Get(), 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
+    mesh->m_vertexLayout->SetIndexBuffer(indexBuffer->Get());
+    if (positionBuffer)
+    {
+        mesh->m_positionLayout = VertexLayout::Create();
+        mesh->m_positionLayout->SetAttrib(0, positionBuffer->Get(), 3, GL_FLOAT, false, sizeof(glm::vec3), 0);
+        mesh->m_positionLayout->SetIndexBuffer(indexBuffer->Get());
+    }
+    return std::move(mesh);
+}
+
+MeshUPtr Mesh::CreateBox(bool positionStream)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    GetBoxGeometry(vertices, indices);
+    return Create(vertices, indices, GL_TRIANGLES, positionStream);
+}
+
+void Mesh::GetBoxGeometry(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    vertices = {
         Vertex{glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f)},
         Vertex{glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(1.0f, 0.0f)},
         Vertex{glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(1.0f, 1.0f)},
@@ -71,7 +311,7 @@ MeshUPtr Mesh::CreateBox()
         Vertex{glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f, 0.0f)},
     };
 
-    std::vector<uint32_t> indices = {
+    indices = {
         0,
         2,
         1,
@@ -109,27 +349,41 @@ MeshUPtr Mesh::CreateBox()
         20,
         23,
     };
-
-    return Create(vertices, indices, GL_TRIANGLES);
 }
 
+// 오브젝트마다 불리므로 이름 hash는 컴파일 시간에 계산해 둠
+static constexpr UniformHandle kMaterialDiffuse("material.diffuse");
+static constexpr UniformHandle kMaterialSpecular("material.specular");
+static constexpr UniformHandle kMaterialShininess("material.shininess");
+static constexpr UniformHandle kMaterialIndex("materialIndex");
+
 void Material::SetToProgram(const Program *program) const
 {
+    // MATERIAL_TABLE program이면 texture와 shininess는 MaterialTable에 있으므로 index 하나만 설정
+    if (tableIndex >= 0)
+    {
+        auto location = program->GetUniformLocation(kMaterialIndex);
+        if (location.IsValid())
+        {
+            program->SetUniform(location, tableIndex);
+            return;
+        }
+    }
+
+    // 같은 texture가 이미 unit에 연결되어 있으면 GlState가 glActiveTexture / glBindTexture를 생략
     int textureCount = 0;
     if (diffuse)
     {
-        glActiveTexture(GL_TEXTURE0 + textureCount);
-        program->SetUniform("material.diffuse", textureCount);
-        diffuse->Bind();
+        program->SetUniform(kMaterialDiffuse, textureCount);
+        diffuse->Bind(textureCount);
         textureCount++;
     }
     if (specular)
     {
-        glActiveTexture(GL_TEXTURE0 + textureCount);
-        program->SetUniform("material.specular", textureCount);
-        specular->Bind();
+        program->SetUniform(kMaterialSpecular, textureCount);
+        specular->Bind(textureCount);
         textureCount++;
     }
-    glActiveTexture(GL_TEXTURE0); // GL_TEXTURE0으로 초기화
-    program->SetUniform("material.shininess", shininess);
+    GlState::Get().ActiveTexture(0); // GL_TEXTURE0으로 초기화
+    program->SetUniform(kMaterialShininess, shininess);
 }
@@ -6,6 +6,7 @@
 #include "vertex_layout.h"
 #include "texture.h"
 #include "program.h"
+#include "bounds.h"
 
 struct Vertex
 {
@@ -25,6 +26,7 @@ public:
 	TexturePtr diffuse;
 	TexturePtr specular;
 	float shininess{32.0f};
+	int tableIndex{-1}; // MaterialTable에 들어간 위치. -1이면 table에 없음
 
 	void SetToProgram(const Program *program) const; // program에서 사용하는 material의 diffuse, specular, shiniess를 uniform설정 및 바인딩
 
@@ -32,34 +34,116 @@ private:
 	Material() {}
 };
 
+// 정점을 자주 바꾸는 mesh(Mesh::CreateDynamic)의 갱신 방식
+enum class MeshUpdateMode
+{
+	SubData,		// glBufferSubData로 구간만 갱신. GPU가 아직 읽는 중이면 driver 안에서 기다릴 수 있음
+	Orphan,			// 매번 새 저장 공간을 받아 전체를 다시 올림
+	PersistentRing, // 영구 매핑한 3구간 ring(StreamBuffer)에 기록, fence로 동기화
+};
+
 CLASS_PTR(Mesh);
 class Mesh
 {
 public:
+	// positionStream이 true면 위치만 담은 buffer(정점당 12 byte)와 VAO를 따로 만들어 둠 (DrawPositionOnly)
 	static MeshUPtr Create(
 		const std::vector<Vertex> &vertices,
 		const std::vector<uint32_t> &indices,
-		uint32_t primitiveType); // vertices, indices를 인자로 받아서 m_vertexLayout에 맞게 상자생성
-	static MeshUPtr CreateBox(); // 정적인 vertices indices로 m_vertexLayout에 맞게 상자 생성
+		uint32_t primitiveType,
+		bool positionStream = false); // vertices, indices를 인자로 받아서 m_vertexLayout에 맞게 상자생성
+	// 초기 정점 수만큼의 공간을 잡고 UpdateVertices로 매 프레임 갱신하는 mesh (index는 고정)
+	static MeshUPtr CreateDynamic(
+		const std::vector<Vertex> &vertices,
+		const std::vector<uint32_t> &indices,
+		uint32_t primitiveType,
+		MeshUpdateMode updateMode);
+	static MeshUPtr CreateBox(bool positionStream = false); // 정적인 vertices indices로 m_vertexLayout에 맞게 상자 생성
+	static void GetBoxGeometry(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices); // CreateBox()가 쓰는 CPU 쪽 정점/인덱스 (picking 등)
+	// attribute가 이미 설정된 VAO로 mesh 생성 (glTF처럼 파일의 buffer를 그대로 올린 경우)
+	// indexBuffer가 nullptr이면 glDrawArrays로 count개의 정점을 그림. indexOffset은 byte 단위
+	static MeshUPtr CreateFromLayout(
+		VertexLayoutUPtr vertexLayout, BufferPtr indexBuffer,
+		uint32_t indexType, size_t count, size_t indexOffset,
+		const AABB &aabb, uint32_t primitiveType);
+
+	// 다른 Mesh가 이미 올린 buffer를 공유하는 mesh (GeometryRegistry). VAO, instance, material은 따로 가짐
+	// vertexBuffer는 Vertex 배열, positionBuffer는 nullptr이어도 됨
+	static MeshUPtr CreateWithBuffers(
+		BufferPtr vertexBuffer, BufferPtr indexBuffer, BufferPtr positionBuffer,
+		const AABB &aabb, const BoundingSphere &boundingSphere, uint32_t primitiveType);
 
 	const VertexLayout *GetVertexLayout() const { return m_vertexLayout.get(); }
 	BufferPtr GetVertexBuffer() const { return m_vertexBuffer; }
 	BufferPtr GetIndexBuffer() const { return m_indexBuffer; }
+	BufferPtr GetPositionBuffer() const { return m_positionBuffer; }
+	// buffer 앞부분만 그릴 때 (StaticBatch처럼 여유 capacity를 잡아 둔 buffer). index buffer가 없으면 정점 수
+	void SetDrawCount(size_t count) { m_count = count; }
+
+	const AABB &GetAABB() const { return m_aabb; }
+	const BoundingSphere &GetBoundingSphere() const { return m_boundingSphere; }
 
 	void SetMaterial(MaterialPtr material) { m_material = material; }
 	MaterialPtr GetMaterial() const { return m_material; }
 
+	// 인스턴스별 world transform을 attribute 3~6(mat4)에 연결. 설정되어 있으면 Draw()가 인스턴스 수만큼 한 번에 그린다.
+	// 두 번째 호출부터는 buffer 내용만 교체하므로 매 프레임 불러도 됨
+	void SetInstanceTransforms(const std::vector<glm::mat4> &transforms);
+	int GetInstanceCount() const { return m_instanceBuffer ? (int)m_instanceBuffer->GetCount() : 0; }
+	// 인스턴스별 (clip 번호, 시간 offset)을 attribute 9(vec2)에 연결. vertex animation texture 재생용 (vat.vs)
+	// SetInstanceTransforms와 같은 수로 설정해야 함
+	void SetInstanceAnimations(const std::vector<glm::vec2> &clipTimes);
+
 	void Draw(const Program *program) const;
 
+	// dynamic mesh의 정점 갱신. SubData는 [firstVertex, firstVertex + count) 구간만,
+	// Orphan / PersistentRing은 전체를 다시 쓰므로 firstVertex는 0이어야 함
+	// bounding volume은 생성 시의 정점 기준으로 유지된다.
+	void UpdateVertices(const Vertex *vertices, size_t count, size_t firstVertex = 0);
+	float GetLastUpdateTime() const { return m_lastUpdateTime; } // ms, 마지막 UpdateVertices의 CPU 시간
+	const StreamBuffer *GetStreamBuffer() const { return m_streamBuffer.get(); } // PersistentRing이 아니면 nullptr
+
+	// depth prepass / shadow / occlusion처럼 위치만 필요한 pass용. location 0(위치)과 인스턴스 transform만 연결된 VAO로 그림
+	bool HasPositionStream() const { return m_positionLayout != nullptr; }
+	void DrawPositionOnly() const;
+
+	// 상태 변경을 직접 관리하는 쪽(RenderQueue)에서 사용. Bind 후 DrawCall만 반복하면 같은 mesh를 여러 번 그림
+	void Bind() const { m_vertexLayout->Bind(); }
+	void BindPositionOnly() const { m_positionLayout->Bind(); }
+	void DrawCall() const; // 현재 바인딩된 VAO로 draw call만 수행
+
 private:
 	Mesh() {}
-	void Init(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t primitiveType);
+	void Init(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t primitiveType, bool positionStream);
+	void InitDynamic(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, uint32_t primitiveType, MeshUpdateMode updateMode);
+	void ComputeBounds(const std::vector<Vertex> &vertices);
 
 	uint32_t m_primitiveType{GL_TRIANGLES};
+	uint32_t m_indexType{GL_UNSIGNED_INT};
+	size_t m_count{0};		 // index 수 (index buffer가 없으면 정점 수)
+	size_t m_indexOffset{0}; // index buffer 안에서의 시작 위치 (byte)
+	int m_baseVertex{0};	 // index에 더할 정점 위치 (PersistentRing의 현재 구간)
 
 	VertexLayoutUPtr m_vertexLayout; // VAO는 해당 메쉬를 그리는데만 사용하므로 unique_ptr
 	BufferPtr m_vertexBuffer;		 // VBO EBO는 다른 VAO와 연결하여 재사용할 수 있으므로 shared_ptr
 	BufferPtr m_indexBuffer;
+	BufferPtr m_instanceBuffer; // 인스턴스별 transform (instanced rendering을 쓰지 않으면 nullptr)
+	BufferPtr m_instanceAnimationBuffer; // 인스턴스별 clip / 시간 offset (vertex animation을 쓰지 않으면 nullptr)
+
+	// dynamic mesh (CreateDynamic으로 만들지 않았으면 m_dynamic이 false)
+	bool m_dynamic{false};
+	MeshUpdateMode m_updateMode{MeshUpdateMode::SubData};
+	size_t m_vertexCount{0};
+	StreamBufferUPtr m_streamBuffer; // PersistentRing일 때 m_vertexBuffer 대신 사용
+	float m_lastUpdateTime{0.0f};
+
+	// 위치 전용 stream (만들지 않았으면 nullptr). index buffer와 instance buffer는 m_vertexLayout과 공유
+	VertexLayoutUPtr m_positionLayout;
+	BufferPtr m_positionBuffer;
+
+	// local space bounding volume (생성 시 정점으로부터 계산)
+	AABB m_aabb;
+	BoundingSphere m_boundingSphere;
 
 	MaterialPtr m_material; // unique_ptr이 아니라 shadred_ptr을 쓰는 이유는 하나의 material을 여러 mesh에서 공유할 수 있게 하기 위해
 							// 소유권을 공유.
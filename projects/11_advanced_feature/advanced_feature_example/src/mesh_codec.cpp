@@ -0,0 +1,540 @@
+#include "mesh_codec.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESH_CODEC_USE_SSE
+#endif
+
+// 양자화된 정점 하나 = 16bit 채널 8개 (position xyz, normal oct xy, texCoord uv, padding) = 16 byte
+static const int kChannelCount = 8;
+static const int kPlaneCount = kChannelCount * 2; // 채널마다 하위 / 상위 byte plane
+static const int kGroupSize = 16;
+
+// ---------------------------------------------------------------------------------------
+// vertex order
+
+void MeshCodec::OptimizeVertexOrder(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (auto &index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = (uint32_t)reordered.size();
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered); // 어떤 삼각형에서도 쓰이지 않는 정점은 버려짐
+}
+
+// ---------------------------------------------------------------------------------------
+// vertex codec
+
+static uint16_t Quantize(float value, float min, float scale)
+{
+    if (scale == 0.0f || std::isnan(value)) // NaN을 정수로 바꾸면 정의되지 않은 동작
+        return 0;
+    return (uint16_t)glm::clamp(std::round((value - min) / scale), 0.0f, 65535.0f);
+}
+
+static glm::vec2 OctahedralEncode(glm::vec3 n)
+{
+    // 퇴화한 면에서 나온 길이 0인 normal은 +Z로 저장 (NaN도 비교가 false라 여기로 옴)
+    float length = glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z);
+    if (!(length > 1e-12f))
+        return glm::vec2(0.0f, 0.0f);
+    n /= length;
+    if (n.z < 0.0f)
+    {
+        float x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        float y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        return glm::vec2(x, y);
+    }
+    return glm::vec2(n.x, n.y);
+}
+
+static glm::vec3 OctahedralDecode(float x, float y)
+{
+    glm::vec3 n(x, y, 1.0f - glm::abs(x) - glm::abs(y));
+    float t = glm::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+static int GroupBits(const uint8_t *values)
+{
+    uint8_t maxValue = 0;
+    for (int i = 0; i < kGroupSize; i++)
+        maxValue = glm::max(maxValue, values[i]);
+    return maxValue == 0 ? 0 : maxValue < 4 ? 2 : maxValue < 16 ? 4 : 8;
+}
+
+std::vector<uint8_t> MeshCodec::EncodeVertexBuffer(const std::vector<Vertex> &vertices, VertexQuantization &quantization)
+{
+    size_t count = vertices.size();
+    size_t paddedCount = (count + kGroupSize - 1) / kGroupSize * kGroupSize;
+
+    // 1. 양자화 범위 계산
+    glm::vec3 posMin(FLT_MAX), posMax(-FLT_MAX);
+    glm::vec2 uvMin(FLT_MAX), uvMax(-FLT_MAX);
+    for (auto &v : vertices)
+    {
+        posMin = glm::min(posMin, v.position);
+        posMax = glm::max(posMax, v.position);
+        uvMin = glm::vec2(glm::min(uvMin.x, v.texCoord.x), glm::min(uvMin.y, v.texCoord.y));
+        uvMax = glm::vec2(glm::max(uvMax.x, v.texCoord.x), glm::max(uvMax.y, v.texCoord.y));
+    }
+    if (count == 0)
+    {
+        posMin = posMax = glm::vec3(0.0f);
+        uvMin = uvMax = glm::vec2(0.0f);
+    }
+    quantization.positionMin = posMin;
+    quantization.positionScale = (posMax - posMin) / 65535.0f;
+    quantization.texCoordMin = uvMin;
+    quantization.texCoordScale = (uvMax - uvMin) / 65535.0f;
+
+    // 2. 양자화 -> delta -> zigzag -> byte plane
+    std::vector<uint8_t> planes(kPlaneCount * paddedCount, 0);
+    uint16_t prev[kChannelCount] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &v = vertices[i];
+        auto oct = OctahedralEncode(v.normal);
+        uint16_t q[kChannelCount] = {
+            Quantize(v.position.x, posMin.x, quantization.positionScale.x),
+            Quantize(v.position.y, posMin.y, quantization.positionScale.y),
+            Quantize(v.position.z, posMin.z, quantization.positionScale.z),
+            Quantize(oct.x, -1.0f, 2.0f / 65535.0f),
+            Quantize(oct.y, -1.0f, 2.0f / 65535.0f),
+            Quantize(v.texCoord.x, uvMin.x, quantization.texCoordScale.x),
+            Quantize(v.texCoord.y, uvMin.y, quantization.texCoordScale.y),
+            0,
+        };
+        for (int c = 0; c < kChannelCount; c++)
+        {
+            uint16_t delta = (uint16_t)(q[c] - prev[c]);
+            uint16_t zigzag = (uint16_t)((delta << 1) ^ (uint16_t)((int16_t)delta >> 15));
+            planes[(2 * c) * paddedCount + i] = (uint8_t)(zigzag & 0xff);
+            planes[(2 * c + 1) * paddedCount + i] = (uint8_t)(zigzag >> 8);
+            prev[c] = q[c];
+        }
+    }
+
+    // 3. plane마다 [그룹별 2bit 헤더][패킹된 데이터]
+    std::vector<uint8_t> result;
+    size_t groupCount = paddedCount / kGroupSize;
+    for (int p = 0; p < kPlaneCount; p++)
+    {
+        const uint8_t *plane = &planes[p * paddedCount];
+        size_t headerOffset = result.size();
+        result.resize(result.size() + (groupCount + 3) / 4, 0);
+        for (size_t g = 0; g < groupCount; g++)
+        {
+            const uint8_t *values = plane + g * kGroupSize;
+            int bits = GroupBits(values);
+            int selector = bits == 0 ? 0 : bits == 2 ? 1 : bits == 4 ? 2 : 3;
+            result[headerOffset + g / 4] |= (uint8_t)(selector << ((g % 4) * 2));
+            if (bits == 2)
+            {
+                for (int i = 0; i < kGroupSize; i += 4)
+                    result.push_back((uint8_t)(values[i] | (values[i + 1] << 2) | (values[i + 2] << 4) | (values[i + 3] << 6)));
+            }
+            else if (bits == 4)
+            {
+                for (int i = 0; i < kGroupSize; i += 2)
+                    result.push_back((uint8_t)(values[i] | (values[i + 1] << 4)));
+            }
+            else if (bits == 8)
+            {
+                result.insert(result.end(), values, values + kGroupSize);
+            }
+        }
+    }
+    return result;
+}
+
+// 16개의 값을 풀어서 out에 기록, 읽은 byte 수를 반환
+static size_t DecodeGroup(const uint8_t *data, int selector, uint8_t *out)
+{
+#if defined(MESH_CODEC_USE_SSE)
+    const __m128i mask2 = _mm_set1_epi8(0x03);
+    const __m128i mask4 = _mm_set1_epi8(0x0f);
+    switch (selector)
+    {
+    case 0:
+        _mm_storeu_si128((__m128i *)out, _mm_setzero_si128());
+        return 0;
+    case 1:
+    {
+        int packed;
+        memcpy(&packed, data, 4);
+        __m128i x = _mm_cvtsi32_si128(packed);
+        __m128i v0 = _mm_and_si128(x, mask2);
+        __m128i v1 = _mm_and_si128(_mm_srli_epi16(x, 2), mask2);
+        __m128i v2 = _mm_and_si128(_mm_srli_epi16(x, 4), mask2);
+        __m128i v3 = _mm_and_si128(_mm_srli_epi16(x, 6), mask2);
+        __m128i v01 = _mm_unpacklo_epi8(v0, v1);
+        __m128i v23 = _mm_unpacklo_epi8(v2, v3);
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(v01, v23));
+        return 4;
+    }
+    case 2:
+    {
+        __m128i x = _mm_loadl_epi64((const __m128i *)data);
+        __m128i lo = _mm_and_si128(x, mask4);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask4);
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(lo, hi));
+        return 8;
+    }
+    default:
+        _mm_storeu_si128((__m128i *)out, _mm_loadu_si128((const __m128i *)data));
+        return 16;
+    }
+#else
+    switch (selector)
+    {
+    case 0:
+        memset(out, 0, kGroupSize);
+        return 0;
+    case 1:
+        for (int i = 0; i < kGroupSize; i++)
+            out[i] = (data[i / 4] >> ((i % 4) * 2)) & 0x03;
+        return 4;
+    case 2:
+        for (int i = 0; i < kGroupSize; i++)
+            out[i] = (data[i / 2] >> ((i % 2) * 4)) & 0x0f;
+        return 8;
+    default:
+        memcpy(out, data, kGroupSize);
+        return 16;
+    }
+#endif
+}
+
+#if defined(MESH_CODEC_USE_SSE)
+// 16 plane x 16 vertex byte 행렬 전치. unpack을 byte, word, dword, qword 순으로 적용
+// 결과 행은 bit-reversal 순서로 나온다: 정점 i는 rows[kTransposeOrder[i]]
+static const int kTransposeOrder[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+static void Transpose16x16(__m128i rows[16])
+{
+    __m128i tmp[16];
+    for (int i = 0; i < 8; i++)
+    {
+        tmp[i] = _mm_unpacklo_epi8(rows[2 * i], rows[2 * i + 1]);
+        tmp[i + 8] = _mm_unpackhi_epi8(rows[2 * i], rows[2 * i + 1]);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        rows[i] = _mm_unpacklo_epi16(tmp[2 * i], tmp[2 * i + 1]);
+        rows[i + 8] = _mm_unpackhi_epi16(tmp[2 * i], tmp[2 * i + 1]);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        tmp[i] = _mm_unpacklo_epi32(rows[2 * i], rows[2 * i + 1]);
+        tmp[i + 8] = _mm_unpackhi_epi32(rows[2 * i], rows[2 * i + 1]);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        rows[i] = _mm_unpacklo_epi64(tmp[2 * i], tmp[2 * i + 1]);
+        rows[i + 8] = _mm_unpackhi_epi64(tmp[2 * i], tmp[2 * i + 1]);
+    }
+}
+#endif
+
+bool MeshCodec::DecodeVertexBuffer(const uint8_t *data, size_t size, size_t vertexCount,
+                                   const VertexQuantization &quantization, std::vector<Vertex> &vertices)
+{
+    size_t paddedCount = (vertexCount + kGroupSize - 1) / kGroupSize * kGroupSize;
+    size_t groupCount = paddedCount / kGroupSize;
+    // plane마다 group 4개당 1byte의 header가 있으므로 그보다 작으면 header의 정점 수가 잘못된 것 (큰 할당 전에 확인)
+    if ((groupCount + 3) / 4 * kPlaneCount > size)
+    {
+        SPDLOG_ERROR("vertex count {} does not fit in {} bytes", vertexCount, size);
+        return false;
+    }
+
+    // 1. byte plane 복원
+    std::vector<uint8_t> planes(kPlaneCount * paddedCount);
+    const uint8_t *cursor = data;
+    const uint8_t *end = data + size;
+    for (int p = 0; p < kPlaneCount; p++)
+    {
+        const uint8_t *header = cursor;
+        cursor += (groupCount + 3) / 4;
+        if (cursor > end)
+            return false;
+        for (size_t g = 0; g < groupCount; g++)
+        {
+            int selector = (header[g / 4] >> ((g % 4) * 2)) & 0x03;
+            const size_t groupBytes[] = {0, 4, 8, 16};
+            if (cursor + groupBytes[selector] > end)
+                return false;
+            cursor += DecodeGroup(cursor, selector, &planes[p * paddedCount + g * kGroupSize]);
+        }
+    }
+
+    // 2. 정점 16개씩 plane -> 정점 순서로 전치한 뒤 zigzag 복원 + 누적합 (8채널을 한 번에)
+    std::vector<uint16_t> quantized(paddedCount * kChannelCount);
+#if defined(MESH_CODEC_USE_SSE)
+    __m128i acc = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    for (size_t g = 0; g < groupCount; g++)
+    {
+        __m128i rows[16];
+        for (int p = 0; p < kPlaneCount; p++)
+            rows[p] = _mm_loadu_si128((const __m128i *)&planes[p * paddedCount + g * kGroupSize]);
+        Transpose16x16(rows);
+        for (int i = 0; i < kGroupSize; i++)
+        {
+            __m128i z = rows[kTransposeOrder[i]];
+            __m128i delta = _mm_xor_si128(_mm_srli_epi16(z, 1), _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(z, one)));
+            acc = _mm_add_epi16(acc, delta);
+            _mm_storeu_si128((__m128i *)&quantized[(g * kGroupSize + i) * kChannelCount], acc);
+        }
+    }
+#else
+    uint16_t acc[kChannelCount] = {};
+    for (size_t i = 0; i < paddedCount; i++)
+    {
+        for (int c = 0; c < kChannelCount; c++)
+        {
+            uint16_t z = (uint16_t)(planes[(2 * c) * paddedCount + i] | (planes[(2 * c + 1) * paddedCount + i] << 8));
+            uint16_t delta = (uint16_t)((z >> 1) ^ (uint16_t)(0 - (z & 1)));
+            acc[c] = (uint16_t)(acc[c] + delta);
+            quantized[i * kChannelCount + c] = acc[c];
+        }
+    }
+#endif
+
+    // 3. 역양자화
+    vertices.resize(vertexCount);
+    const float normalScale = 2.0f / 65535.0f;
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const uint16_t *q = &quantized[i * kChannelCount];
+        auto &v = vertices[i];
+        v.position = quantization.positionMin + glm::vec3(q[0], q[1], q[2]) * quantization.positionScale;
+        v.normal = OctahedralDecode(q[3] * normalScale - 1.0f, q[4] * normalScale - 1.0f);
+        v.texCoord = quantization.texCoordMin + glm::vec2(q[5], q[6]) * quantization.texCoordScale;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// index codec
+
+// 코드 byte의 상위 4bit: edge FIFO 인덱스(0~14), 15면 edge를 못 찾은 삼각형
+// 정점 코드(4bit): 0 = 다음 새 정점(next), 1~14 = vertex FIFO 인덱스, 15 = 직접 기록(varint)
+static const int kEdgeFifoSize = 15;
+static const int kVertexFifoSize = 14;
+static const int kExplicitCode = 15;
+
+struct IndexCodecState
+{
+    uint32_t edges[16][2];
+    uint32_t vertices[16];
+    uint32_t edgeOffset{0};
+    uint32_t vertexOffset{0};
+    uint32_t next{0};
+    uint32_t last{0};
+
+    IndexCodecState()
+    {
+        memset(edges, 0xff, sizeof(edges));
+        memset(vertices, 0xff, sizeof(vertices));
+    }
+    void PushEdge(uint32_t a, uint32_t b)
+    {
+        edges[edgeOffset & 15][0] = a;
+        edges[edgeOffset & 15][1] = b;
+        edgeOffset++;
+    }
+    void PushVertex(uint32_t v)
+    {
+        vertices[vertexOffset & 15] = v;
+        vertexOffset++;
+    }
+    const uint32_t *Edge(int index) const { return edges[(edgeOffset - 1 - index) & 15]; } // 0이 가장 최근
+    uint32_t Vertex(int index) const { return vertices[(vertexOffset - 1 - index) & 15]; }
+    void PushTriangleEdges(uint32_t a, uint32_t b, uint32_t c)
+    {
+        // 이웃 삼각형은 공유하는 edge를 반대 방향으로 가지므로 뒤집어서 저장
+        PushEdge(b, a);
+        PushEdge(c, b);
+        PushEdge(a, c);
+    }
+};
+
+static void WriteVarint(std::vector<uint8_t> &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool ReadVarint(const uint8_t *&cursor, const uint8_t *end, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (cursor >= end)
+            return false;
+        uint8_t byte = *cursor++;
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static int EncodeVertex(IndexCodecState &state, uint32_t v, std::vector<uint8_t> &extra)
+{
+    if (v == state.next)
+    {
+        state.next++;
+        state.PushVertex(v);
+        return 0;
+    }
+    for (int i = 0; i < kVertexFifoSize; i++)
+    {
+        if (state.Vertex(i) == v)
+            return i + 1;
+    }
+    int32_t delta = (int32_t)(v - state.last);
+    WriteVarint(extra, (uint32_t)((delta << 1) ^ (delta >> 31)));
+    state.last = v;
+    state.PushVertex(v);
+    return kExplicitCode;
+}
+
+static bool DecodeVertex(IndexCodecState &state, int code, const uint8_t *&cursor, const uint8_t *end, uint32_t &v)
+{
+    if (code == 0)
+    {
+        v = state.next++;
+        state.PushVertex(v);
+    }
+    else if (code < kExplicitCode)
+    {
+        v = state.Vertex(code - 1);
+    }
+    else
+    {
+        uint32_t zigzag;
+        if (!ReadVarint(cursor, end, zigzag))
+            return false;
+        v = state.last + (uint32_t)((zigzag >> 1) ^ (0u - (zigzag & 1)));
+        state.last = v;
+        state.PushVertex(v);
+    }
+    return true;
+}
+
+std::vector<uint8_t> MeshCodec::EncodeIndexBuffer(const std::vector<uint32_t> &indices)
+{
+    std::vector<uint8_t> result;
+    std::vector<uint8_t> extra; // 코드 byte 뒤에 붙는 varint
+    IndexCodecState state;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t tri[3] = {indices[i], indices[i + 1], indices[i + 2]};
+
+        // 세 방향으로 회전시켜 보면서 첫 edge (a, b)가 FIFO에 있는지 찾음
+        int edgeIndex = -1;
+        for (int r = 0; r < 3 && edgeIndex < 0; r++)
+        {
+            for (int e = 0; e < kEdgeFifoSize; e++)
+            {
+                auto edge = state.Edge(e);
+                if (edge[0] == tri[r] && edge[1] == tri[(r + 1) % 3])
+                {
+                    uint32_t rotated[3] = {tri[r], tri[(r + 1) % 3], tri[(r + 2) % 3]};
+                    memcpy(tri, rotated, sizeof(tri));
+                    edgeIndex = e;
+                    break;
+                }
+            }
+        }
+
+        extra.clear();
+        if (edgeIndex >= 0)
+        {
+            int code = EncodeVertex(state, tri[2], extra);
+            result.push_back((uint8_t)((edgeIndex << 4) | code));
+        }
+        else
+        {
+            int codeA = EncodeVertex(state, tri[0], extra);
+            result.push_back((uint8_t)(0xf0 | codeA));
+            result.insert(result.end(), extra.begin(), extra.end());
+            extra.clear();
+            int codeB = EncodeVertex(state, tri[1], extra);
+            int codeC = EncodeVertex(state, tri[2], extra);
+            result.push_back((uint8_t)((codeB << 4) | codeC));
+        }
+        result.insert(result.end(), extra.begin(), extra.end());
+        state.PushTriangleEdges(tri[0], tri[1], tri[2]);
+    }
+    return result;
+}
+
+bool MeshCodec::DecodeIndexBuffer(const uint8_t *data, size_t size, size_t indexCount, size_t vertexCount,
+                                  std::vector<uint32_t> &indices)
+{
+    // 삼각형마다 코드 byte가 최소 1개 있음 (큰 할당 전에 확인)
+    if (indexCount % 3 != 0 || indexCount / 3 > size)
+    {
+        SPDLOG_ERROR("invalid index count {} for {} bytes", indexCount, size);
+        return false;
+    }
+    indices.resize(indexCount);
+    IndexCodecState state;
+    const uint8_t *cursor = data;
+    const uint8_t *end = data + size;
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        if (cursor >= end)
+            return false;
+        uint8_t code = *cursor++;
+        uint32_t a, b, c;
+        if ((code >> 4) != 0xf)
+        {
+            auto edge = state.Edge(code >> 4);
+            a = edge[0];
+            b = edge[1];
+            if (!DecodeVertex(state, code & 0xf, cursor, end, c))
+                return false;
+        }
+        else
+        {
+            if (!DecodeVertex(state, code & 0xf, cursor, end, a) || cursor >= end)
+                return false;
+            uint8_t codeBC = *cursor++;
+            if (!DecodeVertex(state, codeBC >> 4, cursor, end, b) ||
+                !DecodeVertex(state, codeBC & 0xf, cursor, end, c))
+                return false;
+        }
+        // 비어 있는 FIFO 칸(0xFFFFFFFF)이나 varint로 직접 기록한 값이 범위를 벗어날 수 있음
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount)
+        {
+            SPDLOG_ERROR("decoded index out of range (vertex count {})", vertexCount);
+            return false;
+        }
+        indices[i] = a;
+        indices[i + 1] = b;
+        indices[i + 2] = c;
+        state.PushTriangleEdges(a, b, c);
+    }
+    return true;
+}
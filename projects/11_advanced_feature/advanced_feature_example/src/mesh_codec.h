@@ -0,0 +1,38 @@
+#ifndef __MESH_CODEC_H__
+#define __MESH_CODEC_H__
+
+#include "common.h"
+#include "mesh.h"
+
+// 정점을 양자화할 때 쓴 범위. 복원할 때 같은 값이 필요하다.
+struct VertexQuantization
+{
+    glm::vec3 positionMin{glm::vec3(0.0f)};
+    glm::vec3 positionScale{glm::vec3(0.0f)}; // (max - min) / 65535
+    glm::vec2 texCoordMin{glm::vec2(0.0f)};
+    glm::vec2 texCoordScale{glm::vec2(0.0f)};
+};
+
+// mesh 압축 코덱
+// - vertex: 16bit 양자화(normal은 octahedral) -> 정점 간 delta + zigzag -> byte plane 분리 -> 16 byte 그룹마다 0/2/4/8 bit 패킹
+// - index: 최근 edge / vertex FIFO를 참조하는 삼각형 단위 코드 (삼각형당 1~2 byte)
+class MeshCodec
+{
+public:
+    // 두 코덱 모두 정점이 처음 쓰이는 순서대로 놓여 있을 때 잘 압축되므로 인코딩 전에 호출
+    static void OptimizeVertexOrder(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+    static std::vector<uint8_t> EncodeVertexBuffer(const std::vector<Vertex> &vertices, VertexQuantization &quantization);
+    static bool DecodeVertexBuffer(const uint8_t *data, size_t size, size_t vertexCount,
+                                   const VertexQuantization &quantization, std::vector<Vertex> &vertices);
+
+    static std::vector<uint8_t> EncodeIndexBuffer(const std::vector<uint32_t> &indices);
+    // 모든 index가 vertexCount 미만이어야 하고, 아니면 실패
+    static bool DecodeIndexBuffer(const uint8_t *data, size_t size, size_t indexCount, size_t vertexCount,
+                                  std::vector<uint32_t> &indices);
+
+private:
+    MeshCodec() {}
+};
+
+#endif // __MESH_CODEC_H__
@@ -1,12 +1,240 @@
 #include "model.h"
+#include "mesh_codec.h"
+#include "obj_loader.h"
+#include "gltf_loader.h"
+#include "vertex_animation.h"
+#include "geometry_registry.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+// assimp의 행렬은 row-major, glm은 column-major이므로 전치가 필요.
+static glm::mat4 ToGlmMat4(const aiMatrix4x4 &m)
+{
+    return glm::transpose(glm::make_mat4(&m.a1));
+}
+
+// .mshc 파일 헤더
+static const char kCodecMagic[4] = {'M', 'S', 'H', 'C'};
+static const uint32_t kCodecVersion = 1;
+
+// aiMesh에서 정점 / 인덱스를 꺼냄
+static void ReadMeshData(const aiMesh *mesh, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    // normal / uv가 없는 mesh는 0으로 채움
+    bool hasNormals = mesh->HasNormals();
+    bool hasTexCoords = mesh->HasTextureCoords(0);
+    vertices.resize(mesh->mNumVertices);
+    for (uint32_t i = 0; i < mesh->mNumVertices; i++)
+    {
+        auto &v = vertices[i];
+        v.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+        v.normal = hasNormals ? glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z) : glm::vec3(0.0f);
+        v.texCoord = hasTexCoords ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+    }
+
+    indices.clear();
+    indices.reserve(mesh->mNumFaces * 3);
+    for (uint32_t i = 0; i < mesh->mNumFaces; i++)
+    {
+        auto &face = mesh->mFaces[i];
+        if (face.mNumIndices != 3) // triangulate 후에도 남는 점, 선은 버림
+            continue;
+        indices.push_back(face.mIndices[0]);
+        indices.push_back(face.mIndices[1]);
+        indices.push_back(face.mIndices[2]);
+    }
+}
+
+// node 계층을 따라 내려가며 부모 transform을 누적해서 (mesh, world transform) 목록으로 펼침
+static void ProcessNode(const aiNode *node, const glm::mat4 &parentTransform, std::vector<ModelNode> &nodes)
+{
+    auto transform = parentTransform * ToGlmMat4(node->mTransformation);
+
+    for (uint32_t i = 0; i < node->mNumMeshes; i++)
+    {
+        nodes.push_back({(int)node->mMeshes[i], transform});
+    }
+
+    for (uint32_t i = 0; i < node->mNumChildren; i++)
+    {
+        ProcessNode(node->mChildren[i], transform, nodes);
+    }
+}
+
+// node 계층을 부모가 자식보다 먼저 오는 순서로 펼침 (Skeleton이 요구하는 순서)
+static void ReadSkeletonNodes(const aiNode *node, int parent, std::vector<SkeletonNode> &nodes)
+{
+    int index = (int)nodes.size();
+    nodes.push_back({node->mName.C_Str(), parent, ToGlmMat4(node->mTransformation)});
+    for (uint32_t i = 0; i < node->mNumChildren; i++)
+        ReadSkeletonNodes(node->mChildren[i], index, nodes);
+}
+
+// bone이 있는 aiMesh, skeleton, animation (GL 객체를 만들기 전 단계, 오프라인 baking에서도 사용)
+struct SkinData
+{
+    struct MeshData
+    {
+        int materialIndex;
+        std::vector<SkinnedVertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+    std::vector<MeshData> meshes;
+    SkeletonUPtr skeleton;
+    std::vector<AnimationUPtr> animations;
+};
+
+static SkinData ReadSkinData(const aiScene *scene)
+{
+    SkinData skin;
+    std::vector<SkeletonNode> nodes;
+    ReadSkeletonNodes(scene->mRootNode, -1, nodes);
+    std::unordered_map<std::string, int> nodeIndices;
+    for (int i = 0; i < (int)nodes.size(); i++)
+        nodeIndices.emplace(nodes[i].name, i);
+
+    // 여러 mesh가 같은 bone을 공유하므로 이름으로 한 번씩만 등록
+    std::vector<SkeletonBone> bones;
+    std::unordered_map<std::string, int> boneIndices;
+    std::vector<Vertex> vertices;
+    for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+    {
+        auto mesh = scene->mMeshes[i];
+        if (!mesh->HasBones())
+            continue;
+
+        SkinData::MeshData meshData;
+        meshData.materialIndex = (int)mesh->mMaterialIndex;
+        ReadMeshData(mesh, vertices, meshData.indices);
+        auto &skinnedVertices = meshData.vertices;
+        skinnedVertices.resize(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            skinnedVertices[v].position = vertices[v].position;
+            skinnedVertices[v].normal = vertices[v].normal;
+            skinnedVertices[v].texCoord = vertices[v].texCoord;
+        }
+
+        for (uint32_t b = 0; b < mesh->mNumBones; b++)
+        {
+            auto bone = mesh->mBones[b];
+            auto name = std::string(bone->mName.C_Str());
+            auto found = boneIndices.find(name);
+            int boneIndex;
+            if (found != boneIndices.end())
+            {
+                boneIndex = found->second;
+            }
+            else
+            {
+                auto node = nodeIndices.find(name);
+                if (node == nodeIndices.end())
+                {
+                    SPDLOG_ERROR("bone without node: {}", name);
+                    continue;
+                }
+                boneIndex = (int)bones.size();
+                bones.push_back({node->second, ToGlmMat4(bone->mOffsetMatrix)});
+                boneIndices.emplace(name, boneIndex);
+            }
+            for (uint32_t w = 0; w < bone->mNumWeights; w++)
+                skinnedVertices[bone->mWeights[w].mVertexId].AddBoneWeight(boneIndex, bone->mWeights[w].mWeight);
+        }
+
+        // 4개를 넘는 영향은 버렸으므로 합이 1이 되도록 다시 맞춤
+        for (auto &vertex : skinnedVertices)
+        {
+            float sum = vertex.boneWeights.x + vertex.boneWeights.y + vertex.boneWeights.z + vertex.boneWeights.w;
+            if (sum > 0.0f)
+                vertex.boneWeights /= sum;
+        }
+        skin.meshes.push_back(std::move(meshData));
+    }
+    skin.skeleton = Skeleton::Create(std::move(nodes), std::move(bones));
+
+    for (uint32_t i = 0; i < scene->mNumAnimations; i++)
+    {
+        auto animation = scene->mAnimations[i];
+        std::vector<AnimationChannel> channels;
+        for (uint32_t c = 0; c < animation->mNumChannels; c++)
+        {
+            auto nodeAnim = animation->mChannels[c];
+            auto node = nodeIndices.find(nodeAnim->mNodeName.C_Str());
+            if (node == nodeIndices.end())
+                continue;
+
+            AnimationChannel channel;
+            channel.node = node->second;
+            for (uint32_t k = 0; k < nodeAnim->mNumPositionKeys; k++)
+            {
+                auto &key = nodeAnim->mPositionKeys[k];
+                channel.positions.push_back({(float)key.mTime, glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z)});
+            }
+            for (uint32_t k = 0; k < nodeAnim->mNumRotationKeys; k++)
+            {
+                auto &key = nodeAnim->mRotationKeys[k];
+                channel.rotations.push_back({(float)key.mTime, glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z)});
+            }
+            for (uint32_t k = 0; k < nodeAnim->mNumScalingKeys; k++)
+            {
+                auto &key = nodeAnim->mScalingKeys[k];
+                channel.scales.push_back({(float)key.mTime, glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z)});
+            }
+            channels.push_back(std::move(channel));
+        }
+        skin.animations.push_back(Animation::Create(animation->mName.C_Str(), (float)animation->mDuration,
+                                                    (float)animation->mTicksPerSecond, std::move(channels)));
+    }
+    return skin;
+}
+
+static std::string GetTexturePath(const aiMaterial *material, aiTextureType type)
+{
+    if (material->GetTextureCount(type) <= 0)
+        return std::string();
+
+    aiString filepath;
+    material->GetTexture(type, 0, &filepath); // type에 맞는 texture의 파일명을 filepath에 저장.
+    return filepath.C_Str();
+}
+
+static TexturePtr LoadTexture(const std::string &dirname, const std::string &filepath)
+{
+    if (filepath.empty())
+        return nullptr;
+
+    auto image = Image::Load(fmt::format("{}/{}", dirname, filepath));
+    if (!image)
+        return nullptr;
+
+    return Texture::CreateFromImage(image.get());
+}
+
+static bool HasExtension(const std::string &filename, const std::string &extension)
+{
+    return filename.size() >= extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
 
 ModelUPtr Model::Load(const std::string &filename)
 {
     auto model = ModelUPtr(new Model());
-    if (!model->LoadByAssimp(filename))
+    bool loaded = HasExtension(filename, ".mshc")  ? model->LoadByCodec(filename)
+                  : HasExtension(filename, ".obj") ? model->LoadByObj(filename)
+                  : HasExtension(filename, ".gltf") || HasExtension(filename, ".glb")
+                      ? model->LoadByGltf(filename)
+                      : model->LoadByAssimp(filename);
+    if (!loaded)
         return nullptr;
 
-    // LoadByAssimp가 끝나면 model을 이루는 m_mashes, m_materials가 다 세팅되어있음.
+    auto &registry = GeometryRegistry::Get();
+    SPDLOG_INFO("geometry registry: #geometry: {}, #shared: {}, saved {} bytes",
+                registry.GetGeometryCount(), registry.GetHitCount(), registry.GetSavedBytes());
+
+    // 로드가 끝나면 model을 이루는 m_mashes, m_materials, m_nodes가 다 세팅되어있음.
     return std::move(model);
 }
 
@@ -22,92 +250,454 @@ bool Model::LoadByAssimp(const std::string &filename)
     }
 
     auto dirname = filename.substr(0, filename.find_last_of("/")); // 0 ~ 마지막 "/" 앞까지 substring
-    // Lambda expression (https://docs.microsoft.com/ko-kr/cpp/cpp/lambda-expressions-in-cpp?view=msvc-160)
-    // capture절의 [&]를 쓰면 해당 클로저 상위 스코프의 모든 값에 접근 가능(dirname).
-    auto LoadTexture = [&](aiMaterial *material, aiTextureType type) -> TexturePtr
-    {
-        if (material->GetTextureCount(type) <= 0)
-            return nullptr;
-
-        aiString filepath;
-        material->GetTexture(type, 0, &filepath); // type에 맞는 texture의 파일명을 filepath에 저장.
-
-        auto image = Image::Load(fmt::format("{}/{}", dirname, filepath.C_Str()));
-        if (!image)
-            return nullptr;
-
-        return Texture::CreateFromImage(image.get());
-    };
-
     for (uint32_t i = 0; i < scene->mNumMaterials; i++)
     {
         auto material = scene->mMaterials[i];
         auto glMaterial = Material::Create();
 
         // material에서 사용되는 difuse 텍스쳐와 specular 텍스쳐를 로드해서 glMaterial의 멤버로 저장.
-        glMaterial->diffuse = LoadTexture(material, aiTextureType_DIFFUSE);
-        glMaterial->specular = LoadTexture(material, aiTextureType_SPECULAR);
+        glMaterial->diffuse = LoadTexture(dirname, GetTexturePath(material, aiTextureType_DIFFUSE));
+        glMaterial->specular = LoadTexture(dirname, GetTexturePath(material, aiTextureType_SPECULAR));
 
         m_materials.push_back(std::move(glMaterial));
     }
 
-    ProcessNode(scene->mRootNode, scene);
+    // 여러 node가 같은 mesh를 참조할 수 있으므로 mesh는 node와 별개로 한 번씩만 만든다.
+    std::vector<MeshGeometry> geometries;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+    {
+        auto mesh = scene->mMeshes[i];
+        ReadMeshData(mesh, vertices, indices);
+        auto welded = WeldVertices(vertices, indices);
+        SPDLOG_INFO("process mesh: {}, #vert: {} (welded {}), #face: {}",
+                    mesh->mName.C_Str(), vertices.size(), welded, mesh->mNumFaces);
+        AddMesh(vertices, indices, mesh->mMaterialIndex, geometries); // m_meshes에 mesh보관
+    }
+
+    ProcessNode(scene->mRootNode, glm::mat4(1.0f), m_nodes);
+    SetupInstances();
+    BuildBvh(geometries);
+
+    if (std::any_of(scene->mMeshes, scene->mMeshes + scene->mNumMeshes, [](const aiMesh *mesh)
+                    { return mesh->HasBones(); }))
+        LoadSkeleton(scene);
+
+    SPDLOG_INFO("model loaded: {}, #mesh: {}, #node: {}", filename, m_meshes.size(), m_nodes.size());
     return true;
 }
 
-void Model::ProcessNode(aiNode *node, const aiScene *scene)
+void Model::LoadSkeleton(const aiScene *scene)
 {
-    for (uint32_t i = 0; i < node->mNumMeshes; i++)
+    auto skin = ReadSkinData(scene);
+    for (auto &mesh : skin.meshes)
     {
-        auto meshIndex = node->mMeshes[i];
-        auto mesh = scene->mMeshes[meshIndex];
-        ProcessMesh(mesh, scene); // m_meshes에 mesh보관
+        auto skinnedMesh = SkinnedMesh::Create(mesh.vertices, mesh.indices);
+        if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)m_materials.size())
+            skinnedMesh->SetMaterial(m_materials[mesh.materialIndex]);
+        m_skinnedMeshes.push_back(std::move(skinnedMesh));
     }
+    m_skeleton = std::move(skin.skeleton);
+    m_animations = std::move(skin.animations);
 
-    for (uint32_t i = 0; i < node->mNumChildren; i++)
+    SPDLOG_INFO("skeleton loaded: #node: {}, #bone: {}, #skinned mesh: {}, #animation: {}",
+                m_skeleton->GetNodes().size(), m_skeleton->GetBoneCount(), m_skinnedMeshes.size(), m_animations.size());
+}
+
+bool Model::BakeVertexAnimation(const std::string &filename, const std::string &outFilename, float frameRate)
+{
+    Assimp::Importer importer;
+    auto scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        SPDLOG_ERROR("failed to load model: {}", filename);
+        return false;
+    }
+
+    auto skin = ReadSkinData(scene);
+    if (skin.meshes.empty() || skin.animations.empty())
+    {
+        SPDLOG_ERROR("model has no skinned mesh or animation: {}", filename);
+        return false;
+    }
+
+    // skinned mesh들을 하나로 합쳐서 texture 한 벌로 굽는다. material은 첫 mesh의 것을 사용
+    std::vector<SkinnedVertex> vertices;
+    std::vector<uint32_t> indices;
+    for (auto &mesh : skin.meshes)
+    {
+        auto base = (uint32_t)vertices.size();
+        vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        for (auto index : mesh.indices)
+            indices.push_back(base + index);
+    }
+    std::vector<const Animation *> animations;
+    for (auto &animation : skin.animations)
+        animations.push_back(animation.get());
+
+    auto baked = VertexAnimation::Bake(vertices, indices, *skin.skeleton, animations, frameRate);
+    if (!baked)
+        return false;
+    auto &data = *baked;
+    int materialIndex = skin.meshes[0].materialIndex;
+    if (materialIndex >= 0 && materialIndex < (int)scene->mNumMaterials)
     {
-        ProcessNode(node->mChildren[i], scene);
+        data.diffuseMap = GetTexturePath(scene->mMaterials[materialIndex], aiTextureType_DIFFUSE);
+        data.specularMap = GetTexturePath(scene->mMaterials[materialIndex], aiTextureType_SPECULAR);
     }
+    if (!VertexAnimation::Save(data, outFilename))
+        return false;
+
+    SPDLOG_INFO("vertex animation saved: {} -> {}", filename, outFilename);
+    return true;
 }
 
-void Model::ProcessMesh(aiMesh *mesh, const aiScene *scene)
+bool Model::LoadByObj(const std::string &filename)
 {
-    SPDLOG_INFO("process mesh: {}, #vert: {}, #face: {}",
-                mesh->mName.C_Str(), mesh->mNumVertices, mesh->mNumFaces);
+    auto obj = ObjLoader::Load(filename);
+    if (!obj)
+    {
+        SPDLOG_ERROR("failed to load model: {}", filename);
+        return false;
+    }
+
+    auto dirname = filename.substr(0, filename.find_last_of("/"));
+    for (auto &material : obj->materials)
+    {
+        auto glMaterial = Material::Create();
+        glMaterial->diffuse = LoadTexture(dirname, material.diffuseMap);
+        glMaterial->specular = LoadTexture(dirname, material.specularMap);
+        m_materials.push_back(std::move(glMaterial));
+    }
 
+    // OBJ는 node 계층이 없으므로 mesh마다 identity transform의 node 하나
+    std::vector<MeshGeometry> geometries;
+    for (auto &mesh : obj->meshes)
+    {
+        m_nodes.push_back({(int)m_meshes.size(), glm::mat4(1.0f)});
+        AddMesh(mesh.vertices, mesh.indices, mesh.materialIndex, geometries);
+    }
+    SetupInstances();
+    BuildBvh(geometries);
+
+    SPDLOG_INFO("model loaded: {}, #mesh: {}, #node: {}", filename, m_meshes.size(), m_nodes.size());
+    return true;
+}
+
+bool Model::LoadByGltf(const std::string &filename)
+{
+    auto gltf = GltfLoader::Load(filename);
+    if (!gltf)
+    {
+        SPDLOG_ERROR("failed to load model: {}", filename);
+        return false;
+    }
+
+    // GL buffer와 VertexLayout은 로더가 파일의 bufferView로 이미 만들어 두었음
+    m_materials = std::move(gltf->materials);
+    m_meshes = std::move(gltf->meshes);
+    m_nodes = std::move(gltf->nodes);
+    SetupInstances();
+    BuildBvh(gltf->geometries);
+
+    SPDLOG_INFO("model loaded: {}, #mesh: {}, #node: {}", filename, m_meshes.size(), m_nodes.size());
+    return true;
+}
+
+// .mshc 레이아웃 (little endian)
+//   "MSHC", version, #material, #mesh, #node
+//   material: diffuse 경로, specular 경로 (uint32 길이 + 문자열, .mshc 파일 기준 상대 경로)
+//   mesh: materialIndex, #vertex, #index, VertexQuantization, vertex 데이터 (uint32 크기 + byte), index 데이터 (uint32 크기 + byte)
+//   node: meshIndex, transform (float 16개, column-major)
+bool Model::LoadByCodec(const std::string &filename)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open())
+    {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    // 파일 전체를 한 번에 읽은 뒤 앞에서부터 잘라 씀. 범위를 넘으면 ok = false
+    size_t offset = 0;
+    bool ok = true;
+    auto ReadBytes = [&](size_t size) -> const uint8_t *
+    {
+        if (!ok || size > data.size() - offset)
+        {
+            ok = false;
+            return nullptr;
+        }
+        auto ptr = data.data() + offset;
+        offset += size;
+        return ptr;
+    };
+    auto Read = [&](auto &value)
+    {
+        auto ptr = ReadBytes(sizeof(value));
+        if (ptr)
+            memcpy(&value, ptr, sizeof(value));
+    };
+    auto ReadString = [&]() -> std::string
+    {
+        uint32_t length = 0;
+        Read(length);
+        auto ptr = ReadBytes(length);
+        return ptr ? std::string((const char *)ptr, length) : std::string();
+    };
+
+    char magic[4] = {};
+    uint32_t version = 0, materialCount = 0, meshCount = 0, nodeCount = 0;
+    Read(magic);
+    Read(version);
+    if (!ok || memcmp(magic, kCodecMagic, 4) != 0 || version != kCodecVersion)
+    {
+        SPDLOG_ERROR("invalid compressed model: {}", filename);
+        return false;
+    }
+    Read(materialCount);
+    Read(meshCount);
+    Read(nodeCount);
+
+    auto dirname = filename.substr(0, filename.find_last_of("/"));
+    for (uint32_t i = 0; ok && i < materialCount; i++)
+    {
+        auto glMaterial = Material::Create();
+        auto diffusePath = ReadString();
+        auto specularPath = ReadString();
+        glMaterial->diffuse = LoadTexture(dirname, diffusePath);
+        glMaterial->specular = LoadTexture(dirname, specularPath);
+        m_materials.push_back(std::move(glMaterial));
+    }
+
+    std::vector<MeshGeometry> geometries;
     std::vector<Vertex> vertices;
-    vertices.resize(mesh->mNumVertices);
-    for (uint32_t i = 0; i < mesh->mNumVertices; i++)
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; ok && i < meshCount; i++)
     {
-        auto &v = vertices[i];
-        v.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-        v.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
-        v.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+        int32_t materialIndex = -1;
+        uint32_t vertexCount = 0, indexCount = 0, vertexBytes = 0, indexBytes = 0;
+        VertexQuantization quantization;
+        Read(materialIndex);
+        Read(vertexCount);
+        Read(indexCount);
+        Read(quantization.positionMin);
+        Read(quantization.positionScale);
+        Read(quantization.texCoordMin);
+        Read(quantization.texCoordScale);
+        Read(vertexBytes);
+        auto vertexData = ReadBytes(vertexBytes);
+        Read(indexBytes);
+        auto indexData = ReadBytes(indexBytes);
+        if (!ok ||
+            !MeshCodec::DecodeVertexBuffer(vertexData, vertexBytes, vertexCount, quantization, vertices) ||
+            !MeshCodec::DecodeIndexBuffer(indexData, indexBytes, indexCount, vertexCount, indices))
+        {
+            ok = false;
+            break;
+        }
+        AddMesh(vertices, indices, materialIndex, geometries);
     }
 
+    for (uint32_t i = 0; ok && i < nodeCount; i++)
+    {
+        ModelNode node;
+        Read(node.meshIndex);
+        Read(node.transform);
+        if (ok && (node.meshIndex < 0 || node.meshIndex >= (int)m_meshes.size()))
+            ok = false;
+        m_nodes.push_back(node);
+    }
+
+    if (!ok)
+    {
+        SPDLOG_ERROR("corrupted compressed model: {}", filename);
+        return false;
+    }
+
+    SetupInstances();
+    BuildBvh(geometries);
+
+    SPDLOG_INFO("model loaded: {}, #mesh: {}, #node: {}, {} bytes", filename, m_meshes.size(), m_nodes.size(), data.size());
+    return true;
+}
+
+bool Model::Compress(const std::string &filename, const std::string &outFilename)
+{
+    Assimp::Importer importer;
+    auto scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        SPDLOG_ERROR("failed to load model: {}", filename);
+        return false;
+    }
+
+    std::vector<uint8_t> out;
+    auto WriteBytes = [&](const void *ptr, size_t size)
+    {
+        out.insert(out.end(), (const uint8_t *)ptr, (const uint8_t *)ptr + size);
+    };
+    auto Write = [&](const auto &value)
+    {
+        WriteBytes(&value, sizeof(value));
+    };
+    auto WriteString = [&](const std::string &str)
+    {
+        Write((uint32_t)str.size());
+        WriteBytes(str.data(), str.size());
+    };
+
+    std::vector<ModelNode> nodes;
+    ProcessNode(scene->mRootNode, glm::mat4(1.0f), nodes);
+
+    WriteBytes(kCodecMagic, 4);
+    Write(kCodecVersion);
+    Write((uint32_t)scene->mNumMaterials);
+    Write((uint32_t)scene->mNumMeshes);
+    Write((uint32_t)nodes.size());
+
+    // 텍스쳐는 경로만 저장. .mshc를 원본 model과 같은 디렉토리에 두어야 함
+    for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+    {
+        WriteString(GetTexturePath(scene->mMaterials[i], aiTextureType_DIFFUSE));
+        WriteString(GetTexturePath(scene->mMaterials[i], aiTextureType_SPECULAR));
+    }
+
+    size_t rawBytes = 0;
+    std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
-    indices.resize(mesh->mNumFaces * 3);
-    for (uint32_t i = 0; i < mesh->mNumFaces; i++)
+    for (uint32_t i = 0; i < scene->mNumMeshes; i++)
+    {
+        ReadMeshData(scene->mMeshes[i], vertices, indices);
+        WeldVertices(vertices, indices);
+        rawBytes += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
+        MeshCodec::OptimizeVertexOrder(vertices, indices);
+
+        VertexQuantization quantization;
+        auto vertexData = MeshCodec::EncodeVertexBuffer(vertices, quantization);
+        auto indexData = MeshCodec::EncodeIndexBuffer(indices);
+
+        Write((int32_t)scene->mMeshes[i]->mMaterialIndex);
+        Write((uint32_t)vertices.size());
+        Write((uint32_t)indices.size());
+        Write(quantization.positionMin);
+        Write(quantization.positionScale);
+        Write(quantization.texCoordMin);
+        Write(quantization.texCoordScale);
+        Write((uint32_t)vertexData.size());
+        WriteBytes(vertexData.data(), vertexData.size());
+        Write((uint32_t)indexData.size());
+        WriteBytes(indexData.data(), indexData.size());
+    }
+
+    for (auto &node : nodes)
+    {
+        Write((int32_t)node.meshIndex);
+        Write(node.transform);
+    }
+
+    std::ofstream fout(outFilename, std::ios::binary);
+    if (!fout.is_open())
     {
-        indices[3 * i] = mesh->mFaces[i].mIndices[0];
-        indices[3 * i + 1] = mesh->mFaces[i].mIndices[1];
-        indices[3 * i + 2] = mesh->mFaces[i].mIndices[2];
+        SPDLOG_ERROR("failed to open file: {}", outFilename);
+        return false;
     }
+    fout.write((const char *)out.data(), out.size());
 
+    SPDLOG_INFO("model compressed: {} -> {}, mesh data {} -> {} bytes", filename, outFilename, rawBytes, out.size());
+    return true;
+}
+
+void Model::AddMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, int materialIndex,
+                    std::vector<MeshGeometry> &geometries)
+{
     // mesh생성, mesh에서 사용할 VBO, VAO, EBO가 다 설정.
-    auto glMesh = Mesh::Create(vertices, indices, GL_TRIANGLES);
+    // 이미 로드된 다른 Model에 같은 내용의 mesh가 있으면 GPU buffer를 공유함
+    auto glMesh = GeometryRegistry::Get().CreateMesh(vertices, indices, GL_TRIANGLES, false);
 
     // mesh에서 사용할 material 설정.
-    if (mesh->mMaterialIndex >= 0)
-        glMesh->SetMaterial(m_materials[mesh->mMaterialIndex]);
+    if (materialIndex >= 0 && materialIndex < (int)m_materials.size())
+        glMesh->SetMaterial(m_materials[materialIndex]);
 
     m_meshes.push_back(std::move(glMesh));
+
+    MeshGeometry geometry;
+    geometry.positions.reserve(vertices.size());
+    for (auto &v : vertices)
+        geometry.positions.push_back(v.position);
+    geometry.indices = indices;
+    geometries.push_back(std::move(geometry));
+}
+
+void Model::SetupInstances()
+{
+    std::vector<std::vector<glm::mat4>> instances(m_meshes.size());
+    for (auto &node : m_nodes)
+        instances[node.meshIndex].push_back(node.transform);
+
+    m_bounds.Resize(m_meshes.size());
+    for (size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if (instances[i].empty()) // 어떤 node에서도 참조하지 않는 mesh는 그리지 않음
+            continue;
+        m_meshes[i]->SetInstanceTransforms(instances[i]);
+
+        // 모든 인스턴스를 감싸는 bounding volume
+        AABB box;
+        for (auto &transform : instances[i])
+            box.Expand(m_meshes[i]->GetAABB().Transform(transform));
+        BoundingSphere sphere{box.GetCenter(), 0.0f};
+        for (auto &transform : instances[i])
+        {
+            auto instanceSphere = m_meshes[i]->GetBoundingSphere().Transform(transform);
+            sphere.radius = glm::max(sphere.radius, glm::length(instanceSphere.center - sphere.center) + instanceSphere.radius);
+        }
+        m_bounds.Set(i, box, sphere);
+    }
+}
+
+void Model::BuildBvh(const std::vector<MeshGeometry> &geometries)
+{
+    std::vector<BvhTriangle> triangles;
+    for (uint32_t n = 0; n < (uint32_t)m_nodes.size(); n++)
+    {
+        auto &node = m_nodes[n];
+        auto &geometry = geometries[node.meshIndex];
+        auto position = [&](uint32_t index)
+        {
+            return glm::vec3(node.transform * glm::vec4(geometry.positions[index], 1.0f));
+        };
+        for (uint32_t i = 0; i + 2 < (uint32_t)geometry.indices.size(); i += 3)
+        {
+            triangles.push_back({position(geometry.indices[i]), position(geometry.indices[i + 1]), position(geometry.indices[i + 2]), n, i / 3});
+        }
+    }
+    m_bvh = Bvh::Build(std::move(triangles));
+    SPDLOG_INFO("bvh built: #triangle: {}, #node: {}", m_bvh->GetTriangleCount(), m_bvh->GetNodeCount());
+}
+
+std::optional<BvhHit> Model::Pick(const glm::vec3 &origin, const glm::vec3 &direction) const
+{
+    return m_bvh ? m_bvh->Intersect(origin, direction) : std::nullopt;
 }
 
 void Model::Draw(const Program *program) const
 {
     for (auto &mesh : m_meshes)
     {
-        mesh->Draw(program);
+        if (mesh->GetInstanceCount() > 0)
+            mesh->Draw(program); // mesh를 참조하는 node 수만큼 instanced draw
     }
-}
\ No newline at end of file
+}
+
+void Model::Draw(const Program *program, const glm::mat4 &transform, CullStats *stats) const
+{
+    CullBounds(Frustum::FromMatrix(transform), m_bounds, m_visible, stats);
+    for (size_t i = 0; i < m_meshes.size(); i++)
+    {
+        if (m_visible[i] && m_meshes[i]->GetInstanceCount() > 0)
+            m_meshes[i]->Draw(program);
+    }
+}
@@ -3,29 +3,77 @@
 
 #include "common.h"
 #include "mesh.h"
+#include "bvh.h"
+#include "skeleton.h"
+#include "skinning.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+// node 계층을 펼친 결과. 어떤 mesh를 어떤 world transform으로 그릴지를 나타낸다.
+struct ModelNode
+{
+    int meshIndex;
+    glm::mat4 transform;
+};
+
 CLASS_PTR(Model);
 class Model
 {
 public:
-    static ModelUPtr Load(const std::string &filename);
+    // BVH를 만들 때까지만 들고 있는 mesh의 CPU 쪽 데이터
+    struct MeshGeometry
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    static ModelUPtr Load(const std::string &filename); // 확장자가 .mshc면 압축 포맷, .obj / .gltf / .glb는 전용 로더, 그 외는 assimp로 로드
+    static bool Compress(const std::string &filename, const std::string &outFilename); // assimp로 읽은 model을 .mshc로 저장 (GL context 불필요)
+    // skinned mesh와 모든 animation을 frameRate로 샘플링해서 .vat로 저장 (GL context 불필요)
+    static bool BakeVertexAnimation(const std::string &filename, const std::string &outFilename, float frameRate);
 
     int GetMeshCount() const { return (int)m_meshes.size(); }
     MeshPtr GetMesh(int index) const { return m_meshes[index]; }
-    void Draw(const Program *program) const;
+    const std::vector<ModelNode> &GetNodes() const { return m_nodes; }
+    void Draw(const Program *program) const; // 인스턴스 attribute(location 3)를 쓰는 program 필요 (lighting_instanced.vs)
+    void Draw(const Program *program, const glm::mat4 &transform, CullStats *stats = nullptr) const; // transform(projection * view * model)의 frustum 밖 mesh는 건너뜀
+
+    // model space ray와 가장 가까운 삼각형. hit.objectId는 GetNodes()의 인덱스
+    std::optional<BvhHit> Pick(const glm::vec3 &origin, const glm::vec3 &direction) const;
+
+    // bone이 있는 model(assimp 경로)만 설정됨. bone이 없으면 GetSkeleton()은 nullptr
+    const Skeleton *GetSkeleton() const { return m_skeleton.get(); }
+    int GetAnimationCount() const { return (int)m_animations.size(); }
+    const Animation *GetAnimation(int index) const { return m_animations[index].get(); }
+    const std::vector<SkinnedMeshPtr> &GetSkinnedMeshes() const { return m_skinnedMeshes; }
 
 private:
     Model() {}
     bool LoadByAssimp(const std::string &filename);
-    void ProcessMesh(aiMesh *mesh, const aiScene *scene);
-    void ProcessNode(aiNode *node, const aiScene *scene);
+    bool LoadByCodec(const std::string &filename);
+    bool LoadByObj(const std::string &filename);
+    bool LoadByGltf(const std::string &filename);
+    void AddMesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices, int materialIndex,
+                 std::vector<MeshGeometry> &geometries);
+    void LoadSkeleton(const aiScene *scene); // bone weight, node 계층, aiAnimation을 읽어 skinning 데이터 구성
+    void SetupInstances(); // m_nodes를 mesh별로 모아 instance buffer 생성
+    void BuildBvh(const std::vector<MeshGeometry> &geometries);
 
-    std::vector<MeshPtr> m_meshes;
+    std::vector<MeshPtr> m_meshes; // aiMesh 하나당 GPU Mesh 하나 (scene->mMeshes와 같은 인덱스)
     std::vector<MaterialPtr> m_materials;
+    std::vector<ModelNode> m_nodes;
+
+    BoundsSoA m_bounds;                     // mesh별로 모든 인스턴스를 감싸는 model space bounding volume
+    mutable std::vector<uint8_t> m_visible; // 매 프레임 할당하지 않도록 culling 결과를 재사용
+
+    BvhUPtr m_bvh; // picking용, node transform이 적용된 삼각형으로 구성
+
+    // skeletal animation. bone이 있는 mesh도 m_meshes에 bind pose로 남아 있어서 culling / picking은 그대로 동작
+    SkeletonUPtr m_skeleton;
+    std::vector<AnimationUPtr> m_animations;
+    std::vector<SkinnedMeshPtr> m_skinnedMeshes;
 };
 
 #endif // __MODEL_H__
\ No newline at end of file
@@ -0,0 +1,545 @@
+#include "obj_loader.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <unordered_map>
+
+static const size_t kMinChunkSize = 1 << 20; // 이보다 작은 조각은 스레드를 나누는 비용이 더 큼
+
+// ---------------------------------------------------------------------------------------
+// 토큰 파싱
+
+static bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *SkipSpace(const char *p, const char *end)
+{
+    while (p < end && IsSpace(*p))
+        p++;
+    return p;
+}
+
+static const char *SkipLine(const char *p, const char *end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    return p < end ? p + 1 : end;
+}
+
+// 줄의 나머지에서 앞뒤 공백을 뺀 문자열
+static std::string ReadRestOfLine(const char *p, const char *end)
+{
+    p = SkipSpace(p, end);
+    auto lineEnd = p;
+    while (lineEnd < end && *lineEnd != '\n')
+        lineEnd++;
+    while (lineEnd > p && IsSpace(lineEnd[-1]))
+        lineEnd--;
+    return std::string(p, lineEnd);
+}
+
+// strtof보다 훨씬 빠른 10진수 float 파서 (locale 무시, 유효숫자 19자리까지)
+static const char *ParseFloat(const char *p, const char *end, float &value)
+{
+    static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    p = SkipSpace(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    auto start = p;
+    for (; p < end && (unsigned)(*p - '0') < 10; p++)
+    {
+        if (digits++ < 19)
+            mantissa = mantissa * 10 + (*p - '0');
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && (unsigned)(*p - '0') < 10; p++)
+        {
+            if (digits++ < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (p == start) // 숫자가 하나도 없음
+        return nullptr;
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negativeExp = *p++ == '-';
+        int e = 0;
+        for (; p < end && (unsigned)(*p - '0') < 10; p++)
+            e = glm::min(e * 10 + (*p - '0'), 10000);
+        exponent += negativeExp ? -e : e;
+    }
+
+    double result = (double)mantissa;
+    if (exponent < 0)
+        result = -exponent <= 22 ? result / kPow10[-exponent] : result * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        result = exponent <= 22 ? result * kPow10[exponent] : result * std::pow(10.0, exponent);
+    value = (float)(negative ? -result : result);
+    return p;
+}
+
+static const char *ParseInt(const char *p, const char *end, int &value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    auto start = p;
+    int result = 0;
+    for (; p < end && (unsigned)(*p - '0') < 10; p++)
+        result = result * 10 + (*p - '0');
+    if (p == start)
+        return nullptr;
+    value = negative ? -result : result;
+    return p;
+}
+
+// ---------------------------------------------------------------------------------------
+// chunk 파싱
+
+// face의 꼭짓점 하나. relative 비트가 켜진 인덱스는 음수 인덱스를 chunk 안에서 푼 값이라
+// chunk 시작 시점의 전체 개수를 더해야 전역 인덱스가 된다.
+struct ObjCorner
+{
+    int32_t index[3]; // v, vt, vn (0부터)
+    uint8_t relative; // bit i: index[i]가 chunk 기준
+    uint8_t present;  // bit i: index[i]가 있음 (v는 항상 있음)
+};
+
+struct ObjMaterialSwitch
+{
+    size_t cornerOffset; // 이 위치의 corner부터 새 material
+    std::string name;
+};
+
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners; // 삼각형마다 3개
+    std::vector<ObjMaterialSwitch> materialSwitches;
+    std::vector<std::string> materialLibs;
+    bool ok{true};
+};
+
+static const char *ParseFace(const char *p, const char *end, ObjChunk &chunk, std::vector<ObjCorner> &polygon)
+{
+    const int counts[3] = {(int)chunk.positions.size(), (int)chunk.texCoords.size(), (int)chunk.normals.size()};
+    polygon.clear();
+    while (true)
+    {
+        p = SkipSpace(p, end);
+        if (p >= end || *p == '\n' || *p == '#')
+            break;
+
+        ObjCorner corner{};
+        for (int k = 0; k < 3; k++)
+        {
+            if (k > 0)
+            {
+                if (p >= end || *p != '/')
+                    break;
+                p++;
+                if (p < end && *p == '/') // v//vn
+                    continue;
+            }
+            int value = 0;
+            auto next = ParseInt(p, end, value);
+            if (!next || value == 0)
+                return nullptr;
+            p = next;
+            if (value > 0)
+            {
+                corner.index[k] = value - 1;
+            }
+            else
+            {
+                corner.index[k] = counts[k] + value;
+                corner.relative |= 1 << k;
+            }
+            corner.present |= 1 << k;
+        }
+        if (!(corner.present & 1) || (p < end && !IsSpace(*p) && *p != '\n'))
+            return nullptr;
+        polygon.push_back(corner);
+    }
+
+    // fan triangulation
+    for (size_t i = 2; i < polygon.size(); i++)
+    {
+        chunk.corners.push_back(polygon[0]);
+        chunk.corners.push_back(polygon[i - 1]);
+        chunk.corners.push_back(polygon[i]);
+    }
+    return p;
+}
+
+static void ParseChunk(const char *p, const char *end, ObjChunk &chunk)
+{
+    std::vector<ObjCorner> polygon;
+    while (p < end)
+    {
+        p = SkipSpace(p, end);
+        if (p >= end)
+            break;
+
+        const char *next = p;
+        if (p[0] == 'v' && p + 1 < end && IsSpace(p[1]))
+        {
+            glm::vec3 v;
+            next = ParseFloat(p + 1, end, v.x);
+            next = next ? ParseFloat(next, end, v.y) : nullptr;
+            next = next ? ParseFloat(next, end, v.z) : nullptr;
+            chunk.positions.push_back(v);
+        }
+        else if (p[0] == 'v' && p + 2 < end && p[1] == 't' && IsSpace(p[2]))
+        {
+            glm::vec2 vt(0.0f);
+            next = ParseFloat(p + 2, end, vt.x);
+            if (next) // v 좌표는 생략 가능
+            {
+                auto y = ParseFloat(next, end, vt.y);
+                next = y ? y : next;
+            }
+            chunk.texCoords.push_back(glm::vec2(vt.x, 1.0f - vt.y)); // aiProcess_FlipUVs
+        }
+        else if (p[0] == 'v' && p + 2 < end && p[1] == 'n' && IsSpace(p[2]))
+        {
+            glm::vec3 vn;
+            next = ParseFloat(p + 2, end, vn.x);
+            next = next ? ParseFloat(next, end, vn.y) : nullptr;
+            next = next ? ParseFloat(next, end, vn.z) : nullptr;
+            chunk.normals.push_back(vn);
+        }
+        else if (p[0] == 'f' && p + 1 < end && IsSpace(p[1]))
+        {
+            next = ParseFace(p + 1, end, chunk, polygon);
+        }
+        else if (end - p > 7 && strncmp(p, "usemtl", 6) == 0 && IsSpace(p[6]))
+        {
+            chunk.materialSwitches.push_back({chunk.corners.size(), ReadRestOfLine(p + 6, end)});
+        }
+        else if (end - p > 7 && strncmp(p, "mtllib", 6) == 0 && IsSpace(p[6]))
+        {
+            chunk.materialLibs.push_back(ReadRestOfLine(p + 6, end));
+        }
+        // 주석, o, g, s, l 등 나머지는 무시
+
+        if (!next)
+        {
+            chunk.ok = false;
+            return;
+        }
+        p = SkipLine(next, end);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// mtl
+
+static bool ParseMtl(const std::string &filename, std::vector<ObjMaterial> &materials)
+{
+    auto file = MappedFile::Open(filename);
+    if (!file)
+        return false;
+
+    auto p = (const char *)file->GetData();
+    auto end = p + file->GetSize();
+    while (p < end)
+    {
+        p = SkipSpace(p, end);
+        auto StartsWith = [&](const char *keyword)
+        {
+            size_t length = strlen(keyword);
+            return (size_t)(end - p) > length && strncmp(p, keyword, length) == 0 && IsSpace(p[length]);
+        };
+        // map_xx 줄에는 -bm 1 같은 옵션이 먼저 올 수 있으므로 마지막 토큰을 경로로 사용
+        auto ReadMapPath = [&](size_t keywordLength)
+        {
+            auto value = ReadRestOfLine(p + keywordLength, end);
+            auto space = value.find_last_of(" \t");
+            return space == std::string::npos ? value : value.substr(space + 1);
+        };
+
+        if (StartsWith("newmtl"))
+            materials.push_back({ReadRestOfLine(p + 6, end)});
+        else if (!materials.empty() && StartsWith("map_Kd"))
+            materials.back().diffuseMap = ReadMapPath(6);
+        else if (!materials.empty() && StartsWith("map_Ks"))
+            materials.back().specularMap = ReadMapPath(6);
+        p = SkipLine(p, end);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+// 정점 생성
+
+// (v, vt, vn) -> 정점 인덱스. 삼각형 수에 맞춰 한 번에 잡아두는 open addressing 해시 테이블
+class CornerTable
+{
+public:
+    explicit CornerTable(size_t count)
+    {
+        size_t capacity = 16;
+        while (capacity < count * 2)
+            capacity <<= 1;
+        m_mask = capacity - 1;
+        m_slots.resize(capacity, {{0, 0, 0}, UINT32_MAX});
+    }
+
+    // 처음 보는 조합이면 nextValue를 넣고 true
+    bool Insert(const int32_t key[3], uint32_t nextValue, uint32_t &value)
+    {
+        uint64_t h = (uint64_t)(uint32_t)key[0] * 0x9E3779B97F4A7C15ull ^
+                     (uint64_t)(uint32_t)key[1] * 0xC2B2AE3D27D4EB4Full ^
+                     (uint64_t)(uint32_t)key[2] * 0x165667B19E3779F9ull;
+        for (size_t i = (size_t)(h ^ (h >> 29)) & m_mask;; i = (i + 1) & m_mask)
+        {
+            auto &slot = m_slots[i];
+            if (slot.value == UINT32_MAX)
+            {
+                memcpy(slot.key, key, sizeof(slot.key));
+                slot.value = value = nextValue;
+                return true;
+            }
+            if (memcmp(slot.key, key, sizeof(slot.key)) == 0)
+            {
+                value = slot.value;
+                return false;
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        int32_t key[3];
+        uint32_t value;
+    };
+    std::vector<Slot> m_slots;
+    size_t m_mask;
+};
+
+struct ObjAttributes
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+};
+
+// corners(전역 인덱스로 풀린 삼각형들)에서 중복 없는 정점 / 인덱스 버퍼를 만든다.
+static void BuildMesh(const ObjAttributes &attributes, const std::vector<ObjCorner> &corners, ObjMesh &mesh)
+{
+    CornerTable table(corners.size());
+    mesh.indices.resize(corners.size());
+    bool missingNormal = false;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        auto &corner = corners[i];
+        int32_t key[3] = {corner.index[0],
+                          corner.present & 2 ? corner.index[1] : -1,
+                          corner.present & 4 ? corner.index[2] : -1};
+        uint32_t index;
+        if (table.Insert(key, (uint32_t)mesh.vertices.size(), index))
+        {
+            Vertex v;
+            v.position = attributes.positions[key[0]];
+            v.texCoord = key[1] >= 0 ? attributes.texCoords[key[1]] : glm::vec2(0.0f);
+            v.normal = key[2] >= 0 ? attributes.normals[key[2]] : glm::vec3(0.0f);
+            missingNormal |= key[2] < 0;
+            mesh.vertices.push_back(v);
+        }
+        mesh.indices[i] = index;
+    }
+
+    // vn이 없는 정점은 주변 face normal의 (면적 가중) 평균으로 채움
+    if (missingNormal)
+    {
+        std::vector<glm::vec3> accum(mesh.vertices.size(), glm::vec3(0.0f));
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            auto i0 = mesh.indices[i], i1 = mesh.indices[i + 1], i2 = mesh.indices[i + 2];
+            auto n = glm::cross(mesh.vertices[i1].position - mesh.vertices[i0].position,
+                                mesh.vertices[i2].position - mesh.vertices[i0].position);
+            accum[i0] += n;
+            accum[i1] += n;
+            accum[i2] += n;
+        }
+        for (size_t i = 0; i < mesh.vertices.size(); i++)
+        {
+            auto &v = mesh.vertices[i];
+            if (v.normal == glm::vec3(0.0f) && glm::length(accum[i]) > 0.0f)
+                v.normal = glm::normalize(accum[i]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+
+std::optional<ObjData> ObjLoader::Load(const std::string &filename)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    auto file = MappedFile::Open(filename);
+    if (!file)
+        return {};
+
+    // 1. 줄 경계에서 chunk로 나눈다.
+    auto data = (const char *)file->GetData();
+    auto size = file->GetSize();
+    size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t chunkCount = std::max<size_t>(std::min(threadCount, size / kMinChunkSize), 1);
+    std::vector<const char *> bounds(chunkCount + 1);
+    bounds[0] = data;
+    bounds[chunkCount] = data + size;
+    for (size_t i = 1; i < chunkCount; i++)
+    {
+        auto p = std::max(data + size * i / chunkCount, bounds[i - 1]);
+        bounds[i] = SkipLine(p, data + size);
+    }
+
+    // 2. chunk마다 병렬로 파싱
+    std::vector<ObjChunk> chunks(chunkCount);
+    {
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 1; i < chunkCount; i++)
+            tasks.push_back(std::async(std::launch::async, [&, i]()
+                                       { ParseChunk(bounds[i], bounds[i + 1], chunks[i]); }));
+        ParseChunk(bounds[0], bounds[1], chunks[0]);
+        for (auto &task : tasks)
+            task.wait();
+    }
+    for (auto &chunk : chunks)
+    {
+        if (!chunk.ok)
+        {
+            SPDLOG_ERROR("failed to parse obj: {}", filename);
+            return {};
+        }
+    }
+
+    // 3. attribute를 이어 붙이고 chunk 기준 인덱스를 전역 인덱스로 변환
+    ObjAttributes attributes;
+    std::vector<size_t> bases(chunkCount * 3);
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        bases[i * 3] = attributes.positions.size();
+        bases[i * 3 + 1] = attributes.texCoords.size();
+        bases[i * 3 + 2] = attributes.normals.size();
+        attributes.positions.insert(attributes.positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+        attributes.texCoords.insert(attributes.texCoords.end(), chunks[i].texCoords.begin(), chunks[i].texCoords.end());
+        attributes.normals.insert(attributes.normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+    }
+    const size_t counts[3] = {attributes.positions.size(), attributes.texCoords.size(), attributes.normals.size()};
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        for (auto &corner : chunks[i].corners)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                if (!(corner.present & (1 << k)))
+                    continue;
+                if (corner.relative & (1 << k))
+                    corner.index[k] += (int32_t)bases[i * 3 + k];
+                if (corner.index[k] < 0 || (size_t)corner.index[k] >= counts[k])
+                {
+                    SPDLOG_ERROR("invalid face index in obj: {}", filename);
+                    return {};
+                }
+            }
+        }
+    }
+
+    // 4. mtl 로드
+    ObjData result;
+    auto dirname = filename.substr(0, filename.find_last_of("/"));
+    for (auto &chunk : chunks)
+    {
+        for (auto &lib : chunk.materialLibs)
+        {
+            if (!ParseMtl(fmt::format("{}/{}", dirname, lib), result.materials))
+                SPDLOG_ERROR("failed to load mtl: {}", lib);
+        }
+    }
+    std::unordered_map<std::string, int> materialIndices;
+    for (int i = 0; i < (int)result.materials.size(); i++)
+        materialIndices.emplace(result.materials[i].name, i);
+
+    // 5. usemtl 구간을 따라 삼각형을 material별로 모음 (material이 처음 나온 순서대로 mesh 생성)
+    std::vector<std::vector<ObjCorner>> groups;
+    std::vector<int> groupMaterials;
+    std::unordered_map<int, size_t> groupIndices;
+    int currentMaterial = -1;
+    for (auto &chunk : chunks)
+    {
+        size_t begin = 0;
+        for (size_t s = 0; s <= chunk.materialSwitches.size(); s++)
+        {
+            size_t end = s < chunk.materialSwitches.size() ? chunk.materialSwitches[s].cornerOffset : chunk.corners.size();
+            if (end > begin)
+            {
+                auto inserted = groupIndices.emplace(currentMaterial, groups.size());
+                if (inserted.second)
+                {
+                    groups.emplace_back();
+                    groupMaterials.push_back(currentMaterial);
+                }
+                auto &group = groups[inserted.first->second];
+                group.insert(group.end(), chunk.corners.begin() + begin, chunk.corners.begin() + end);
+            }
+            if (s < chunk.materialSwitches.size())
+            {
+                auto found = materialIndices.find(chunk.materialSwitches[s].name);
+                currentMaterial = found != materialIndices.end() ? found->second : -1;
+            }
+            begin = end;
+        }
+    }
+
+    // 6. mesh마다 병렬로 정점 중복 제거
+    // group이 수천 개일 수 있으므로 스레드는 코어 수만큼만 띄우고 각 스레드가 다음 group을 가져가서 처리
+    result.meshes.resize(groups.size());
+    for (size_t i = 0; i < groups.size(); i++)
+        result.meshes[i].materialIndex = groupMaterials[i];
+    {
+        std::atomic<size_t> nextGroup{0};
+        auto worker = [&]()
+        {
+            for (size_t i = nextGroup++; i < groups.size(); i = nextGroup++)
+                BuildMesh(attributes, groups[i], result.meshes[i]);
+        };
+        size_t workerCount = std::min(threadCount, groups.size());
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 1; i < workerCount; i++)
+            tasks.push_back(std::async(std::launch::async, worker));
+        worker();
+        for (auto &task : tasks)
+            task.wait();
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    SPDLOG_INFO("obj loaded: {}, {} bytes, #chunk: {}, #mesh: {}, {:.1f} ms", filename, size, chunkCount, result.meshes.size(), elapsed);
+    return result;
+}
@@ -0,0 +1,41 @@
+#ifndef __OBJ_LOADER_H__
+#define __OBJ_LOADER_H__
+
+#include "common.h"
+#include "mesh.h"
+
+// .mtl의 newmtl 하나. 텍스쳐 경로는 .obj 파일 기준 상대 경로
+struct ObjMaterial
+{
+    std::string name;
+    std::string diffuseMap;  // map_Kd
+    std::string specularMap; // map_Ks
+};
+
+// 같은 material을 쓰는 face를 모아 만든 mesh. 정점은 (v, vt, vn) 조합마다 하나
+struct ObjMesh
+{
+    int materialIndex{-1}; // ObjData::materials의 인덱스, 없으면 -1
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct ObjData
+{
+    std::vector<ObjMaterial> materials;
+    std::vector<ObjMesh> meshes;
+};
+
+// assimp를 거치지 않는 OBJ / MTL 전용 로더
+// 파일을 mmap한 뒤 줄 경계에서 chunk로 나누어 여러 스레드에서 파싱하고, 결과를 순서대로 합친다.
+// assimp의 aiProcess_Triangulate | aiProcess_FlipUVs와 같은 결과가 되도록 polygon은 fan으로 나누고 v 좌표는 뒤집는다.
+class ObjLoader
+{
+public:
+    static std::optional<ObjData> Load(const std::string &filename);
+
+private:
+    ObjLoader() {}
+};
+
+#endif // __OBJ_LOADER_H__
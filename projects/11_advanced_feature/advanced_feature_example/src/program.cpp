@@ -1,4 +1,38 @@
 #include "program.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// program binary 캐시 파일 헤더
+static const char kBinaryMagic[4] = {'P', 'B', 'I', 'N'};
+static const uint32_t kBinaryVersion = 1;
+
+static std::string s_binaryCacheDirectory;
+
+// 캐시 키용 64bit FNV-1a
+static uint64_t HashText(const std::string &text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text)
+    {
+        hash ^= (uint8_t)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static bool IsBinaryCacheSupported()
+{
+    if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary)
+        return false;
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
 
 ProgramUPtr Program::Create(const std::vector<ShaderPtr> &shaders)
 {
@@ -8,21 +42,130 @@ ProgramUPtr Program::Create(const std::vector<ShaderPtr> &shaders)
     return std::move(program);
 }
 
-ProgramUPtr Program::Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename)
+ProgramUPtr Program::Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                            const std::vector<std::string> &defines)
+{
+    auto program = Submit(vertShaderFilename, fragShaderFilename, defines);
+    if (!program || !program->Finish())
+        return nullptr;
+    return std::move(program);
+}
+
+ProgramUPtr Program::Submit(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                            const std::vector<std::string> &defines)
 {
-    ShaderPtr vs = Shader::CreateFromFile(vertShaderFilename, GL_VERTEX_SHADER);
-    ShaderPtr fs = Shader::CreateFromFile(fragShaderFilename, GL_FRAGMENT_SHADER);
+    // 캐시 키는 펼친 뒤의 소스로 만들기 때문에 include된 파일이나 define이 바뀌어도 구분됨
+    auto vsCode = Shader::Preprocess(vertShaderFilename, defines);
+    auto fsCode = Shader::Preprocess(fragShaderFilename, defines);
+    if (!vsCode || !fsCode)
+        return nullptr;
+
+    // binary는 같은 driver에서만 유효하므로 renderer / version도 키에 넣음
+    std::string cacheFile;
+    uint64_t key = 0;
+    bool useCache = !s_binaryCacheDirectory.empty() && IsBinaryCacheSupported();
+    if (useCache)
+    {
+        key = HashText(fmt::format("{}\n{}\n{}\n{}",
+                                   (const char *)glGetString(GL_RENDERER), (const char *)glGetString(GL_VERSION),
+                                   *vsCode, *fsCode));
+        cacheFile = fmt::format("{}/{:016x}.bin", s_binaryCacheDirectory, key);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        auto program = ProgramUPtr(new Program());
+        if (program->LoadBinary(cacheFile, key))
+        {
+            auto end = std::chrono::high_resolution_clock::now();
+            SPDLOG_INFO("program loaded from binary cache: {}, {} ({:.3f} ms)", vertShaderFilename, fragShaderFilename,
+                        std::chrono::duration<float, std::milli>(end - start).count());
+            return std::move(program);
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ShaderPtr vs = Shader::SubmitSource(*vsCode, GL_VERTEX_SHADER, vertShaderFilename);
+    ShaderPtr fs = Shader::SubmitSource(*fsCode, GL_FRAGMENT_SHADER, fragShaderFilename);
     /* 
         앞에 ShaderPtr로 타입을 명시해줘야 unique_ptr이 shadred_ptr로 바뀐다.
         auto로 쓰면 CreateFromFile의 반환타이빈 unique_ptr이 그대로 쓰인다. 
         auto vertShader = Shader::CreateFromFile("./shader/simple.vs", GL_VERTEX_SHADER);
     */
-    if (!vs || !fs)
-        return nullptr;
-    return std::move(Create({vs, fs}));
+    // 컴파일 결과는 따로 묻지 않고 바로 링크를 요청. 컴파일이 실패하면 링크도 실패하므로 그때 원인을 출력
+    auto program = ProgramUPtr(new Program());
+    program->SubmitLink({vs, fs});
+    program->m_pending = std::make_unique<PendingLink>();
+    program->m_pending->shaders = {vs, fs};
+    program->m_pending->name = fmt::format("{}, {}", vertShaderFilename, fragShaderFilename);
+    if (useCache)
+    {
+        program->m_pending->cacheFile = cacheFile;
+        program->m_pending->cacheKey = key;
+    }
+    program->m_pending->start = start;
+    return std::move(program);
+}
+
+bool Program::IsParallelCompileSupported()
+{
+    return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+}
+
+bool Program::IsCompleted() const
+{
+    if (!m_pending || !IsParallelCompileSupported())
+        return true;
+    int completed = 0;
+    glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &completed); // ARB 확장도 같은 enum 값
+    return completed != 0;
+}
+
+bool Program::Finish()
+{
+    if (!m_pending)
+        return m_program != 0;
+    auto pending = std::move(m_pending);
+    if (!CheckLinkStatus(pending->shaders))
+    {
+        SPDLOG_ERROR("failed to create program: {}", pending->name);
+        return false;
+    }
+    // 비동기로 만들었다면 요청부터 완료를 확인할 때까지의 시간이므로 다른 작업과 겹친 시간도 포함됨
+    auto end = std::chrono::high_resolution_clock::now();
+    SPDLOG_INFO("program compiled: {} ({:.3f} ms)", pending->name,
+                std::chrono::duration<float, std::milli>(end - pending->start).count());
+    if (!pending->cacheFile.empty())
+        SaveBinary(pending->cacheFile, pending->cacheKey);
+    return true;
+}
+
+void Program::SetBinaryCacheDirectory(const std::string &directory)
+{
+    s_binaryCacheDirectory = directory;
+    if (directory.empty())
+        return;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        SPDLOG_ERROR("failed to create program binary cache directory: {} ({})", directory, error.message());
+        s_binaryCacheDirectory.clear();
+    }
+}
+
+void Program::Swap(Program &other)
+{
+    std::swap(m_program, other.m_program);
+    std::swap(m_uniforms, other.m_uniforms);
+    std::swap(m_pending, other.m_pending);
 }
 
 bool Program::Link(const std::vector<ShaderPtr> &shaders)
+{
+    SubmitLink(shaders);
+    return CheckLinkStatus(shaders);
+}
+
+void Program::SubmitLink(const std::vector<ShaderPtr> &shaders)
 {
     m_program = glCreateProgram(); // glCreateShader와 같이 u_int32t 타입으로 반환
     for (auto &shader : shaders)
@@ -34,74 +177,306 @@ bool Program::Link(const std::vector<ShaderPtr> &shaders)
         }
     */
 
+    if (!s_binaryCacheDirectory.empty() && IsBinaryCacheSupported()) // 링크 후 glGetProgramBinary로 꺼낼 수 있도록 미리 알림
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_program); // vertex shader와 fragment shader가 attatch된 상태에서 그 둘을 링크
+}
 
+bool Program::CheckLinkStatus(const std::vector<ShaderPtr> &shaders)
+{
     int success = 0;
     glGetProgramiv(m_program, GL_LINK_STATUS, &success); // glGetShaderiv와 하는 일이 같음.
                                                          // GL_LINK_STATUS에 대한 정보를 success에 넣어줌.
     if (!success)                                        // 프로그램 링크 실패시
     {
+        for (auto &shader : shaders) // 컴파일에 실패한 shader가 있으면 그 로그가 더 정확함
+            shader->CheckCompileStatus();
         char infoLog[1024];
         glGetProgramInfoLog(m_program, 1024, nullptr, infoLog); // program에 관한 로그 정보가져오고
         SPDLOG_ERROR("failed to link program: {}", infoLog);    // 출력
         return false;
     }
+    ReflectUniforms();
     return true;
 }
 
+// 캐시 파일 레이아웃: "PBIN", version, key(uint64), binary format(uint32), binary
+bool Program::LoadBinary(const std::string &filename, uint64_t key)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open()) // 처음 실행이거나 소스가 바뀜
+        return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    const size_t headerSize = 4 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+    uint32_t version = 0, format = 0;
+    uint64_t storedKey = 0;
+    if (bytes.size() <= headerSize || memcmp(bytes.data(), kBinaryMagic, 4) != 0)
+        return false;
+    memcpy(&version, bytes.data() + 4, sizeof(version));
+    memcpy(&storedKey, bytes.data() + 8, sizeof(storedKey));
+    memcpy(&format, bytes.data() + 16, sizeof(format));
+    if (version != kBinaryVersion || storedKey != key)
+        return false;
+
+    m_program = glCreateProgram();
+    glProgramBinary(m_program, format, bytes.data() + headerSize, (GLsizei)(bytes.size() - headerSize));
+    int success = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    if (!success) // driver가 업데이트되는 등으로 거부하면 소스에서 다시 컴파일
+    {
+        SPDLOG_INFO("program binary rejected by driver, recompiling: {}", filename);
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+    ReflectUniforms();
+    return true;
+}
+
+void Program::SaveBinary(const std::string &filename, uint64_t key) const
+{
+    int length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<uint8_t> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(m_program, length, &length, &format, binary.data());
+
+    // 다른 프로세스가 읽는 중에 반쯤 쓴 파일을 보지 않도록 임시 파일에 쓰고 이름을 바꿈
+    auto tempFilename = filename + ".tmp";
+    {
+        std::ofstream fout(tempFilename, std::ios::binary);
+        if (!fout.is_open())
+        {
+            SPDLOG_ERROR("failed to open file: {}", tempFilename);
+            return;
+        }
+        uint32_t binaryFormat = format;
+        fout.write(kBinaryMagic, 4);
+        fout.write((const char *)&kBinaryVersion, sizeof(kBinaryVersion));
+        fout.write((const char *)&key, sizeof(key));
+        fout.write((const char *)&binaryFormat, sizeof(binaryFormat));
+        fout.write((const char *)binary.data(), length);
+    }
+    std::error_code error;
+    std::filesystem::rename(tempFilename, filename, error);
+    if (error)
+        SPDLOG_ERROR("failed to save program binary: {} ({})", filename, error.message());
+}
+
+void Program::ReflectUniforms()
+{
+    int count = 0;
+    int maxLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(std::max(maxLength, 1));
+    std::vector<std::string> names;
+    auto Add = [&](const std::string &name, int location)
+    {
+        m_uniforms.push_back({UniformHandle(name).GetHash(), location});
+        names.push_back(name);
+    };
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, size = 0;
+        uint32_t type = 0;
+        glGetActiveUniform(m_program, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int location = glGetUniformLocation(m_program, name.c_str());
+        if (location < 0) // uniform block 안의 변수
+            continue;
+        Add(name, location);
+
+        // 배열은 "name[0]"으로 보고되므로 "name"과 나머지 원소도 등록
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            auto base = name.substr(0, name.size() - 3);
+            Add(base, location);
+            for (int element = 1; element < size; element++)
+            {
+                auto elementName = fmt::format("{}[{}]", base, element);
+                Add(elementName, glGetUniformLocation(m_program, elementName.c_str()));
+            }
+        }
+    }
+
+    // hash 충돌은 이름이 다른 uniform끼리만 문제가 되므로 링크 때 한 번 확인
+    std::vector<size_t> order(m_uniforms.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+              { return m_uniforms[a].first < m_uniforms[b].first; });
+    for (size_t i = 1; i < order.size(); i++)
+    {
+        if (m_uniforms[order[i]].first == m_uniforms[order[i - 1]].first)
+            SPDLOG_ERROR("uniform name hash collision: {}, {}", names[order[i]], names[order[i - 1]]);
+    }
+    std::sort(m_uniforms.begin(), m_uniforms.end());
+}
+
+UniformLocation Program::GetUniformLocation(UniformHandle name) const
+{
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), std::make_pair(name.GetHash(), INT32_MIN));
+    if (it == m_uniforms.end() || it->first != name.GetHash())
+        return {};
+    return {it->second};
+}
+
 Program::~Program()
 {
     if (m_program)
     {                               // 프로그램 id값이 초기값 0이 아닌 다른 값이 있으면
         glDeleteProgram(m_program); // 프로그램 삭제
+        GlState::Get().OnDeleteProgram(m_program);
     }
 }
 
 void Program::Use() const
 {
-    glUseProgram(m_program);
+    GlState::Get().UseProgram(m_program);
 }
 
-void Program::SetUniform(const std::string &name, int value) const
+void Program::SetUniform(UniformLocation location, int value) const
 {
-    // glGetUniformLocation() 함수로 shader 내의 sampler2D uniform 핸들을 얻어옴
     // glUniform1i() 함수로 sampler2D uniform에 텍스처 슬롯 인덱스를 입력
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform1i(loc, value);
+    glUniform1i(location.value, value);
 }
 
-void Program::SetUniform(const std::string &name,
-                         const glm::mat4 &value) const
+void Program::SetUniform(UniformLocation location, const glm::mat4 &value) const
 {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+    glUniformMatrix4fv(location.value, 1, GL_FALSE, glm::value_ptr(value));
     // 첫 번째 인자는 vertexshader의 transform 변수의 handle
     // 두 번째 인자는 행렬 개수
     // transpose(전치)의 여부
     // transform은 16개(4*4)의 value를 저장하고 있는 배열을 가지고 있음. glm::value_ptr은 그 배열의 첫 원소의 주소값을 의미.
 }
 
-void Program::SetUniform(const std::string &name, float value) const
+void Program::SetUniform(UniformLocation location, float value) const
 {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform1f(loc, value);
+    glUniform1f(location.value, value);
 }
 
-void Program::SetUniform(const std::string &name, const glm::vec2 &value) const
+void Program::SetUniform(UniformLocation location, const glm::vec2 &value) const
 {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform2fv(loc, 1, glm::value_ptr(value));
+    glUniform2fv(location.value, 1, glm::value_ptr(value));
 }
 
-void Program::SetUniform(const std::string &name, const glm::vec3 &value) const
+void Program::SetUniform(UniformLocation location, const glm::vec3 &value) const
 {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform3fv(loc, 1, glm::value_ptr(value));
+    glUniform3fv(location.value, 1, glm::value_ptr(value));
     // glUniform3f(loc, value.x, value.y, value.z); // glUnfirom3f를 사용할 수도 있다.
 }
 
-void Program::SetUniform(const std::string &name, const glm::vec4 &value) const
+void Program::SetUniform(UniformLocation location, const glm::vec4 &value) const
+{
+    glUniform4fv(location.value, 1, glm::value_ptr(value));
+}
+
+void Program::SetUniform(UniformLocation location, const glm::vec4 *values, int count) const
+{
+    glUniform4fv(location.value, count, glm::value_ptr(values[0]));
+}
+
+void Program::SetUniformBlockBinding(const std::string &blockName, uint32_t binding) const
 {
-    auto loc = glGetUniformLocation(m_program, name.c_str());
-    glUniform4fv(loc, 1, glm::value_ptr(value));
-}
\ No newline at end of file
+    auto index = glGetUniformBlockIndex(m_program, blockName.c_str());
+    if (index != GL_INVALID_INDEX) // 사용되지 않는 block은 링크 과정에서 제거될 수 있음
+        glUniformBlockBinding(m_program, index, binding);
+}
+
+ProgramVariantsUPtr ProgramVariants::Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                                            std::vector<std::string> features,
+                                            std::function<void(const Program *)> setup)
+{
+    auto variants = ProgramVariantsUPtr(new ProgramVariants());
+    variants->m_vertShaderFilename = vertShaderFilename;
+    variants->m_fragShaderFilename = fragShaderFilename;
+    variants->m_features = std::move(features);
+    variants->m_setup = std::move(setup);
+    return std::move(variants);
+}
+
+const Program *ProgramVariants::Get(uint32_t key)
+{
+    auto it = m_variants.find(key);
+    if (it == m_variants.end())
+        it = m_variants.emplace(key, Program::Submit(m_vertShaderFilename, m_fragShaderFilename, GetDefines(key))).first;
+    else if (!it->second || !it->second->IsPending())
+        return it->second.get();
+
+    // 방금 요청했거나 컴파일 중인 variant. 완료되면 한 번만 setup
+    auto &program = it->second;
+    if (!program)
+        return nullptr;
+    if (program->IsPending())
+    {
+        if (!program->IsCompleted())
+            return nullptr;
+        if (!program->Finish())
+        {
+            program.reset();
+            return nullptr;
+        }
+    }
+    if (m_setup)
+        m_setup(program.get());
+
+    std::string names;
+    for (auto &define : GetDefines(key))
+        names += names.empty() ? define : " " + define;
+    SPDLOG_INFO("program variant created: {}, {} [{}]", m_vertShaderFilename, m_fragShaderFilename, names);
+    return program.get();
+}
+
+std::vector<std::string> ProgramVariants::GetDefines(uint32_t key) const
+{
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < m_features.size(); i++)
+    {
+        if (key & (1u << i))
+            defines.push_back(m_features[i]);
+    }
+    return defines;
+}
+
+void ProgramVariants::Reload()
+{
+    for (auto it = m_variants.begin(); it != m_variants.end();)
+    {
+        // 실패했거나 아직 Get이 반환한 적 없는 (컴파일 중인) key는 지워서 다음 Get에서 새 소스로 만들게 함
+        if (!it->second || it->second->IsPending())
+        {
+            it = m_variants.erase(it);
+            continue;
+        }
+        m_reloading[it->first] = Program::Submit(m_vertShaderFilename, m_fragShaderFilename, GetDefines(it->first));
+        ++it;
+    }
+}
+
+int ProgramVariants::PollReload()
+{
+    for (auto it = m_reloading.begin(); it != m_reloading.end();)
+    {
+        auto &program = it->second;
+        if (program && !program->IsCompleted())
+        {
+            ++it;
+            continue;
+        }
+        // 실패하면 이전 program을 계속 씀 (에러 로그는 Finish에서 출력)
+        auto current = m_variants.find(it->first);
+        if (program && program->Finish() && current != m_variants.end() && current->second)
+        {
+            if (m_setup)
+                m_setup(program.get());
+            current->second->Swap(*program);
+            SPDLOG_INFO("program variant reloaded: {}, {}", m_vertShaderFilename, m_fragShaderFilename);
+        }
+        it = m_reloading.erase(it);
+    }
+    return (int)m_reloading.size();
+}
@@ -3,6 +3,40 @@
 
 #include "common.h"
 #include "shader.h"
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+// uniform 이름의 64bit FNV-1a hash. constexpr 변수로 만들면 컴파일 시간에 계산되고,
+// std::string이나 문자열 literal에서 암묵적으로 만들어져도 heap 할당은 없다.
+class UniformHandle
+{
+public:
+    constexpr UniformHandle(const char *name) : m_hash(Hash(name)) {}
+    UniformHandle(const std::string &name) : m_hash(Hash(name.c_str())) {}
+    constexpr uint64_t GetHash() const { return m_hash; }
+
+private:
+    static constexpr uint64_t Hash(const char *name)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        while (*name)
+        {
+            hash ^= (uint8_t)*name++;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+    uint64_t m_hash;
+};
+
+// 링크 때 찾아 둔 uniform 위치. 한 번 얻어서 저장해 두면 이후에는 찾는 비용도 없음
+struct UniformLocation
+{
+    int value{-1}; // 없는 uniform이면 -1 (glUniform*이 무시함)
+
+    bool IsValid() const { return value >= 0; }
+};
 
 // vertex shader 단계와 fragment shader 단계를 거치는 하나의 그래픽스 파이프라인을 프로그램이라고한다.
 CLASS_PTR(Program)
@@ -14,23 +48,107 @@ public:
                                                                       // std::vector<ShaderPtr> 타입으로 인자를 받음.(레퍼런스로 받아서 복사 x)
                                                                       // Shader 인스턴스는 다른 Program 인스턴스를 만드는 데 재사용할 수도 있음.
                                                                       // 따라서 shared pointer를 사용: ShaderPtr(메모리 소유권 공유)
-    static ProgramUPtr Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename);
+    // 두 shader 모두 Shader::Preprocess를 거침 (#include, defines)
+    static ProgramUPtr Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                              const std::vector<std::string> &defines = {});
+    // Create와 같지만 컴파일 / 링크를 driver에 요청만 하고 결과를 기다리지 않음 (binary 캐시에 있으면 바로 완료)
+    // IsCompleted()가 true가 된 뒤 Finish()가 성공해야 사용할 수 있음
+    static ProgramUPtr Submit(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                              const std::vector<std::string> &defines = {});
+    // GL_KHR_parallel_shader_compile이 있으면 driver가 여러 스레드에서 컴파일하고 완료 여부를 물어볼 수 있음
+    static bool IsParallelCompileSupported();
+
+    // 링크된 program binary를 저장해 둘 디렉토리. 비어 있으면 (기본값) 캐시를 쓰지 않음
+    // 캐시 키는 shader 소스와 GL_RENDERER / GL_VERSION의 hash라서 소스나 driver가 바뀌면 새로 컴파일한다.
+    static void SetBinaryCacheDirectory(const std::string &directory);
 
     ~Program();
     uint32_t Get() const { return m_program; }
     void Use() const;
-    void SetUniform(const std::string &name, int value) const;
-    void SetUniform(const std::string &name, float value) const;
-    void SetUniform(const std::string &name, const glm::vec2 &value) const;
-    void SetUniform(const std::string &name, const glm::vec3 &value) const;
-    void SetUniform(const std::string &name, const glm::vec4 &value) const;
-    void SetUniform(const std::string &name, const glm::mat4 &value) const;
+
+    bool IsPending() const { return m_pending != nullptr; } // Submit 후 아직 Finish하지 않음
+    bool IsCompleted() const; // 기다리지 않고 링크가 끝났는지 확인. 확장이 없으면 항상 true (Finish에서 기다림)
+    bool Finish();            // 링크 결과 확인, uniform reflection, binary 캐시 저장. 실패하면 false
+
+    // 다시 컴파일한 program과 GL object를 맞바꿈. 이 Program을 가리키는 포인터는 그대로 새 program을 쓰게 됨
+    // (uniform 값과 block binding은 새 program에 다시 설정해야 함)
+    void Swap(Program &other);
+
+    // 링크 때 모든 active uniform의 위치를 표로 만들어 두므로 driver에 묻지 않음
+    // 배열 uniform은 "name", "name[0]", "name[i]"가 모두 등록됨
+    UniformLocation GetUniformLocation(UniformHandle name) const;
+
+    void SetUniform(UniformLocation location, int value) const;
+    void SetUniform(UniformLocation location, float value) const;
+    void SetUniform(UniformLocation location, const glm::vec2 &value) const;
+    void SetUniform(UniformLocation location, const glm::vec3 &value) const;
+    void SetUniform(UniformLocation location, const glm::vec4 &value) const;
+    void SetUniform(UniformLocation location, const glm::mat4 &value) const;
+    void SetUniform(UniformLocation location, const glm::vec4 *values, int count) const; // 배열 uniform을 한 번에
+
+    template <typename T>
+    void SetUniform(UniformHandle name, const T &value) const { SetUniform(GetUniformLocation(name), value); }
+    void SetUniform(UniformHandle name, const glm::vec4 *values, int count) const { SetUniform(GetUniformLocation(name), values, count); }
+    void SetUniformBlockBinding(const std::string &blockName, uint32_t binding) const; // uniform block을 binding point에 연결
 
 private:
     Program() {}
     bool Link(const std::vector<ShaderPtr> &shaders); // 두 개의 shader를 입력받아서 프로그램을 링크
+    void SubmitLink(const std::vector<ShaderPtr> &shaders);
+    bool CheckLinkStatus(const std::vector<ShaderPtr> &shaders);
+    bool LoadBinary(const std::string &filename, uint64_t key); // 캐시에서 복원. driver가 거부하면 false
+    void SaveBinary(const std::string &filename, uint64_t key) const;
+
+    void ReflectUniforms();
 
     uint32_t m_program{0};
+    std::vector<std::pair<uint64_t, int>> m_uniforms; // (이름 hash, 위치), hash 순으로 정렬
+
+    // Submit 후 Finish까지 필요한 정보
+    struct PendingLink
+    {
+        std::vector<ShaderPtr> shaders; // 실패했을 때 컴파일 로그를 보기 위해 보관
+        std::string name;
+        std::string cacheFile; // 비어 있으면 캐시에 저장하지 않음
+        uint64_t cacheKey{0};
+        std::chrono::high_resolution_clock::time_point start;
+    };
+    std::unique_ptr<PendingLink> m_pending;
+};
+
+// 같은 shader 파일을 define 조합(permutation)마다 따로 컴파일한 program들
+// key의 i번째 bit가 켜져 있으면 features[i]를 define해서 컴파일하고, 처음 요청될 때 만든 뒤 계속 재사용
+// shader 안의 분기를 #ifdef로 바꾸면 fragment마다 조건을 검사하지 않고 컴파일 시간에 없어짐
+CLASS_PTR(ProgramVariants)
+class ProgramVariants
+{
+public:
+    // setup은 variant가 새로 만들어질 때마다 불림 (uniform block binding 등)
+    static ProgramVariantsUPtr Create(const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                                      std::vector<std::string> features,
+                                      std::function<void(const Program *)> setup = nullptr);
+
+    // 처음 요청된 key는 컴파일을 시작만 하고 끝날 때까지 nullptr를 반환 (그 동안 이전 variant로 그리면 됨)
+    const Program *Get(uint32_t key); // 컴파일 중이거나 실패하면 nullptr
+    int GetVariantCount() const { return (int)m_variants.size(); }
+
+    // 만들어진 variant를 모두 다시 컴파일. 끝날 때까지는 이전 program을 그대로 쓰고,
+    // PollReload()에서 완료된 것부터 Program::Swap으로 교체하므로 Get이 반환한 포인터는 계속 유효함
+    void Reload();
+    int PollReload(); // 아직 컴파일 중인 variant 수
+    const std::string &GetVertShaderFilename() const { return m_vertShaderFilename; }
+    const std::string &GetFragShaderFilename() const { return m_fragShaderFilename; }
+
+private:
+    ProgramVariants() {}
+    std::vector<std::string> GetDefines(uint32_t key) const;
+
+    std::string m_vertShaderFilename;
+    std::string m_fragShaderFilename;
+    std::vector<std::string> m_features;
+    std::function<void(const Program *)> m_setup;
+    std::unordered_map<uint32_t, ProgramUPtr> m_variants; // 실패한 key는 nullptr로 기억해서 다시 시도하지 않음
+    std::unordered_map<uint32_t, ProgramUPtr> m_reloading; // Reload()로 다시 컴파일 중인 variant
 };
 
 #endif // __PROGRAM_H__
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "program_compiler.h"
+
+ProgramCompilerUPtr ProgramCompiler::Create()
+{
+    // driver가 정한 만큼의 컴파일 스레드를 쓰도록 요청 (기본값이 0인 driver도 있음)
+    if (GLAD_GL_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    else if (GLAD_GL_ARB_parallel_shader_compile)
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    SPDLOG_INFO("parallel shader compile: {}", Program::IsParallelCompileSupported() ? "supported" : "not supported");
+    return ProgramCompilerUPtr(new ProgramCompiler());
+}
+
+void ProgramCompiler::Submit(ProgramUPtr *target, const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                             const std::vector<std::string> &defines,
+                             std::function<void(const Program *)> setup)
+{
+    target->reset();
+    auto program = Program::Submit(vertShaderFilename, fragShaderFilename, defines);
+    if (!program) // shader 파일을 읽지 못함
+    {
+        m_failedCount++;
+        return;
+    }
+    m_jobs.push_back({target, std::move(program), std::move(setup)});
+}
+
+int ProgramCompiler::Poll()
+{
+    // 뒤에서부터 검사해서 완료된 항목을 지워도 아직 검사하지 않은 항목의 위치가 바뀌지 않도록 함
+    for (size_t i = m_jobs.size(); i-- > 0;)
+    {
+        if (m_jobs[i].program->IsCompleted())
+            Complete(i);
+    }
+    return (int)m_jobs.size();
+}
+
+void ProgramCompiler::Finish()
+{
+    while (!m_jobs.empty())
+        Complete(m_jobs.size() - 1);
+}
+
+void ProgramCompiler::Complete(size_t index)
+{
+    auto job = std::move(m_jobs[index]);
+    m_jobs.erase(m_jobs.begin() + index);
+    if (!job.program->Finish())
+    {
+        m_failedCount++;
+        return;
+    }
+    if (job.setup)
+        job.setup(job.program.get());
+    *job.target = std::move(job.program);
+}
@@ -0,0 +1,42 @@
+#ifndef __PROGRAM_COMPILER_H__
+#define __PROGRAM_COMPILER_H__
+
+#include "common.h"
+#include "program.h"
+
+// 여러 program의 컴파일 / 링크를 먼저 모두 driver에 넘기고, 완료 여부는 프레임마다 확인
+// GL_KHR_parallel_shader_compile이 있으면 driver의 컴파일 스레드에서 나란히 진행되고 Poll()은 기다리지 않는다.
+// 확장이 없으면 첫 Poll()에서 결과를 기다리지만, 요청을 한꺼번에 넘긴 뒤라 driver가 겹쳐서 처리할 여지가 있음
+CLASS_PTR(ProgramCompiler)
+class ProgramCompiler
+{
+public:
+    static ProgramCompilerUPtr Create();
+
+    // 완료되면 setup을 부른 뒤 *target에 넣음. 그 전이나 실패하면 *target은 비어 있으므로
+    // 사용하는 쪽은 nullptr이면 fallback program으로 그리거나 건너뛴다. target은 ProgramCompiler보다 오래 살아야 함
+    void Submit(ProgramUPtr *target, const std::string &vertShaderFilename, const std::string &fragShaderFilename,
+                const std::vector<std::string> &defines = {},
+                std::function<void(const Program *)> setup = nullptr);
+
+    int Poll();    // 끝난 program을 target에 넣고 남은 개수를 반환. 프레임마다 호출
+    void Finish(); // 남은 program을 모두 기다림
+
+    int GetPendingCount() const { return (int)m_jobs.size(); }
+    int GetFailedCount() const { return m_failedCount; }
+
+private:
+    ProgramCompiler() {}
+    void Complete(size_t index); // m_jobs[index]의 결과를 확인해서 target에 넣고 목록에서 제거
+
+    struct Job
+    {
+        ProgramUPtr *target;
+        ProgramUPtr program;
+        std::function<void(const Program *)> setup;
+    };
+    std::vector<Job> m_jobs;
+    int m_failedCount{0};
+};
+
+#endif // __PROGRAM_COMPILER_H__
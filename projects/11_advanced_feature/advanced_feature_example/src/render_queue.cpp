@@ -0,0 +1,127 @@
+#include "render_queue.h"
+#include <algorithm>
+
+// key 배치 (상위 bit부터): pass 4 | program 12 | material 12 | mesh 12 | depth 24
+static const int kPassShift = 60;
+static const int kProgramShift = 48;
+static const int kMaterialShift = 36;
+static const int kMeshShift = 24;
+static const uint32_t kIdMask = 0xFFF;
+static const uint32_t kDepthMask = 0xFFFFFF;
+
+static constexpr UniformHandle kModelTransform("modelTransform");
+
+RenderQueueUPtr RenderQueue::Create()
+{
+    return RenderQueueUPtr(new RenderQueue());
+}
+
+void RenderQueue::Clear()
+{
+    m_packets.clear();
+    m_items.clear();
+    m_stats = {};
+
+    // 대기 중인 packet이 없는 프레임 경계에서만 번호를 다시 매김
+    // 지워진 object의 포인터도 여기서 정리되고, 절반을 비워 두므로 한 프레임에 새 object가 많이 들어와도 버팀
+    for (auto &ids : m_ids)
+    {
+        if (ids.size() >= kIdMask / 2)
+            ids.clear();
+    }
+}
+
+uint32_t RenderQueue::GetId(int type, const void *object)
+{
+    if (!object)
+        return 0;
+    auto &ids = m_ids[type];
+    auto found = ids.find(object);
+    if (found != ids.end())
+        return found->second;
+    // 프레임 도중에 번호가 모자라면 이미 key에 들어간 번호를 바꿀 수 없으므로 마지막 번호를 같이 씀
+    // Execute는 포인터를 비교하므로 정렬만 덜 모일 뿐 그리는 결과는 같음
+    if (ids.size() >= kIdMask - 1)
+        return kIdMask;
+    uint32_t id = (uint32_t)ids.size() + 1;
+    ids.emplace(object, id);
+    return id;
+}
+
+void RenderQueue::Submit(Pass pass, const Program *program, const Material *material, const Mesh *mesh,
+                         const glm::mat4 &transform, float depth)
+{
+    bool positionOnly = pass == DepthPrepass;
+    if (positionOnly)
+        material = nullptr;
+    uint64_t key = ((uint64_t)pass << kPassShift) |
+                   ((uint64_t)GetId(0, program) << kProgramShift) |
+                   ((uint64_t)GetId(1, material) << kMaterialShift) |
+                   ((uint64_t)GetId(2, mesh) << kMeshShift) |
+                   (uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * kDepthMask);
+    m_items.push_back({key, (uint32_t)m_packets.size()});
+    m_packets.push_back({program, material, mesh, transform, positionOnly});
+}
+
+void RenderQueue::Sort()
+{
+    // 8bit씩 LSD radix sort. 모든 key의 값이 같은 자리(대부분의 상위 id bit)는 건너뜀
+    m_scratch.resize(m_items.size());
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t counts[256] = {};
+        for (auto &item : m_items)
+            counts[(item.key >> shift) & 0xFF]++;
+        if (counts[(m_items.empty() ? 0 : (m_items[0].key >> shift) & 0xFF)] == m_items.size())
+            continue;
+        size_t offset = 0;
+        for (auto &count : counts)
+        {
+            size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (auto &item : m_items)
+            m_scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+        m_items.swap(m_scratch);
+    }
+}
+
+void RenderQueue::Execute(Pass pass)
+{
+    auto begin = std::lower_bound(m_items.begin(), m_items.end(), (uint64_t)pass << kPassShift,
+                                  [](const SortItem &item, uint64_t key)
+                                  { return item.key < key; });
+    const Program *program = nullptr;
+    const Material *material = nullptr;
+    const Mesh *mesh = nullptr;
+    for (auto it = begin; it != m_items.end() && (it->key >> kPassShift) == (uint64_t)pass; ++it)
+    {
+        auto &packet = m_packets[it->packet];
+        if (packet.program != program)
+        {
+            program = packet.program;
+            program->Use();
+            material = nullptr; // uniform은 program마다 따로이므로 material을 다시 설정
+            m_stats.programChanges++;
+        }
+        if (packet.material && packet.material != material)
+        {
+            material = packet.material;
+            material->SetToProgram(program);
+            m_stats.materialChanges++;
+        }
+        if (packet.mesh != mesh)
+        {
+            mesh = packet.mesh;
+            if (packet.positionOnly)
+                mesh->BindPositionOnly();
+            else
+                mesh->Bind();
+            m_stats.meshChanges++;
+        }
+        program->SetUniform(kModelTransform, packet.transform);
+        mesh->DrawCall();
+        m_stats.packets++;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef __RENDER_QUEUE_H__
+#define __RENDER_QUEUE_H__
+
+#include "common.h"
+#include "mesh.h"
+#include <unordered_map>
+
+// 프레임마다 draw packet을 모아서 64bit key로 정렬한 뒤 그리는 queue
+// key는 상위 bit부터 pass, program, material, mesh, depth 순서라서 정렬하면 상태가 같은 draw끼리 붙는다.
+// 실행할 때는 바로 앞 packet과 다른 상태만 바꾸므로 glUseProgram, texture, VAO 전환이 최소가 됨
+// packet은 포인터만 가지므로 program / material / mesh는 Execute까지 살아 있어야 함
+CLASS_PTR(RenderQueue)
+class RenderQueue
+{
+public:
+    enum Pass
+    {
+        DepthPrepass, // 위치만 그림. material은 key에서 빠짐
+        Opaque,
+        PassCount,
+    };
+    struct Stats
+    {
+        int packets{0};
+        int programChanges{0};
+        int materialChanges{0};
+        int meshChanges{0};
+    };
+
+    static RenderQueueUPtr Create();
+
+    void Clear(); // 프레임 시작에서 호출. packet과 통계를 비우고, 번호 표가 많이 찼으면 다시 매김
+    // depth는 0(가까움) ~ 1(멂). 같은 상태 안에서는 가까운 것부터 그려 early depth test가 잘 되게 함
+    // DepthPrepass는 mesh의 위치 전용 stream이 있어야 함 (Mesh::HasPositionStream)
+    void Submit(Pass pass, const Program *program, const Material *material, const Mesh *mesh,
+                const glm::mat4 &transform, float depth);
+    void Sort();             // Submit이 끝난 뒤 한 번
+    void Execute(Pass pass); // pass 사이의 상태 (color mask 등)는 호출하는 쪽에서 설정
+
+    int GetPacketCount() const { return (int)m_packets.size(); }
+    const Stats &GetStats() const { return m_stats; } // Clear 이후 Execute한 packet 기준
+
+private:
+    RenderQueue() {}
+    uint32_t GetId(int type, const void *object); // key에 넣을 작은 번호. nullptr은 0
+
+    struct Packet
+    {
+        const Program *program;
+        const Material *material;
+        const Mesh *mesh;
+        glm::mat4 transform;
+        bool positionOnly;
+    };
+    struct SortItem
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    std::vector<Packet> m_packets;
+    std::vector<SortItem> m_items;
+    std::vector<SortItem> m_scratch; // radix sort의 임시 공간
+    std::unordered_map<const void *, uint32_t> m_ids[3]; // program, material, mesh별 번호. 프레임이 바뀌어도 유지하고 Clear에서만 다시 매김
+    Stats m_stats;
+};
+
+#endif // __RENDER_QUEUE_H__
@@ -1,24 +1,127 @@
 #include "shader.h"
+#include <algorithm>
 
 ShaderUPtr Shader::CreateFromFile(const std::string &filename,
-                                  GLenum shaderType)
+                                  GLenum shaderType,
+                                  const std::vector<std::string> &defines)
 {
     // auto shader = std::unique_ptr<Shader>(new Shader());
     auto shader = ShaderUPtr(new Shader()); // 위와 동일
 
-    if (!shader->LoadFile(filename, shaderType)) // shader파일을 로드하는데 실패하면
+    if (!shader->LoadFile(filename, shaderType, defines)) // shader파일을 로드하는데 실패하면
         return nullptr;                          // 함수 종료 시 nullptr 리턴, 그리고 shader 포인터 해제
     return std::move(shader);                    // shader 파일을 로드하는데 성공하면 shader 포인터가 가리키는 메모리에 대한 소유권 이전
 }
 
-bool Shader::LoadFile(const std::string &filename, GLenum shaderType)
+static const int kMaxIncludeDepth = 16; // 서로 포함하는 파일을 끝없이 펼치지 않도록
+
+// filename의 내용을 out에 붙임. #include는 재귀적으로 펼치고 뒤에 #line으로 원래 위치를 되돌림
+static bool AppendSource(const std::string &filename, const std::vector<std::string> &defines,
+                         std::vector<std::string> &files, std::string &out, int depth)
+{
+    if (depth > kMaxIncludeDepth)
+    {
+        SPDLOG_ERROR("shader include too deep: {}", filename);
+        return false;
+    }
+    auto text = LoadTextFile(filename);
+    if (!text)
+        return false;
+    int sourceIndex = (int)files.size();
+    files.push_back(filename);
+    auto directory = filename.substr(0, filename.find_last_of('/') + 1);
+
+    size_t begin = 0;
+    int lineNumber = 0;
+    while (begin < text->size())
+    {
+        size_t end = text->find('\n', begin);
+        if (end == std::string::npos)
+            end = text->size();
+        auto line = text->substr(begin, end - begin);
+        begin = end + 1;
+        lineNumber++;
+
+        auto first = line.find_first_not_of(" \t");
+        if (first != std::string::npos && line.compare(first, 8, "#include") == 0)
+        {
+            auto open = line.find('"', first + 8);
+            auto close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                SPDLOG_ERROR("invalid #include in {}({}): {}", filename, lineNumber, line);
+                return false;
+            }
+            auto path = directory + line.substr(open + 1, close - open - 1);
+            if (std::find(files.begin(), files.end(), path) == files.end())
+            {
+                out += fmt::format("#line 1 {}\n", files.size());
+                if (!AppendSource(path, {}, files, out, depth + 1))
+                {
+                    SPDLOG_ERROR("included from {}({})", filename, lineNumber);
+                    return false;
+                }
+            }
+            out += fmt::format("#line {} {}\n", lineNumber + 1, sourceIndex);
+            continue;
+        }
+
+        out += line;
+        out += '\n';
+        // #version은 맨 처음에 와야 하므로 define은 그 뒤에 넣음
+        if (depth == 0 && first != std::string::npos && line.compare(first, 8, "#version") == 0 && !defines.empty())
+        {
+            for (auto &define : defines)
+                out += fmt::format("#define {}\n", define);
+            out += fmt::format("#line {} {}\n", lineNumber + 1, sourceIndex);
+        }
+    }
+    return true;
+}
+
+std::optional<std::string> Shader::Preprocess(const std::string &filename, const std::vector<std::string> &defines,
+                                              std::vector<std::string> *files)
 {
-    auto result = LoadTextFile(filename); // optional의 값은 있을 수도 없을 수도 었다.
+    std::vector<std::string> sourceFiles;
+    std::string source;
+    if (!AppendSource(filename, defines, sourceFiles, source, 0))
+        return {};
+    if (files)
+        *files = std::move(sourceFiles);
+    return source;
+}
+
+ShaderUPtr Shader::CreateFromSource(const std::string &code, GLenum shaderType, const std::string &name)
+{
+    auto shader = ShaderUPtr(new Shader());
+    shader->Submit(code, shaderType, name);
+    if (!shader->CheckCompileStatus())
+        return nullptr;
+    return std::move(shader);
+}
+
+ShaderUPtr Shader::SubmitSource(const std::string &code, GLenum shaderType, const std::string &name)
+{
+    auto shader = ShaderUPtr(new Shader());
+    shader->Submit(code, shaderType, name);
+    return std::move(shader);
+}
+
+bool Shader::LoadFile(const std::string &filename, GLenum shaderType, const std::vector<std::string> &defines)
+{
+    auto result = Preprocess(filename, defines); // optional의 값은 있을 수도 없을 수도 었다.
     if (!result.has_value())              // optional의 값이 있는지 체크
         return false;                     // 파일을 못 읽었으니 false 리턴.
 
     auto &code = result.value(); // 레퍼런스 쓰는이유: string code = result.value(); 를 사용하게 되면 메모리 복사가 이루어짐.
                                  // 메모리를 복사할 필요가없음. 이 함수 종료시까지 result가 존재하기 때문. 반환은 bool 이기때문.
+    Submit(code, shaderType, filename);
+    return CheckCompileStatus();
+}
+
+void Shader::Submit(const std::string &code, GLenum shaderType, const std::string &name)
+{
+    m_name = name;
     const char *codePtr = code.c_str();
     int32_t codeLength = (int32_t)code.length(); // int32_t 는 그냥 int. 32비트(4bytes) 정수형.
 
@@ -26,7 +129,11 @@ bool Shader::LoadFile(const std::string &filename, GLenum shaderType)
     m_shader = glCreateShader(shaderType);                                     // glCreateShader()는 정수를 반환
     glShaderSource(m_shader, 1, (const GLchar *const *)&codePtr, &codeLength); // 첫 번째 shader id, 두 번째 인자는 코드의 개수, 3번째인자는 코드 배열, 4번째 인자는 코드 글자수 배열
     glCompileShader(m_shader);                                                 // shader 소스들을 컴파이르
+    // 결과를 바로 묻지 않으면 driver가 다른 스레드에서 컴파일하는 동안 다음 작업을 할 수 있음
+}
 
+bool Shader::CheckCompileStatus() const
+{
     // check compile error
     int success = 0;
     glGetShaderiv(m_shader, GL_COMPILE_STATUS, &success); // glGetShaderiv는 shader 정보를 가져온다. 두번째 인자에 shader의 컴파일 상태를 넣어줘서 컴파일 상태에 대한 정보를 가져와서 success에 넣어준다.
@@ -35,7 +142,7 @@ bool Shader::LoadFile(const std::string &filename, GLenum shaderType)
     {
         char infoLog[1024];                                   // 얻어올 정보의 크기 1024
         glGetShaderInfoLog(m_shader, 1024, nullptr, infoLog); // 로그 정보를 가져온다.
-        SPDLOG_ERROR("failed to compile shader: \"{}\"", filename);
+        SPDLOG_ERROR("failed to compile shader: \"{}\"", m_name);
         SPDLOG_ERROR("reason: {}", infoLog); // 컴파일 쉐이더 이유 출력
         return false;
     }
@@ -8,16 +8,31 @@ class Shader
 {
 public:
     static ShaderUPtr CreateFromFile(const std::string &filename,
-                                     GLenum shaderType);
+                                     GLenum shaderType,
+                                     const std::vector<std::string> &defines = {});
+    static ShaderUPtr CreateFromSource(const std::string &code, GLenum shaderType, const std::string &name); // name은 에러 로그용
+    // 컴파일을 driver에 요청만 하고 결과를 기다리지 않음. 결과는 CheckCompileStatus()로 확인
+    // (program 링크 결과를 먼저 확인하고, 실패했을 때만 원인을 찾는 데 씀)
+    static ShaderUPtr SubmitSource(const std::string &code, GLenum shaderType, const std::string &name);
+
+    // #include "경로" (포함하는 파일 기준 상대 경로, 같은 파일은 한 번만)를 펼치고
+    // #version 바로 다음 줄에 defines를 "#define <define>"으로 넣은 소스를 반환
+    // 포함된 파일은 #line의 source 번호로 구분됨 (0이 filename, 이후 포함된 순서)
+    // files가 있으면 읽은 파일 목록을 같은 순서로 채움 (hot reload에서 어떤 파일에 의존하는지 알기 위해)
+    static std::optional<std::string> Preprocess(const std::string &filename, const std::vector<std::string> &defines,
+                                                 std::vector<std::string> *files = nullptr);
     // Shader shader = new Shader(); 에러. 생성자가 Private이라 접근 불가
     // ShaderUPtr shader = Shader::CreateFromFile("shader/simple.vs", GL_VERTEX_SHADER); 방식으로만 쉐이더 생성 가능.
     ~Shader();
     uint32_t Get() const { return m_shader; } // Get()은 있는데 Set()는 없는 이유: shader 오브젝트의 생성 관리는 Shader 내부에서만 관리
+    bool CheckCompileStatus() const; // 실패했으면 로그를 출력하고 false
 
 private:
     Shader() {}                                                    // 생성자가 private인 이유: CreateFromFile() 함수 외에 다른 방식의 Shader 인스턴스 생성을 막기 위해서
-    bool LoadFile(const std::string &filename, GLenum shaderType); // LoadFile()이 bool을 리턴하는 이유: 생성에 실패할 경우 false를 리턴하기 위해서
+    bool LoadFile(const std::string &filename, GLenum shaderType, const std::vector<std::string> &defines); // LoadFile()이 bool을 리턴하는 이유: 생성에 실패할 경우 false를 리턴하기 위해서
+    void Submit(const std::string &code, GLenum shaderType, const std::string &name);
     uint32_t m_shader{0};
+    std::string m_name; // 에러 로그용
 };
 
 #endif // __SHADER_H__
\ No newline at end of file
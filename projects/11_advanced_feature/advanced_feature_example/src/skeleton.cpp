@@ -0,0 +1,110 @@
+#include "skeleton.h"
+#include <algorithm>
+#include <cmath>
+
+SkeletonUPtr Skeleton::Create(std::vector<SkeletonNode> nodes, std::vector<SkeletonBone> bones)
+{
+    auto skeleton = SkeletonUPtr(new Skeleton());
+    skeleton->m_nodes = std::move(nodes);
+    skeleton->m_bones = std::move(bones);
+    if (!skeleton->m_nodes.empty())
+        skeleton->m_globalInverse = glm::inverse(skeleton->m_nodes[0].localTransform);
+    return std::move(skeleton);
+}
+
+int Skeleton::FindNode(const std::string &name) const
+{
+    for (int i = 0; i < (int)m_nodes.size(); i++)
+    {
+        if (m_nodes[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+void Skeleton::ComputePalette(const glm::mat4 *localTransforms, glm::mat4 *palette) const
+{
+    m_globals.resize(m_nodes.size());
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        int parent = m_nodes[i].parent;
+        m_globals[i] = parent < 0 ? localTransforms[i] : m_globals[parent] * localTransforms[i];
+    }
+    for (size_t i = 0; i < m_bones.size(); i++)
+        palette[i] = m_globalInverse * m_globals[m_bones[i].node] * m_bones[i].offset;
+}
+
+AnimationUPtr Animation::Create(const std::string &name, float duration, float ticksPerSecond, std::vector<AnimationChannel> channels)
+{
+    auto animation = AnimationUPtr(new Animation());
+    animation->m_name = name;
+    animation->m_duration = duration;
+    animation->m_ticksPerSecond = ticksPerSecond > 0.0f ? ticksPerSecond : 25.0f; // assimp는 값이 없으면 0
+    animation->m_channels = std::move(channels);
+    return std::move(animation);
+}
+
+// time 직전 키의 인덱스와 다음 키까지의 보간 비율
+template <typename T>
+static size_t FindKey(const std::vector<AnimationKey<T>> &keys, float time, float &factor)
+{
+    auto next = std::upper_bound(keys.begin(), keys.end(), time,
+                                 [](float t, const AnimationKey<T> &key)
+                                 { return t < key.time; });
+    if (next == keys.begin())
+    {
+        factor = 0.0f;
+        return 0;
+    }
+    size_t index = (size_t)(next - keys.begin()) - 1;
+    if (index + 1 >= keys.size())
+    {
+        factor = 0.0f;
+        return index;
+    }
+    float span = keys[index + 1].time - keys[index].time;
+    factor = span > 0.0f ? (time - keys[index].time) / span : 0.0f;
+    return index;
+}
+
+static glm::vec3 SampleVec3(const std::vector<AnimationKey<glm::vec3>> &keys, float time, const glm::vec3 &defaultValue)
+{
+    if (keys.empty())
+        return defaultValue;
+    float factor;
+    size_t index = FindKey(keys, time, factor);
+    if (factor == 0.0f)
+        return keys[index].value;
+    return glm::mix(keys[index].value, keys[index + 1].value, factor);
+}
+
+static glm::quat SampleQuat(const std::vector<AnimationKey<glm::quat>> &keys, float time)
+{
+    if (keys.empty())
+        return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    float factor;
+    size_t index = FindKey(keys, time, factor);
+    if (factor == 0.0f)
+        return keys[index].value;
+    return glm::slerp(keys[index].value, keys[index + 1].value, factor);
+}
+
+void Animation::Evaluate(float time, const Skeleton &skeleton, std::vector<glm::mat4> &localTransforms) const
+{
+    auto &nodes = skeleton.GetNodes();
+    localTransforms.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++)
+        localTransforms[i] = nodes[i].localTransform;
+
+    float ticks = m_duration > 0.0f ? std::fmod(time * m_ticksPerSecond, m_duration) : 0.0f;
+    for (auto &channel : m_channels)
+    {
+        // channel은 TRS를 통째로 대체 (키가 없는 성분은 identity)
+        auto position = SampleVec3(channel.positions, ticks, glm::vec3(0.0f));
+        auto rotation = SampleQuat(channel.rotations, ticks);
+        auto scale = SampleVec3(channel.scales, ticks, glm::vec3(1.0f));
+        localTransforms[channel.node] = glm::translate(glm::mat4(1.0f), position) *
+                                        glm::mat4_cast(rotation) *
+                                        glm::scale(glm::mat4(1.0f), scale);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef __SKELETON_H__
+#define __SKELETON_H__
+
+#include "common.h"
+#include <glm/gtc/quaternion.hpp>
+
+// node 계층. 부모가 항상 자식보다 앞에 오도록 정렬되어 있어서 한 번의 순회로 global transform을 구할 수 있다.
+struct SkeletonNode
+{
+    std::string name;
+    int parent{-1};
+    glm::mat4 localTransform{glm::mat4(1.0f)}; // 애니메이션 channel이 없을 때 쓰는 bind pose
+};
+
+// 정점에 영향을 주는 node. offset은 mesh space -> bone space (inverse bind matrix)
+struct SkeletonBone
+{
+    int node;
+    glm::mat4 offset;
+};
+
+CLASS_PTR(Skeleton)
+class Skeleton
+{
+public:
+    static SkeletonUPtr Create(std::vector<SkeletonNode> nodes, std::vector<SkeletonBone> bones);
+
+    const std::vector<SkeletonNode> &GetNodes() const { return m_nodes; }
+    const std::vector<SkeletonBone> &GetBones() const { return m_bones; }
+    int GetBoneCount() const { return (int)m_bones.size(); }
+    int FindNode(const std::string &name) const; // 없으면 -1
+
+    // node별 local transform으로 bone palette(skinning 행렬) 계산. palette는 bone 수만큼 기록
+    void ComputePalette(const glm::mat4 *localTransforms, glm::mat4 *palette) const;
+
+private:
+    Skeleton() {}
+
+    std::vector<SkeletonNode> m_nodes;
+    std::vector<SkeletonBone> m_bones;
+    glm::mat4 m_globalInverse{glm::mat4(1.0f)}; // root transform의 역행렬, 모델 전체의 배치는 palette에서 빼낸다.
+    mutable std::vector<glm::mat4> m_globals;    // ComputePalette 작업 공간
+};
+
+template <typename T>
+struct AnimationKey
+{
+    float time; // tick 단위
+    T value;
+};
+
+// node 하나의 키프레임들
+struct AnimationChannel
+{
+    int node;
+    std::vector<AnimationKey<glm::vec3>> positions;
+    std::vector<AnimationKey<glm::quat>> rotations;
+    std::vector<AnimationKey<glm::vec3>> scales;
+};
+
+CLASS_PTR(Animation)
+class Animation
+{
+public:
+    static AnimationUPtr Create(const std::string &name, float duration, float ticksPerSecond, std::vector<AnimationChannel> channels);
+
+    const std::string &GetName() const { return m_name; }
+    float GetDuration() const { return m_duration / m_ticksPerSecond; } // 초 단위
+
+    // time(초)의 pose를 계산해서 localTransforms(node 수만큼)에 기록. 클립은 반복 재생
+    void Evaluate(float time, const Skeleton &skeleton, std::vector<glm::mat4> &localTransforms) const;
+
+private:
+    Animation() {}
+
+    std::string m_name;
+    float m_duration{0.0f}; // tick 단위
+    float m_ticksPerSecond{25.0f};
+    std::vector<AnimationChannel> m_channels;
+};
+
+#endif // __SKELETON_H__
@@ -0,0 +1,212 @@
+#include "skinning.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define SKINNING_USE_SSE
+#endif
+
+static const size_t kMinVerticesPerTask = 8192; // 이보다 작게 나누면 스레드 시작 비용이 더 큼
+
+void SkinnedVertex::AddBoneWeight(int boneId, float weight)
+{
+    int slot = 0;
+    for (int i = 1; i < 4; i++)
+    {
+        if (boneWeights[i] < boneWeights[slot])
+            slot = i;
+    }
+    if (weight > boneWeights[slot])
+    {
+        boneIds[slot] = boneId;
+        boneWeights[slot] = weight;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// bone palette
+
+BonePaletteBufferUPtr BonePaletteBuffer::Create(int boneCount)
+{
+    auto buffer = BonePaletteBufferUPtr(new BonePaletteBuffer());
+    if (!buffer->Init(boneCount))
+        return nullptr;
+    return std::move(buffer);
+}
+
+bool BonePaletteBuffer::Init(int boneCount)
+{
+    if (boneCount <= 0 || boneCount > kMaxBones)
+    {
+        SPDLOG_ERROR("bone count {} exceeds gpu skinning limit {}", boneCount, kMaxBones);
+        return false;
+    }
+    int alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    // shader의 BonePalette block은 항상 kMaxBones개이므로 bone 수와 상관없이 block 크기 전체를 구간으로 잡음
+    // (바인딩한 구간이 GL_UNIFORM_BLOCK_DATA_SIZE보다 작으면 결과가 정의되지 않음)
+    size_t size = sizeof(glm::mat4) * kMaxBones;
+    m_boneCount = boneCount;
+    m_stride = (size + alignment - 1) / alignment * alignment;
+    m_buffer = Buffer::CreateWithData(GL_UNIFORM_BUFFER, GL_STREAM_DRAW, nullptr, m_stride, 0);
+    return m_buffer != nullptr;
+}
+
+void BonePaletteBuffer::Upload(const glm::mat4 *palettes, int characterCount)
+{
+    m_staging.resize(m_stride * characterCount);
+    for (int i = 0; i < characterCount; i++)
+        memcpy(&m_staging[m_stride * i], palettes + (size_t)i * m_boneCount, sizeof(glm::mat4) * m_boneCount);
+    m_buffer->SetData(m_staging.data(), m_stride, characterCount);
+}
+
+void BonePaletteBuffer::Bind(int character) const
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, kBonePaletteBinding, m_buffer->Get(),
+                      m_stride * character, sizeof(glm::mat4) * kMaxBones);
+}
+
+// ---------------------------------------------------------------------------------------
+// skinned mesh
+
+SkinnedMeshUPtr SkinnedMesh::Create(const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    auto mesh = SkinnedMeshUPtr(new SkinnedMesh());
+    mesh->Init(vertices, indices);
+    return std::move(mesh);
+}
+
+void SkinnedMesh::Init(const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices)
+{
+    m_vertices = vertices;
+    m_indexCount = indices.size();
+    for (auto &vertex : vertices)
+        m_aabb.Expand(vertex.position);
+
+    // GPU 경로: bone id는 location 7(ivec4), weight는 location 8 (3~6은 인스턴스 transform)
+    m_vertexLayout = VertexLayout::Create();
+    m_vertexBuffer = Buffer::CreateWithData(
+        GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+        vertices.data(), sizeof(SkinnedVertex), vertices.size());
+    m_indexBuffer = Buffer::CreateWithData(
+        GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+        indices.data(), sizeof(uint32_t), indices.size());
+    uint32_t vertexBuffer = m_vertexBuffer->Get();
+    m_vertexLayout->SetAttrib(0, vertexBuffer, 3, GL_FLOAT, false, sizeof(SkinnedVertex), offsetof(SkinnedVertex, position));
+    m_vertexLayout->SetAttrib(1, vertexBuffer, 3, GL_FLOAT, false, sizeof(SkinnedVertex), offsetof(SkinnedVertex, normal));
+    m_vertexLayout->SetAttrib(2, vertexBuffer, 2, GL_FLOAT, false, sizeof(SkinnedVertex), offsetof(SkinnedVertex, texCoord));
+    m_vertexLayout->SetAttribI(7, vertexBuffer, 4, GL_INT, sizeof(SkinnedVertex), offsetof(SkinnedVertex, boneIds));
+    m_vertexLayout->SetAttrib(8, vertexBuffer, 4, GL_FLOAT, false, sizeof(SkinnedVertex), offsetof(SkinnedVertex, boneWeights));
+    m_vertexLayout->SetIndexBuffer(m_indexBuffer->Get());
+
+    // CPU 경로: skinning 결과를 담을 buffer는 SkinOnCpu에서 크기를 정함. index buffer는 공유
+    m_cpuVertexLayout = VertexLayout::Create();
+    m_cpuVertexBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STREAM_DRAW, nullptr, sizeof(Vertex), 0);
+    uint32_t cpuVertexBuffer = m_cpuVertexBuffer->Get();
+    m_cpuVertexLayout->SetAttrib(0, cpuVertexBuffer, 3, GL_FLOAT, false, sizeof(Vertex), 0);
+    m_cpuVertexLayout->SetAttrib(1, cpuVertexBuffer, 3, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, normal));
+    m_cpuVertexLayout->SetAttrib(2, cpuVertexBuffer, 2, GL_FLOAT, false, sizeof(Vertex), offsetof(Vertex, texCoord));
+    m_cpuVertexLayout->SetIndexBuffer(m_indexBuffer->Get());
+    GlState::Get().BindVertexArray(0);
+}
+
+void SkinnedMesh::DrawGpu(const Program *program) const
+{
+    m_vertexLayout->Bind();
+    if (m_material)
+        m_material->SetToProgram(program);
+    glDrawElements(GL_TRIANGLES, (GLsizei)m_indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void SkinnedMesh::SkinOnCpu(const glm::mat4 *palettes, int boneCount, int characterCount)
+{
+    size_t vertexCount = m_vertices.size();
+    size_t total = vertexCount * characterCount;
+    m_skinned.resize(total);
+
+    // (캐릭터, 정점)을 하나의 구간으로 보고 스레드 수만큼 나눔
+    auto Skin = [&](size_t begin, size_t end)
+    {
+        while (begin < end)
+        {
+            size_t character = begin / vertexCount;
+            size_t vertex = begin % vertexCount;
+            size_t count = std::min(end - begin, vertexCount - vertex);
+            SkinVertices(&m_vertices[vertex], count, palettes + character * boneCount, &m_skinned[begin]);
+            begin += count;
+        }
+    };
+    size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t taskCount = std::max<size_t>(std::min(threadCount, total / kMinVerticesPerTask), 1);
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < taskCount; i++)
+        tasks.push_back(std::async(std::launch::async, Skin, total * i / taskCount, total * (i + 1) / taskCount));
+    Skin(0, total / taskCount);
+    for (auto &task : tasks)
+        task.wait();
+
+    m_cpuVertexBuffer->SetData(m_skinned.data(), sizeof(Vertex), total);
+}
+
+void SkinnedMesh::DrawCpu(const Program *program, int character) const
+{
+    m_cpuVertexLayout->Bind();
+    if (m_material)
+        m_material->SetToProgram(program);
+    // 캐릭터마다 buffer 안의 자기 구간을 base vertex로 지정
+    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)m_indexCount, GL_UNSIGNED_INT, 0, (GLint)(character * m_vertices.size()));
+}
+
+// ---------------------------------------------------------------------------------------
+
+void SkinVertices(const SkinnedVertex *src, size_t count, const glm::mat4 *palette, Vertex *dst)
+{
+#if defined(SKINNING_USE_SSE)
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &v = src[i];
+        // 4개 bone 행렬을 weight로 섞은 행렬의 열 4개
+        __m128 columns[4];
+        for (int b = 0; b < 4; b++)
+        {
+            auto m = glm::value_ptr(palette[v.boneIds[b]]);
+            __m128 w = _mm_set1_ps(v.boneWeights[b]);
+            for (int c = 0; c < 4; c++)
+            {
+                __m128 column = _mm_mul_ps(_mm_loadu_ps(m + c * 4), w);
+                columns[c] = b == 0 ? column : _mm_add_ps(columns[c], column);
+            }
+        }
+        __m128 position = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(v.position.x)), _mm_mul_ps(columns[1], _mm_set1_ps(v.position.y))),
+            _mm_add_ps(_mm_mul_ps(columns[2], _mm_set1_ps(v.position.z)), columns[3]));
+        __m128 normal = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(v.normal.x)), _mm_mul_ps(columns[1], _mm_set1_ps(v.normal.y))),
+            _mm_mul_ps(columns[2], _mm_set1_ps(v.normal.z)));
+
+        // Vertex는 position(3) normal(3) texCoord(2)의 8 float. normal을 겹쳐 써서 position의 w를 덮음
+        float out[8];
+        _mm_storeu_ps(out, position);
+        _mm_storeu_ps(out + 3, normal);
+        out[6] = v.texCoord.x;
+        out[7] = v.texCoord.y;
+        memcpy(&dst[i], out, sizeof(Vertex));
+    }
+#else
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &v = src[i];
+        glm::mat4 m = palette[v.boneIds[0]] * v.boneWeights[0] +
+                      palette[v.boneIds[1]] * v.boneWeights[1] +
+                      palette[v.boneIds[2]] * v.boneWeights[2] +
+                      palette[v.boneIds[3]] * v.boneWeights[3];
+        dst[i].position = glm::vec3(m * glm::vec4(v.position, 1.0f));
+        dst[i].normal = glm::vec3(m * glm::vec4(v.normal, 0.0f));
+        dst[i].texCoord = v.texCoord;
+    }
+#endif
+}
@@ -0,0 +1,85 @@
+#ifndef __SKINNING_H__
+#define __SKINNING_H__
+
+#include "common.h"
+#include "mesh.h"
+
+static const int kMaxBones = 128;              // skinning.vs의 BonePalette 배열 크기와 같아야 함
+static const uint32_t kBonePaletteBinding = 0; // BonePalette uniform block의 binding point (1, 2는 frame_uniforms.h)
+
+// bone 영향을 받는 정점. 영향이 없는 슬롯은 weight 0
+struct SkinnedVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+    glm::ivec4 boneIds{glm::ivec4(0)};
+    glm::vec4 boneWeights{glm::vec4(0.0f)};
+
+    void AddBoneWeight(int boneId, float weight); // 4개가 차면 가장 작은 weight를 대체
+};
+
+// 여러 캐릭터의 bone palette를 한 UBO에 모아 프레임마다 한 번만 올린다.
+// 캐릭터마다 glBindBufferRange로 자기 구간만 BonePalette block에 연결해서 그림
+CLASS_PTR(BonePaletteBuffer)
+class BonePaletteBuffer
+{
+public:
+    static BonePaletteBufferUPtr Create(int boneCount);
+
+    // palettes: characterCount * boneCount개의 행렬이 캐릭터 순서로 연속
+    void Upload(const glm::mat4 *palettes, int characterCount);
+    void Bind(int character) const;
+
+private:
+    BonePaletteBuffer() {}
+    bool Init(int boneCount);
+
+    BufferUPtr m_buffer;
+    int m_boneCount{0};
+    size_t m_stride{0};               // 캐릭터 하나의 구간 크기 (kMaxBones개 mat4를 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 배수로 올림)
+    std::vector<uint8_t> m_staging;   // 정렬 패딩을 넣어서 모은 palette
+};
+
+// bone 애니메이션 mesh. 두 가지 skinning 경로를 제공
+// - GPU: 정점에 bone id / weight를 싣고 skinning.vs에서 palette로 변환
+// - CPU: 여러 스레드에서 SIMD로 변환한 결과(Vertex)를 dynamic buffer에 캐릭터별로 이어 붙여 올리고 lighting.vs로 그림
+CLASS_PTR(SkinnedMesh)
+class SkinnedMesh
+{
+public:
+    static SkinnedMeshUPtr Create(const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices);
+
+    void SetMaterial(MaterialPtr material) { m_material = material; }
+    MaterialPtr GetMaterial() const { return m_material; }
+    const AABB &GetAABB() const { return m_aabb; } // bind pose 기준
+    size_t GetVertexCount() const { return m_vertices.size(); }
+
+    void DrawGpu(const Program *program) const; // BonePaletteBuffer::Bind로 palette를 미리 연결해 둘 것
+
+    // palettes: characterCount * boneCount개. CPU에서 skinning한 뒤 한 번에 업로드
+    void SkinOnCpu(const glm::mat4 *palettes, int boneCount, int characterCount);
+    void DrawCpu(const Program *program, int character) const;
+
+private:
+    SkinnedMesh() {}
+    void Init(const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices);
+
+    std::vector<SkinnedVertex> m_vertices; // CPU skinning 입력
+    std::vector<Vertex> m_skinned;         // CPU skinning 결과 (캐릭터 수 * 정점 수)
+    size_t m_indexCount{0};
+    AABB m_aabb;
+
+    BufferPtr m_indexBuffer; // 두 경로가 공유
+    BufferUPtr m_vertexBuffer;
+    VertexLayoutUPtr m_vertexLayout;
+    BufferUPtr m_cpuVertexBuffer;
+    VertexLayoutUPtr m_cpuVertexLayout;
+
+    MaterialPtr m_material;
+};
+
+// count개의 정점을 palette로 변환 (SSE가 있으면 4x4 행렬 블렌딩을 SIMD로)
+void SkinVertices(const SkinnedVertex *src, size_t count, const glm::mat4 *palette, Vertex *dst);
+
+#endif // __SKINNING_H__
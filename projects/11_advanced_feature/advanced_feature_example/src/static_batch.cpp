@@ -0,0 +1,135 @@
+#include "static_batch.h"
+#include <algorithm>
+#include <chrono>
+
+StaticBatchUPtr StaticBatch::Create()
+{
+    return StaticBatchUPtr(new StaticBatch());
+}
+
+int StaticBatch::Add(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+                     const glm::mat4 &transform, MaterialPtr material)
+{
+    auto it = std::find_if(m_batches.begin(), m_batches.end(),
+                           [&](const Batch &batch)
+                           { return batch.material == material; });
+    if (it == m_batches.end())
+    {
+        m_batches.emplace_back();
+        it = m_batches.end() - 1;
+        it->material = material;
+    }
+    auto &batch = *it;
+
+    // normal은 non-uniform scale을 고려해서 inverse transpose로 변환
+    auto normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+    auto baseVertex = (uint32_t)batch.vertices.size();
+    for (auto &vertex : vertices)
+    {
+        batch.vertices.push_back({glm::vec3(transform * glm::vec4(vertex.position, 1.0f)),
+                                  glm::normalize(normalTransform * vertex.normal),
+                                  vertex.texCoord});
+        batch.aabb.Expand(batch.vertices.back().position);
+    }
+    for (auto index : indices)
+        batch.indices.push_back(baseVertex + index);
+    batch.dirty = true;
+    return m_objectCount++;
+}
+
+void StaticBatch::Build()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    m_lastRebuildCount = 0;
+    for (auto &batch : m_batches)
+    {
+        if (!batch.dirty)
+            continue;
+        Upload(batch);
+        batch.dirty = false;
+        m_lastRebuildCount++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastBuildTime = std::chrono::duration<float, std::milli>(end - start).count();
+    if (m_lastRebuildCount > 0)
+    {
+        SPDLOG_INFO("static batch built: #object: {}, #batch: {}, rebuilt {} in {:.3f} ms",
+                    m_objectCount, m_batches.size(), m_lastRebuildCount, m_lastBuildTime);
+    }
+}
+
+void StaticBatch::Upload(Batch &batch)
+{
+    auto vertexCount = batch.vertices.size();
+    auto indexCount = batch.indices.size();
+    if (!batch.mesh || vertexCount > batch.vertexCapacity || indexCount > batch.indexCapacity)
+    {
+        // 오브젝트를 하나씩 추가해도 재할당이 log 번만 일어나도록 capacity를 2배씩 늘림
+        batch.vertexCapacity = std::max(vertexCount, batch.vertexCapacity * 2);
+        batch.indexCapacity = std::max(indexCount, batch.indexCapacity * 2);
+        batch.vertexBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+                                                    nullptr, sizeof(Vertex), batch.vertexCapacity);
+        batch.indexBuffer = Buffer::CreateWithData(GL_ELEMENT_ARRAY_BUFFER, GL_STATIC_DRAW,
+                                                   nullptr, sizeof(uint32_t), batch.indexCapacity);
+        batch.positionBuffer = Buffer::CreateWithData(GL_ARRAY_BUFFER, GL_STATIC_DRAW,
+                                                      nullptr, sizeof(glm::vec3), batch.vertexCapacity);
+        BoundingSphere sphere;
+        sphere.center = batch.aabb.GetCenter();
+        sphere.radius = glm::length(batch.aabb.max - batch.aabb.min) * 0.5f;
+        batch.mesh = Mesh::CreateWithBuffers(batch.vertexBuffer, batch.indexBuffer, batch.positionBuffer,
+                                             batch.aabb, sphere, GL_TRIANGLES);
+        batch.mesh->SetMaterial(batch.material);
+        batch.uploadedVertices = 0;
+        batch.uploadedIndices = 0;
+    }
+
+    // 지난 Build 이후 붙은 구간만 올림
+    auto firstVertex = batch.uploadedVertices;
+    if (vertexCount > firstVertex)
+    {
+        batch.vertexBuffer->SetSubData(firstVertex * sizeof(Vertex), batch.vertices.data() + firstVertex,
+                                       (vertexCount - firstVertex) * sizeof(Vertex));
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertexCount - firstVertex);
+        for (size_t i = firstVertex; i < vertexCount; i++)
+            positions.push_back(batch.vertices[i].position);
+        batch.positionBuffer->SetSubData(firstVertex * sizeof(glm::vec3), positions.data(),
+                                         positions.size() * sizeof(glm::vec3));
+    }
+    auto firstIndex = batch.uploadedIndices;
+    if (indexCount > firstIndex)
+    {
+        batch.indexBuffer->SetSubData(firstIndex * sizeof(uint32_t), batch.indices.data() + firstIndex,
+                                      (indexCount - firstIndex) * sizeof(uint32_t));
+    }
+    batch.uploadedVertices = vertexCount;
+    batch.uploadedIndices = indexCount;
+    batch.mesh->SetDrawCount(indexCount);
+}
+
+void StaticBatch::Draw(const Program *program) const
+{
+    for (auto &batch : m_batches)
+    {
+        if (batch.mesh)
+            batch.mesh->Draw(program);
+    }
+}
+
+void StaticBatch::DrawPositionOnly() const
+{
+    for (auto &batch : m_batches)
+    {
+        if (batch.mesh)
+            batch.mesh->DrawPositionOnly();
+    }
+}
+
+void StaticBatch::Submit(RenderQueue *queue, RenderQueue::Pass pass, const Program *program) const
+{
+    for (auto &batch : m_batches)
+    {
+        if (batch.mesh)
+            queue->Submit(pass, program, batch.material.get(), batch.mesh.get(), glm::mat4(1.0f), 1.0f);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef __STATIC_BATCH_H__
+#define __STATIC_BATCH_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "render_queue.h"
+
+// 움직이지 않는 오브젝트들을 world space로 미리 변환해서 material별로 하나의 mesh로 합침
+// material 하나당 draw call 하나로 그릴 수 있고, transform uniform은 프레임마다 view projection만 설정하면 된다.
+// 대신 오브젝트별 frustum culling은 할 수 없으므로 작고 흩어진 오브젝트보다 배경 / 지형에 적합
+CLASS_PTR(StaticBatch)
+class StaticBatch
+{
+public:
+    static StaticBatchUPtr Create();
+
+    // geometry를 transform으로 변환해서 같은 material의 batch 끝에 붙임. 추가한 오브젝트 번호를 반환
+    // Build()는 바뀐 batch에서 새로 붙은 구간만 GPU buffer에 올리고, capacity를 넘을 때만 buffer를 2배로 새로 만듦
+    int Add(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+            const glm::mat4 &transform, MaterialPtr material);
+    void Build();
+
+    // modelTransform은 단위 행렬, transform은 view projection으로 설정해서 그림
+    void Draw(const Program *program) const;
+    void DrawPositionOnly() const; // depth prepass용
+    // batch마다 packet 하나. batch는 scene 전체에 퍼져 있어 거리가 의미 없으므로 depth는 가장 먼 값으로
+    void Submit(RenderQueue *queue, RenderQueue::Pass pass, const Program *program) const;
+
+    int GetBatchCount() const { return (int)m_batches.size(); }
+    int GetObjectCount() const { return m_objectCount; }
+    float GetLastBuildTime() const { return m_lastBuildTime; } // ms, 마지막 Build()에서 다시 올린 batch의 CPU 시간
+    int GetLastRebuildCount() const { return m_lastRebuildCount; }
+
+private:
+    StaticBatch() {}
+
+    struct Batch
+    {
+        MaterialPtr material;
+        std::vector<Vertex> vertices; // world space
+        std::vector<uint32_t> indices;
+        AABB aabb;
+        MeshUPtr mesh; // 아래 buffer를 공유하고 draw count만 올라간 index 수로 맞춤
+        BufferPtr vertexBuffer;
+        BufferPtr indexBuffer;
+        BufferPtr positionBuffer; // depth prepass용 위치 stream
+        size_t vertexCapacity{0};
+        size_t indexCapacity{0};
+        size_t uploadedVertices{0};
+        size_t uploadedIndices{0};
+        bool dirty{true};
+    };
+    void Upload(Batch &batch);
+    std::vector<Batch> m_batches; // material 수만큼만 생기므로 선형 탐색
+    int m_objectCount{0};
+    float m_lastBuildTime{0.0f};
+    int m_lastRebuildCount{0};
+};
+
+#endif // __STATIC_BATCH_H__
@@ -1,4 +1,6 @@
 #include "texture.h"
+#include "gl_state.h"
+#include <algorithm>
 
 TextureUPtr Texture::CreateFromImage(const Image *image)
 {
@@ -8,33 +10,93 @@ TextureUPtr Texture::CreateFromImage(const Image *image)
     return std::move(texture);
 }
 
+TextureUPtr Texture::CreateFromData(int width, int height, uint32_t internalFormat, uint32_t format, uint32_t type, const void *data)
+{
+    auto texture = TextureUPtr(new Texture());
+    texture->CreateTexture();
+    texture->SetFilter(GL_NEAREST, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glTextureStorage2D(texture->m_texture, 1, internalFormat, width, height);
+        glTextureSubImage2D(texture->m_texture, 0, 0, 0, width, height, format, type, data);
+        texture->m_storageWidth = width;
+        texture->m_storageHeight = height;
+    }
+    else
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return std::move(texture);
+}
+
 Texture::~Texture()
 {
     if (m_texture)
     {
         glDeleteTextures(1, &m_texture);
+        GlState::Get().OnDeleteTexture(m_texture);
     }
 }
 
 void Texture::Bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, m_texture); // 사용하고자 하는 텍스처 바인딩
+    GlState::Get().BindTexture(m_texture); // 사용하고자 하는 텍스처 바인딩
 }
 
-void Texture::SetFilter(uint32_t minFilter, uint32_t magFilter) const
+void Texture::Bind(int unit) const
 {
+    GlState::Get().BindTexture(unit, m_texture);
+}
+
+void Texture::SetFilter(uint32_t minFilter, uint32_t magFilter)
+{
+    m_minFilter = minFilter;
+    m_magFilter = magFilter;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, minFilter);
+        glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, magFilter);
+        return;
+    }
+    Bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
 }
 
-void Texture::SetWrap(uint32_t sWrap, uint32_t tWrap) const
+void Texture::SetWrap(uint32_t sWrap, uint32_t tWrap)
 {
+    m_wrapS = sWrap;
+    m_wrapT = tWrap;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glTextureParameteri(m_texture, GL_TEXTURE_WRAP_S, sWrap);
+        glTextureParameteri(m_texture, GL_TEXTURE_WRAP_T, tWrap);
+        return;
+    }
+    Bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sWrap);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tWrap);
 }
 
+void Texture::SetImage(const Image *image)
+{
+    if (!GlState::Get().IsDirectStateAccess())
+        Bind();
+    SetTextureFromImage(image);
+}
+
 void Texture::CreateTexture()
 {
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_texture); // bind하지 않아도 GL_TEXTURE_2D object로 만들어짐
+        // 처음에는 기본값, SetTextureFromImage에서 다시 만들 때는 이전 object에 설정했던 값
+        SetFilter(m_minFilter, m_magFilter);
+        SetWrap(m_wrapS, m_wrapT);
+        return;
+    }
     glGenTextures(1, &m_texture); // OpenGL texture object 생성
     // bind and set default filter and wrap option
     Bind();
@@ -65,6 +127,31 @@ void Texture::SetTextureFromImage(const Image *image)
         break;
     }
 
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        // 크기가 같으면 기존 storage에 덮어쓰고, 다르면 immutable storage를 바꿀 수 없으므로 object를 새로 만듦
+        int width = image->GetWidth();
+        int height = image->GetHeight();
+        if (width != m_storageWidth || height != m_storageHeight)
+        {
+            if (m_storageWidth > 0)
+            {
+                glDeleteTextures(1, &m_texture);
+                GlState::Get().OnDeleteTexture(m_texture);
+                CreateTexture();
+            }
+            int levels = 1;
+            while ((std::max(width, height) >> levels) > 0)
+                levels++;
+            glTextureStorage2D(m_texture, levels, GL_RGBA8, width, height);
+            m_storageWidth = width;
+            m_storageHeight = height;
+        }
+        glTextureSubImage2D(m_texture, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, image->GetData());
+        glGenerateTextureMipmap(m_texture);
+        return;
+    }
+
     // glTexImage2D(target, level, internalFormat, width, height, border, format, type, data)
     // 바인딩된 텍스처의 크기 픽셀 포맷을 설정하고 GPU에 이미지 데이터를 복사
     // cpu에서의 image의 channel수가 GL_RGB인데 GPU에서의 texture의 format이 GL_RGBA이면 Alpha 채널이 다 255로 들어가게 된다.
@@ -12,12 +12,20 @@ public:
                                                             // ImagePtr: 이미지 인스턴스 소유권을 공유함
                                                             // Image*: 소유권과 상관없이 인스턴스에 접근
                                                             // Image를 texture만들때 한번만 쓸 것이기 때문에 소유권을 가져올 필요 x
+    // 이미지가 아닌 데이터 배열(float 등)로 texture 생성. mipmap 없이 nearest filter (texelFetch로 읽는 용도)
+    static TextureUPtr CreateFromData(int width, int height, uint32_t internalFormat, uint32_t format, uint32_t type, const void *data);
     ~Texture();
 
     const uint32_t Get() const { return m_texture; }
-    void Bind() const;
-    void SetFilter(uint32_t minFilter, uint32_t magFilter) const;
-    void SetWrap(uint32_t sWrap, uint32_t tWrap) const;
+    void Bind() const;         // 현재 active texture unit에 연결
+    void Bind(int unit) const; // unit에 연결. active unit이 unit으로 바뀔 수 있음
+    // 설정한 값은 저장해 두었다가 SetImage가 object를 새로 만들 때 다시 적용
+    void SetFilter(uint32_t minFilter, uint32_t magFilter);
+    void SetWrap(uint32_t sWrap, uint32_t tWrap);
+    // 같은 Texture에 새 이미지를 올림 (크기가 달라도 됨). 이 texture를 공유하는 material은 그대로
+    // direct state access 경로에서 크기가 바뀌면 object를 새로 만들므로 GL 이름(Get())이 바뀜
+    // Get()을 저장해 두지 말고 Texture로 구분할 것 (MaterialTable처럼). hot reload는 onReload 콜백으로 알 수 있음
+    void SetImage(const Image *image);
 
 private:
     Texture() {}
@@ -25,6 +33,12 @@ private:
     void SetTextureFromImage(const Image *image);
 
     uint32_t m_texture{0};
+    uint32_t m_minFilter{GL_LINEAR_MIPMAP_LINEAR};
+    uint32_t m_magFilter{GL_LINEAR};
+    uint32_t m_wrapS{GL_CLAMP_TO_EDGE};
+    uint32_t m_wrapT{GL_CLAMP_TO_EDGE};
+    int m_storageWidth{0}; // glTextureStorage2D로 할당한 크기. immutable이라 크기가 바뀌면 새 object가 필요
+    int m_storageHeight{0};
 };
 
 #endif // __TEXTURE_H__
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "transform_animation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_ANIMATION_USE_SSE
+#endif
+
+static const size_t kMinNodesPerTask = 16384; // 이보다 작게 나누면 스레드 시작 비용이 더 큼
+
+TransformAnimationUPtr TransformAnimation::Create()
+{
+    return TransformAnimationUPtr(new TransformAnimation());
+}
+
+int TransformAnimation::AddClip(const std::string &name, float frameRate,
+                                const std::vector<glm::vec3> &positions,
+                                const std::vector<glm::quat> &rotations,
+                                const std::vector<glm::vec3> &scales)
+{
+    size_t keyCount = positions.size();
+    if (keyCount == 0 || rotations.size() != keyCount || scales.size() != keyCount || frameRate <= 0.0f)
+    {
+        SPDLOG_ERROR("invalid transform clip: {}", name);
+        return -1;
+    }
+
+    TransformClip clip;
+    clip.name = name;
+    clip.frameRate = frameRate;
+    clip.keyCount = (int)keyCount;
+    clip.keys.resize(keyCount * TransformClip::TrackCount);
+    auto Set = [&](int track, size_t key, float value)
+    {
+        clip.keys[track * keyCount + key] = value;
+    };
+    for (size_t k = 0; k < keyCount; k++)
+    {
+        // slerp가 짧은 쪽으로 돌도록 이웃한 키의 부호를 맞춰 둠
+        auto rotation = glm::normalize(rotations[k]);
+        if (k > 0)
+        {
+            float dot = clip.Get(TransformClip::RotationX, (int)k - 1) * rotation.x +
+                        clip.Get(TransformClip::RotationY, (int)k - 1) * rotation.y +
+                        clip.Get(TransformClip::RotationZ, (int)k - 1) * rotation.z +
+                        clip.Get(TransformClip::RotationW, (int)k - 1) * rotation.w;
+            if (dot < 0.0f)
+                rotation = -rotation;
+        }
+        Set(TransformClip::PositionX, k, positions[k].x);
+        Set(TransformClip::PositionY, k, positions[k].y);
+        Set(TransformClip::PositionZ, k, positions[k].z);
+        Set(TransformClip::RotationX, k, rotation.x);
+        Set(TransformClip::RotationY, k, rotation.y);
+        Set(TransformClip::RotationZ, k, rotation.z);
+        Set(TransformClip::RotationW, k, rotation.w);
+        Set(TransformClip::ScaleX, k, scales[k].x);
+        Set(TransformClip::ScaleY, k, scales[k].y);
+        Set(TransformClip::ScaleZ, k, scales[k].z);
+    }
+    m_clips.push_back(std::move(clip));
+    return (int)m_clips.size() - 1;
+}
+
+int TransformAnimation::AddNode(int clip, float timeOffset, float speed, const glm::vec3 &offset)
+{
+    if (clip < 0 || clip >= (int)m_clips.size())
+    {
+        SPDLOG_ERROR("invalid transform clip index: {}", clip);
+        return -1;
+    }
+
+    // 패딩 칸은 clip 0의 첫 키를 가리키게 해서 SIMD 루프가 그대로 읽어도 되게 함
+    if (m_nodeCount % 4 == 0)
+    {
+        size_t size = m_nodeCount + 4;
+        m_nodeClip.resize(size, 0);
+        m_nodeRate.resize(size, 0.0f);
+        m_nodePhase.resize(size, 0.0f);
+        m_nodeKeyCount.resize(size, 1.0f);
+        m_offsetX.resize(size, 0.0f);
+        m_offsetY.resize(size, 0.0f);
+        m_offsetZ.resize(size, 0.0f);
+    }
+    auto &data = m_clips[clip];
+    size_t i = m_nodeCount++;
+    m_nodeClip[i] = clip;
+    m_nodeRate[i] = data.frameRate * speed;
+    m_nodePhase[i] = data.frameRate * timeOffset;
+    m_nodeKeyCount[i] = (float)data.keyCount;
+    m_offsetX[i] = offset.x;
+    m_offsetY[i] = offset.y;
+    m_offsetZ[i] = offset.z;
+    return (int)i;
+}
+
+void TransformAnimation::ClearNodes()
+{
+    m_nodeCount = 0;
+    m_nodeClip.clear();
+    m_nodeRate.clear();
+    m_nodePhase.clear();
+    m_nodeKeyCount.clear();
+    m_offsetX.clear();
+    m_offsetY.clear();
+    m_offsetZ.clear();
+}
+
+void TransformAnimation::Evaluate(float time, glm::mat4 *transforms) const
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 4개 단위 묶음을 스레드 수만큼 나눔
+    size_t groupCount = (m_nodeCount + 3) / 4;
+    size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t taskCount = std::max<size_t>(std::min(threadCount, m_nodeCount / kMinNodesPerTask), 1);
+    auto Range = [&](size_t task)
+    {
+        return std::min(groupCount * task / taskCount * 4, m_nodeCount);
+    };
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 1; i < taskCount; i++)
+        tasks.push_back(std::async(std::launch::async, &TransformAnimation::EvaluateRange, this, time, Range(i), Range(i + 1), transforms));
+    EvaluateRange(time, 0, Range(1), transforms);
+    for (auto &task : tasks)
+        task.wait();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_lastEvaluateTime = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+#if defined(TRANSFORM_ANIMATION_USE_SSE)
+
+static inline __m128 Floor(__m128 x)
+{
+    // SSE2에는 floor가 없으므로 0 방향으로 자른 뒤 음수면 1을 뺌
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmplt_ps(x, truncated), _mm_set1_ps(1.0f)));
+}
+
+// 나눗셈 / 삼각함수 없이 곱셈, 덧셈만으로 계산하는 slerp 근사 (Eberly, "A Fast and Accurate Algorithm for Computing SLERP")
+// cos(theta) >= 0 (짧은 경로)일 때 오차는 1e-6 이하
+static inline void Slerp(const __m128 a[4], __m128 b[4], __m128 t, __m128 out[4])
+{
+    static const float kMu = 1.85298109240830f;
+    static const float kU[8] = {1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+                                1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), kMu / (8 * 17)};
+    static const float kV[8] = {1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+                                5.0f / 11, 6.0f / 13, 7.0f / 15, kMu * 8 / 17};
+
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+                            _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+    // 서로 다른 clip의 키가 섞여 있을 수 있으므로 lane별로 짧은 경로 선택
+    __m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+    for (int c = 0; c < 4; c++)
+        b[c] = _mm_xor_ps(b[c], sign);
+    dot = _mm_xor_ps(dot, sign);
+
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 xm1 = _mm_sub_ps(dot, one);
+    __m128 d = _mm_sub_ps(one, t);
+    __m128 sqrT = _mm_mul_ps(t, t);
+    __m128 sqrD = _mm_mul_ps(d, d);
+    __m128 cT = one;
+    __m128 cD = one;
+    for (int i = 7; i >= 0; i--)
+    {
+        __m128 u = _mm_set1_ps(kU[i]);
+        __m128 v = _mm_set1_ps(kV[i]);
+        __m128 bT = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqrT), v), xm1);
+        __m128 bD = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqrD), v), xm1);
+        cT = _mm_add_ps(one, _mm_mul_ps(bT, cT));
+        cD = _mm_add_ps(one, _mm_mul_ps(bD, cD));
+    }
+    cT = _mm_mul_ps(cT, t);
+    cD = _mm_mul_ps(cD, d);
+    for (int c = 0; c < 4; c++)
+        out[c] = _mm_add_ps(_mm_mul_ps(a[c], cD), _mm_mul_ps(b[c], cT));
+}
+
+void TransformAnimation::EvaluateRange(float time, size_t begin, size_t end, glm::mat4 *transforms) const
+{
+    alignas(16) int key0[4];
+    alignas(16) glm::mat4 tail[4];
+
+    for (size_t i = begin; i < end; i += 4)
+    {
+        // 키 위치 = time * rate + phase 를 keyCount로 감아서 [0, keyCount) 범위로
+        __m128 keyCount = _mm_loadu_ps(&m_nodeKeyCount[i]);
+        __m128 f = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(time), _mm_loadu_ps(&m_nodeRate[i])), _mm_loadu_ps(&m_nodePhase[i]));
+        f = _mm_sub_ps(f, _mm_mul_ps(Floor(_mm_div_ps(f, keyCount)), keyCount));
+        __m128 k0 = Floor(f);
+        __m128 t = _mm_sub_ps(f, k0);
+        _mm_store_si128((__m128i *)key0, _mm_cvttps_epi32(k0));
+
+        // lane별 두 키의 위치. node마다 clip이 다를 수 있어 gather는 scalar로 하되,
+        // 메모리를 거치지 않고 바로 register에 모아야 store forwarding 지연이 없음
+        const float *first[4];
+        const float *second[4];
+        int stride[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            auto &clip = m_clips[m_nodeClip[i + lane]];
+            int key = std::min(std::max(key0[lane], 0), clip.keyCount - 1); // 부동소수점 오차로 keyCount가 나온 경우
+            first[lane] = clip.keys.data() + key;
+            second[lane] = clip.keys.data() + (key + 1 == clip.keyCount ? 0 : key + 1);
+            stride[lane] = clip.keyCount;
+        }
+        auto Gather = [&](const float *const *keys, int track)
+        {
+            return _mm_set_ps(keys[3][track * stride[3]], keys[2][track * stride[2]],
+                              keys[1][track * stride[1]], keys[0][track * stride[0]]);
+        };
+        auto Lerp = [&](int track)
+        {
+            __m128 a = Gather(first, track);
+            return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(Gather(second, track), a), t));
+        };
+        __m128 px = _mm_add_ps(Lerp(TransformClip::PositionX), _mm_loadu_ps(&m_offsetX[i]));
+        __m128 py = _mm_add_ps(Lerp(TransformClip::PositionY), _mm_loadu_ps(&m_offsetY[i]));
+        __m128 pz = _mm_add_ps(Lerp(TransformClip::PositionZ), _mm_loadu_ps(&m_offsetZ[i]));
+        __m128 sx = Lerp(TransformClip::ScaleX);
+        __m128 sy = Lerp(TransformClip::ScaleY);
+        __m128 sz = Lerp(TransformClip::ScaleZ);
+
+        __m128 qa[4], qb[4], q[4];
+        for (int c = 0; c < 4; c++)
+        {
+            qa[c] = Gather(first, TransformClip::RotationX + c);
+            qb[c] = Gather(second, TransformClip::RotationX + c);
+        }
+        Slerp(qa, qb, t, q);
+
+        // T * R * S 행렬을 lane별 원소로 조립 (column major)
+        __m128 two = _mm_set1_ps(2.0f);
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 zero = _mm_setzero_ps();
+        __m128 xx = _mm_mul_ps(q[0], q[0]), yy = _mm_mul_ps(q[1], q[1]), zz = _mm_mul_ps(q[2], q[2]);
+        __m128 xy = _mm_mul_ps(q[0], q[1]), xz = _mm_mul_ps(q[0], q[2]), yz = _mm_mul_ps(q[1], q[2]);
+        __m128 wx = _mm_mul_ps(q[3], q[0]), wy = _mm_mul_ps(q[3], q[1]), wz = _mm_mul_ps(q[3], q[2]);
+        __m128 columns[4][4] = {
+            {_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+             zero},
+            {_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+             _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+             zero},
+            {_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+             _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+             zero},
+            {px, py, pz, one},
+        };
+
+        // lane별 원소를 node별 행렬로 전치해서 기록. 마지막 묶음이 4개가 안 되면 임시 공간에 씀
+        size_t count = std::min<size_t>(end - i, 4);
+        glm::mat4 *out = count == 4 ? transforms + i : tail;
+        for (int c = 0; c < 4; c++)
+        {
+            _MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+            for (int n = 0; n < 4; n++)
+                _mm_storeu_ps(glm::value_ptr(out[n]) + c * 4, columns[c][n]);
+        }
+        if (count < 4)
+            std::copy(tail, tail + count, transforms + i);
+    }
+}
+
+#else
+
+void TransformAnimation::EvaluateRange(float time, size_t begin, size_t end, glm::mat4 *transforms) const
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        auto &clip = m_clips[m_nodeClip[i]];
+        float keyCount = m_nodeKeyCount[i];
+        float f = time * m_nodeRate[i] + m_nodePhase[i];
+        f -= floorf(f / keyCount) * keyCount;
+        int first = std::min(std::max((int)floorf(f), 0), clip.keyCount - 1);
+        int second = first + 1 == clip.keyCount ? 0 : first + 1;
+        float t = f - floorf(f);
+
+        auto Key = [&](int track0, int key)
+        {
+            return glm::vec3(clip.Get(track0, key), clip.Get(track0 + 1, key), clip.Get(track0 + 2, key));
+        };
+        auto Rotation = [&](int key)
+        {
+            return glm::quat(clip.Get(TransformClip::RotationW, key), clip.Get(TransformClip::RotationX, key),
+                             clip.Get(TransformClip::RotationY, key), clip.Get(TransformClip::RotationZ, key));
+        };
+        auto position = glm::mix(Key(TransformClip::PositionX, first), Key(TransformClip::PositionX, second), t) +
+                        glm::vec3(m_offsetX[i], m_offsetY[i], m_offsetZ[i]);
+        auto scale = glm::mix(Key(TransformClip::ScaleX, first), Key(TransformClip::ScaleX, second), t);
+        auto rotation = glm::slerp(Rotation(first), Rotation(second), t);
+        transforms[i] = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+    }
+}
+
+#endif
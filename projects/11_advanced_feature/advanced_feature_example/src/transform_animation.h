@@ -0,0 +1,70 @@
+#ifndef __TRANSFORM_ANIMATION_H__
+#define __TRANSFORM_ANIMATION_H__
+
+#include "common.h"
+#include <glm/gtc/quaternion.hpp>
+
+// 일정 간격으로 샘플링된 position / rotation / scale 키프레임. 마지막 키 다음은 첫 키로 보간하며 반복 재생
+// track마다 keyCount개의 float이 연속으로 놓임 (SoA). 한 배열에 모아서 node마다 시작 주소 하나로 모든 track을 찾음
+struct TransformClip
+{
+    enum Track
+    {
+        PositionX, PositionY, PositionZ,
+        RotationX, RotationY, RotationZ, RotationW,
+        ScaleX, ScaleY, ScaleZ,
+        TrackCount,
+    };
+
+    std::string name;
+    float frameRate{30.0f};
+    int keyCount{0};
+    std::vector<float> keys; // keys[track * keyCount + key]
+
+    float Get(int track, int key) const { return keys[track * keyCount + key]; }
+};
+
+// 수많은 node의 world transform을 매 프레임 키프레임에서 계산
+// node 상태도 SoA로 두고, 4개 node씩 SSE로 키 보간, quaternion slerp, 행렬 조립을 한 번에 처리한다.
+// node 수가 많으면 여러 스레드로 나눠서 계산
+CLASS_PTR(TransformAnimation)
+class TransformAnimation
+{
+public:
+    static TransformAnimationUPtr Create();
+
+    // 같은 수의 키를 frameRate 간격으로 샘플링한 clip 추가. clip 번호 반환, 실패하면 -1
+    int AddClip(const std::string &name, float frameRate,
+                const std::vector<glm::vec3> &positions,
+                const std::vector<glm::quat> &rotations,
+                const std::vector<glm::vec3> &scales);
+    const TransformClip &GetClip(int clip) const { return m_clips[clip]; }
+    int GetClipCount() const { return (int)m_clips.size(); }
+
+    // clip을 speed배 속도, timeOffset(초)만큼 어긋나게 재생하는 node 추가. offset은 키의 position에 더해짐
+    int AddNode(int clip, float timeOffset, float speed, const glm::vec3 &offset);
+    void ClearNodes();
+    int GetNodeCount() const { return (int)m_nodeCount; }
+
+    // time(초)의 transform을 node 수만큼 transforms에 기록 (translate * rotate * scale)
+    void Evaluate(float time, glm::mat4 *transforms) const;
+    float GetLastEvaluateTime() const { return m_lastEvaluateTime; } // ms
+
+private:
+    TransformAnimation() {}
+    void EvaluateRange(float time, size_t begin, size_t end, glm::mat4 *transforms) const; // begin은 4의 배수
+
+    std::vector<TransformClip> m_clips;
+
+    // node별 상태 (SIMD 루프가 4개씩 읽도록 4의 배수로 패딩)
+    size_t m_nodeCount{0};
+    std::vector<int> m_nodeClip;
+    std::vector<float> m_nodeRate;  // 초당 진행하는 키 수 (frameRate * speed)
+    std::vector<float> m_nodePhase; // 시작 키 위치 (timeOffset * frameRate)
+    std::vector<float> m_nodeKeyCount;
+    std::vector<float> m_offsetX, m_offsetY, m_offsetZ;
+
+    mutable float m_lastEvaluateTime{0.0f};
+};
+
+#endif // __TRANSFORM_ANIMATION_H__
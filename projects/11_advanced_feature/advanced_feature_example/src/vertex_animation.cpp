@@ -0,0 +1,313 @@
+#include "vertex_animation.h"
+#include "gl_state.h"
+#include "image.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// .vat 파일 헤더
+static const char kVatMagic[4] = {'V', 'A', 'T', 'X'};
+static const uint32_t kVatVersion = 1;
+
+static const int kMaxTextureWidth = 2048; // 정점 * frame 수를 이 폭으로 접어서 texture에 담음
+// 굽는 시점에는 GL context가 없으므로 대부분의 GPU가 지원하는 높이로 제한. 로드할 때 GL_MAX_TEXTURE_SIZE로 다시 확인
+static const size_t kMaxBakeTextureHeight = 16384;
+
+static size_t GetTextureHeight(size_t texelCount, size_t width)
+{
+    return (std::max<size_t>(texelCount, 1) + width - 1) / width;
+}
+
+std::optional<VertexAnimationData> VertexAnimation::Bake(
+    const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices,
+    const Skeleton &skeleton, const std::vector<const Animation *> &animations, float frameRate)
+{
+    if (!(frameRate > 0.0f) || !std::isfinite(frameRate))
+    {
+        SPDLOG_ERROR("invalid vertex animation frame rate: {}", frameRate);
+        return {};
+    }
+
+    VertexAnimationData data;
+    data.vertexCount = (int)vertices.size();
+    data.indices = indices;
+    data.vertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        data.vertices[i] = {vertices[i].position, vertices[i].normal, vertices[i].texCoord};
+
+    std::vector<glm::mat4> localTransforms;
+    std::vector<glm::mat4> palette(skeleton.GetBoneCount());
+    std::vector<Vertex> skinned(vertices.size());
+    for (auto animation : animations)
+    {
+        if ((int)data.clips.size() >= kMaxVertexAnimationClips)
+        {
+            SPDLOG_ERROR("too many clips for vertex animation, max: {}", kMaxVertexAnimationClips);
+            break;
+        }
+
+        // 마지막 frame 다음은 첫 frame으로 보간하므로 duration 끝은 샘플링하지 않음
+        VertexAnimationClip clip;
+        clip.name = animation->GetName();
+        clip.firstFrame = data.frameCount;
+        clip.frameCount = std::max((int)std::lround(animation->GetDuration() * frameRate), 1);
+        clip.frameRate = frameRate;
+        // 샘플링하기 전에 texture 높이를 확인 (너무 길거나 정점이 많은 animation)
+        size_t texelCount = (size_t)(data.frameCount + clip.frameCount) * vertices.size();
+        if (GetTextureHeight(texelCount, kMaxTextureWidth) > kMaxBakeTextureHeight)
+        {
+            SPDLOG_ERROR("vertex animation texture too large: {} texels (max {}x{})",
+                         texelCount, kMaxTextureWidth, kMaxBakeTextureHeight);
+            return {};
+        }
+        for (int f = 0; f < clip.frameCount; f++)
+        {
+            animation->Evaluate(f / frameRate, skeleton, localTransforms);
+            skeleton.ComputePalette(localTransforms.data(), palette.data());
+            SkinVertices(vertices.data(), vertices.size(), palette.data(), skinned.data());
+            for (auto &vertex : skinned)
+            {
+                data.positions.push_back(glm::vec4(vertex.position, 1.0f));
+                data.normals.push_back(glm::vec4(glm::normalize(vertex.normal), 0.0f));
+            }
+        }
+        data.frameCount += clip.frameCount;
+        data.clips.push_back(std::move(clip));
+    }
+
+    SPDLOG_INFO("vertex animation baked: #vertex: {}, #clip: {}, #frame: {}, {} bytes",
+                data.vertexCount, data.clips.size(), data.frameCount,
+                data.positions.size() * sizeof(glm::vec4) + data.normals.size() * sizeof(uint16_t) * 4);
+    return data;
+}
+
+// .vat 레이아웃 (little endian)
+//   "VATX", version, #vertex, #frame, #clip, #index
+//   clip: 이름 (uint32 길이 + 문자열), firstFrame, frameCount, frameRate
+//   diffuse 경로, specular 경로
+//   vertices (Vertex * #vertex), indices (uint32 * #index), positions, normals (vec4 * #vertex * #frame)
+bool VertexAnimation::Save(const VertexAnimationData &data, const std::string &filename)
+{
+    std::vector<uint8_t> out;
+    auto WriteBytes = [&](const void *ptr, size_t size)
+    {
+        out.insert(out.end(), (const uint8_t *)ptr, (const uint8_t *)ptr + size);
+    };
+    auto Write = [&](const auto &value)
+    {
+        WriteBytes(&value, sizeof(value));
+    };
+    auto WriteString = [&](const std::string &str)
+    {
+        Write((uint32_t)str.size());
+        WriteBytes(str.data(), str.size());
+    };
+
+    WriteBytes(kVatMagic, 4);
+    Write(kVatVersion);
+    Write((uint32_t)data.vertexCount);
+    Write((uint32_t)data.frameCount);
+    Write((uint32_t)data.clips.size());
+    Write((uint32_t)data.indices.size());
+    for (auto &clip : data.clips)
+    {
+        WriteString(clip.name);
+        Write((int32_t)clip.firstFrame);
+        Write((int32_t)clip.frameCount);
+        Write(clip.frameRate);
+    }
+    WriteString(data.diffuseMap);
+    WriteString(data.specularMap);
+    WriteBytes(data.vertices.data(), data.vertices.size() * sizeof(Vertex));
+    WriteBytes(data.indices.data(), data.indices.size() * sizeof(uint32_t));
+    WriteBytes(data.positions.data(), data.positions.size() * sizeof(glm::vec4));
+    WriteBytes(data.normals.data(), data.normals.size() * sizeof(glm::vec4));
+
+    std::ofstream fout(filename, std::ios::binary);
+    if (!fout.is_open())
+    {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return false;
+    }
+    fout.write((const char *)out.data(), out.size());
+    return true;
+}
+
+std::optional<VertexAnimationData> VertexAnimation::Read(const std::string &filename)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open())
+    {
+        SPDLOG_ERROR("failed to open file: {}", filename);
+        return {};
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+    size_t offset = 0;
+    bool ok = true;
+    auto ReadBytes = [&](void *dst, size_t size)
+    {
+        if (!ok || size > bytes.size() - offset)
+        {
+            ok = false;
+            return;
+        }
+        memcpy(dst, bytes.data() + offset, size);
+        offset += size;
+    };
+    auto Read = [&](auto &value)
+    {
+        ReadBytes(&value, sizeof(value));
+    };
+    auto ReadString = [&]() -> std::string
+    {
+        uint32_t length = 0;
+        Read(length);
+        std::string str(ok && length <= bytes.size() - offset ? length : 0, '\0');
+        ReadBytes(&str[0], length);
+        return str;
+    };
+
+    char magic[4] = {};
+    uint32_t version = 0, vertexCount = 0, frameCount = 0, clipCount = 0, indexCount = 0;
+    Read(magic);
+    Read(version);
+    if (!ok || memcmp(magic, kVatMagic, 4) != 0 || version != kVatVersion)
+    {
+        SPDLOG_ERROR("invalid vertex animation: {}", filename);
+        return {};
+    }
+    Read(vertexCount);
+    Read(frameCount);
+    Read(clipCount);
+    Read(indexCount);
+
+    // 크기 필드가 깨진 파일에서 거대한 할당을 하지 않도록 남은 크기로 먼저 검사
+    size_t expected = (size_t)vertexCount * sizeof(Vertex) + (size_t)indexCount * sizeof(uint32_t) +
+                      (size_t)vertexCount * frameCount * sizeof(glm::vec4) * 2;
+    if (!ok || clipCount > (uint32_t)kMaxVertexAnimationClips || expected > bytes.size() - offset)
+    {
+        SPDLOG_ERROR("corrupted vertex animation: {}", filename);
+        return {};
+    }
+
+    VertexAnimationData data;
+    data.vertexCount = (int)vertexCount;
+    data.frameCount = (int)frameCount;
+    for (uint32_t i = 0; ok && i < clipCount; i++)
+    {
+        VertexAnimationClip clip;
+        clip.name = ReadString();
+        Read(clip.firstFrame);
+        Read(clip.frameCount);
+        Read(clip.frameRate);
+        if (clip.firstFrame < 0 || clip.frameCount <= 0 || clip.firstFrame + clip.frameCount > data.frameCount)
+            ok = false;
+        data.clips.push_back(std::move(clip));
+    }
+    data.diffuseMap = ReadString();
+    data.specularMap = ReadString();
+    data.vertices.resize(vertexCount);
+    data.indices.resize(indexCount);
+    data.positions.resize((size_t)vertexCount * frameCount);
+    data.normals.resize((size_t)vertexCount * frameCount);
+    ReadBytes(data.vertices.data(), data.vertices.size() * sizeof(Vertex));
+    ReadBytes(data.indices.data(), data.indices.size() * sizeof(uint32_t));
+    ReadBytes(data.positions.data(), data.positions.size() * sizeof(glm::vec4));
+    ReadBytes(data.normals.data(), data.normals.size() * sizeof(glm::vec4));
+    for (auto index : data.indices)
+    {
+        if (index >= vertexCount)
+            ok = false;
+    }
+    if (!ok)
+    {
+        SPDLOG_ERROR("corrupted vertex animation: {}", filename);
+        return {};
+    }
+    return data;
+}
+
+VertexAnimationUPtr VertexAnimation::Create(const VertexAnimationData &data, MaterialPtr material)
+{
+    auto animation = VertexAnimationUPtr(new VertexAnimation());
+    if (!animation->Init(data, material))
+        return nullptr;
+    return std::move(animation);
+}
+
+VertexAnimationUPtr VertexAnimation::Load(const std::string &filename)
+{
+    auto data = Read(filename);
+    if (!data)
+        return nullptr;
+
+    auto dirname = filename.substr(0, filename.find_last_of("/"));
+    auto LoadTexture = [&](const std::string &path) -> TexturePtr
+    {
+        if (path.empty())
+            return nullptr;
+        auto image = Image::Load(fmt::format("{}/{}", dirname, path));
+        return image ? Texture::CreateFromImage(image.get()) : nullptr;
+    };
+    auto material = Material::Create();
+    material->diffuse = LoadTexture(data->diffuseMap);
+    material->specular = LoadTexture(data->specularMap);
+    return Create(*data, std::move(material));
+}
+
+bool VertexAnimation::Init(const VertexAnimationData &data, MaterialPtr material)
+{
+    // 정점 * frame 수가 최대 texture 폭을 넘으면 여러 줄로 접고, 남는 칸은 0으로 채움
+    int maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    size_t texelCount = data.positions.size();
+    size_t maxWidth = (size_t)std::min(kMaxTextureWidth, maxTextureSize);
+    size_t width = std::min<size_t>(std::max<size_t>(texelCount, 1), maxWidth);
+    size_t height = GetTextureHeight(texelCount, width);
+    if (height > (size_t)maxTextureSize)
+    {
+        SPDLOG_ERROR("vertex animation texture too large: {}x{} (max texture size {})", width, height, maxTextureSize);
+        return false;
+    }
+
+    m_vertexCount = data.vertexCount;
+    m_clips = data.clips;
+    m_mesh = Mesh::Create(data.vertices, data.indices, GL_TRIANGLES);
+    m_mesh->SetMaterial(material);
+
+    auto positions = data.positions;
+    auto normals = data.normals;
+    positions.resize(width * height, glm::vec4(0.0f));
+    normals.resize(width * height, glm::vec4(0.0f));
+    m_positionMap = Texture::CreateFromData((int)width, (int)height, GL_RGBA32F, GL_RGBA, GL_FLOAT, positions.data());
+    m_normalMap = Texture::CreateFromData((int)width, (int)height, GL_RGBA16F, GL_RGBA, GL_FLOAT, normals.data());
+    return true;
+}
+
+void VertexAnimation::SetInstances(const std::vector<glm::mat4> &transforms, const std::vector<glm::vec2> &clipTimes)
+{
+    m_mesh->SetInstanceTransforms(transforms);
+    m_mesh->SetInstanceAnimations(clipTimes);
+}
+
+void VertexAnimation::Draw(const Program *program, float time) const
+{
+    // material이 texture unit 0, 1을 쓰므로 2, 3번에 연결
+    m_positionMap->Bind(2);
+    m_normalMap->Bind(3);
+    GlState::Get().ActiveTexture(0);
+    program->SetUniform("positionMap", 2);
+    program->SetUniform("normalMap", 3);
+    program->SetUniform("time", time);
+    program->SetUniform("vertexCount", m_vertexCount);
+    glm::vec4 clips[kMaxVertexAnimationClips];
+    for (int i = 0; i < (int)m_clips.size(); i++)
+    {
+        auto &clip = m_clips[i];
+        clips[i] = glm::vec4((float)clip.firstFrame, (float)clip.frameCount, clip.frameRate, 0.0f);
+    }
+    program->SetUniform("clips", clips, (int)m_clips.size());
+    m_mesh->Draw(program);
+}
@@ -0,0 +1,71 @@
+#ifndef __VERTEX_ANIMATION_H__
+#define __VERTEX_ANIMATION_H__
+
+#include "common.h"
+#include "mesh.h"
+#include "skeleton.h"
+#include "skinning.h"
+
+static const int kMaxVertexAnimationClips = 16; // vat.vs의 clips 배열 크기와 같아야 함
+
+// texture 안에서 연속된 frame 구간 하나가 clip 하나
+struct VertexAnimationClip
+{
+    std::string name;
+    int firstFrame;
+    int frameCount;
+    float frameRate;
+};
+
+// 미리 구운 정점 애니메이션. frame f의 정점 v는 positions[f * vertexCount + v]
+struct VertexAnimationData
+{
+    int vertexCount{0};
+    int frameCount{0};
+    std::vector<VertexAnimationClip> clips;
+    std::vector<Vertex> vertices; // bind pose. texCoord와 bounds 계산에 사용
+    std::vector<uint32_t> indices;
+    std::vector<glm::vec4> positions;
+    std::vector<glm::vec4> normals;
+    std::string diffuseMap; // 텍스쳐 경로 (.vat 파일 기준 상대 경로)
+    std::string specularMap;
+};
+
+// vertex animation texture (VAT)
+// 오프라인에서 skinning 결과를 frame마다 position / normal texture에 구워 두고,
+// 실행 중에는 인스턴스 attribute의 (clip, 시간 offset)으로 vat.vs가 정점을 texture에서 읽는다.
+// 캐릭터 수와 관계없이 CPU 작업 없이 instanced draw 한 번으로 군중을 그림
+CLASS_PTR(VertexAnimation)
+class VertexAnimation
+{
+public:
+    // animations마다 frameRate 간격으로 pose를 샘플링해서 clip 하나씩 만든다.
+    // frameRate가 0 이하이거나 texture 높이가 너무 커지면 실패
+    static std::optional<VertexAnimationData> Bake(
+        const std::vector<SkinnedVertex> &vertices, const std::vector<uint32_t> &indices,
+        const Skeleton &skeleton, const std::vector<const Animation *> &animations, float frameRate);
+    static bool Save(const VertexAnimationData &data, const std::string &filename);
+    static std::optional<VertexAnimationData> Read(const std::string &filename);
+
+    static VertexAnimationUPtr Create(const VertexAnimationData &data, MaterialPtr material); // texture가 GL_MAX_TEXTURE_SIZE를 넘으면 nullptr
+    static VertexAnimationUPtr Load(const std::string &filename); // .vat 파일 (텍스쳐는 파일 기준 경로에서 로드)
+
+    const std::vector<VertexAnimationClip> &GetClips() const { return m_clips; }
+    const Mesh *GetMesh() const { return m_mesh.get(); }
+
+    // 인스턴스 배치와 재생할 clip / 시간 offset (clipTimes[i] = (clip 번호, 초))
+    void SetInstances(const std::vector<glm::mat4> &transforms, const std::vector<glm::vec2> &clipTimes);
+    void Draw(const Program *program, float time) const; // vat.vs를 쓰는 program 필요
+
+private:
+    VertexAnimation() {}
+    bool Init(const VertexAnimationData &data, MaterialPtr material);
+
+    MeshUPtr m_mesh;
+    TextureUPtr m_positionMap; // RGBA32F
+    TextureUPtr m_normalMap;   // RGBA16F
+    int m_vertexCount{0};
+    std::vector<VertexAnimationClip> m_clips;
+};
+
+#endif // __VERTEX_ANIMATION_H__
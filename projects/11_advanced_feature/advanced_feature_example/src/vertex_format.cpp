@@ -0,0 +1,64 @@
+#include "vertex_format.h"
+#include "gl_state.h"
+
+bool VertexAttribFormat::operator==(const VertexAttribFormat &other) const
+{
+    return location == other.location && count == other.count && type == other.type &&
+           normalized == other.normalized && integer == other.integer &&
+           binding == other.binding && relativeOffset == other.relativeOffset;
+}
+
+VertexFormatRegistry &VertexFormatRegistry::Get()
+{
+    static VertexFormatRegistry registry;
+    return registry;
+}
+
+uint32_t VertexFormatRegistry::GetVertexArray(const VertexFormat &format)
+{
+    for (auto &entry : m_entries)
+    {
+        if (entry.first == format)
+            return entry.second;
+    }
+    uint32_t vertexArray = CreateVertexArray(format);
+    m_entries.emplace_back(format, vertexArray);
+    SPDLOG_INFO("vertex format #{}: {} attributes, {} bindings", m_entries.size(), format.attribs.size(), format.divisors.size());
+    return vertexArray;
+}
+
+uint32_t VertexFormatRegistry::CreateVertexArray(const VertexFormat &format) const
+{
+    uint32_t vertexArray = 0;
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glCreateVertexArrays(1, &vertexArray);
+        for (auto &attrib : format.attribs)
+        {
+            glEnableVertexArrayAttrib(vertexArray, attrib.location);
+            if (attrib.integer)
+                glVertexArrayAttribIFormat(vertexArray, attrib.location, attrib.count, attrib.type, attrib.relativeOffset);
+            else
+                glVertexArrayAttribFormat(vertexArray, attrib.location, attrib.count, attrib.type, attrib.normalized, attrib.relativeOffset);
+            glVertexArrayAttribBinding(vertexArray, attrib.location, attrib.binding);
+        }
+        for (uint32_t binding = 0; binding < (uint32_t)format.divisors.size(); binding++)
+            glVertexArrayBindingDivisor(vertexArray, binding, format.divisors[binding]);
+        return vertexArray;
+    }
+
+    glGenVertexArrays(1, &vertexArray);
+    GlState::Get().BindVertexArray(vertexArray);
+    for (auto &attrib : format.attribs)
+    {
+        glEnableVertexAttribArray(attrib.location);
+        if (attrib.integer)
+            glVertexAttribIFormat(attrib.location, attrib.count, attrib.type, attrib.relativeOffset);
+        else
+            glVertexAttribFormat(attrib.location, attrib.count, attrib.type, attrib.normalized, attrib.relativeOffset);
+        glVertexAttribBinding(attrib.location, attrib.binding);
+    }
+    for (uint32_t binding = 0; binding < (uint32_t)format.divisors.size(); binding++)
+        glVertexBindingDivisor(binding, format.divisors[binding]);
+    return vertexArray;
+}
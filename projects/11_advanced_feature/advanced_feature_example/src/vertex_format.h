@@ -0,0 +1,52 @@
+#ifndef __VERTEX_FORMAT_H__
+#define __VERTEX_FORMAT_H__
+
+#include "common.h"
+
+// attribute 하나가 어떤 모양의 데이터를 binding의 어디에서 읽는지 (어느 buffer인지는 포함하지 않음)
+struct VertexAttribFormat
+{
+    uint32_t location;
+    int count;
+    uint32_t type;
+    bool normalized;
+    bool integer; // glVertexAttribIFormat (ivec, uvec)
+    uint32_t binding;
+    uint32_t relativeOffset; // binding의 offset에서부터 byte 단위
+
+    bool operator==(const VertexAttribFormat &other) const;
+};
+
+// VAO 하나가 기억하는 attribute 구성. buffer, offset, stride는 draw 전에 glBindVertexBuffer로 바꿈
+struct VertexFormat
+{
+    std::vector<VertexAttribFormat> attribs; // location 순
+    std::vector<uint32_t> divisors;          // binding별 instance divisor
+
+    bool operator==(const VertexFormat &other) const { return attribs == other.attribs && divisors == other.divisors; }
+};
+
+// 정점 형식마다 VAO를 하나만 만들어 모든 VertexLayout이 공유하는 프로세스 전역 registry
+// mesh를 바꿔 그릴 때 형식이 같으면 VAO는 그대로 두고 vertex buffer만 다시 연결하면 된다.
+// GL 4.3 / ARB_vertex_attrib_binding이 필요하며, 없으면 VertexLayout이 mesh마다 VAO를 만든다.
+// VAO는 프로그램이 끝날 때까지 유지 (형식 수만큼만 생기므로 지우지 않음)
+class VertexFormatRegistry
+{
+public:
+    static VertexFormatRegistry &Get();
+
+    bool IsEnabled() const { return m_enabled && (GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_vertex_attrib_binding); }
+    void SetEnabled(bool enabled) { m_enabled = enabled; } // false면 지원해도 mesh마다 VAO 사용 (비교용). VertexLayout을 만들기 전에 설정
+
+    uint32_t GetVertexArray(const VertexFormat &format); // 처음 보는 형식이면 VAO를 만듦
+    int GetFormatCount() const { return (int)m_entries.size(); }
+
+private:
+    VertexFormatRegistry() {}
+    uint32_t CreateVertexArray(const VertexFormat &format) const;
+
+    std::vector<std::pair<VertexFormat, uint32_t>> m_entries; // 형식 수가 적으므로 선형 탐색
+    bool m_enabled{true};
+};
+
+#endif // __VERTEX_FORMAT_H__
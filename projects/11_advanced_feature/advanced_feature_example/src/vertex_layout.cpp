@@ -1,4 +1,7 @@
 #include "vertex_layout.h"
+#include "gl_state.h"
+#include "vertex_format.h"
+#include <algorithm>
 
 VertexLayoutUPtr VertexLayout::Create()
 {
@@ -9,22 +12,108 @@ VertexLayoutUPtr VertexLayout::Create()
 
 VertexLayout::~VertexLayout()
 {
-    if (m_vertexArrayObject)
+    if (m_vertexArrayObject && !m_shared) // 공유 VAO는 registry가 가짐
     {
         glDeleteVertexArrays(1, &m_vertexArrayObject);
+        GlState::Get().OnDeleteVertexArray(m_vertexArrayObject);
     }
 }
 
+uint32_t VertexLayout::Get() const
+{
+    if (m_dirty)
+        Resolve();
+    return m_vertexArrayObject;
+}
+
 void VertexLayout::Bind() const
 {
-    glBindVertexArray(m_vertexArrayObject); // 지금부터 사용할 VAO 지정
+    if (!m_shared)
+    {
+        GlState::Get().BindVertexArray(m_vertexArrayObject); // 지금부터 사용할 VAO 지정
+        return;
+    }
+    // 형식이 같은 mesh끼리는 VAO를 바꾸지 않고 buffer 연결만 바꿈 (같은 buffer면 GlState가 생략)
+    auto &state = GlState::Get();
+    state.BindVertexArray(Get());
+    for (uint32_t binding = 0; binding < (uint32_t)m_streams.size(); binding++)
+    {
+        auto &stream = m_streams[binding];
+        state.BindVertexBuffer(binding, stream.buffer, stream.offset, stream.stride);
+    }
+    if (m_indexBuffer)
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+}
+
+void VertexLayout::RecordAttrib(uint32_t attribIndex, uint32_t buffer, int count, uint32_t type,
+                                bool normalized, bool integer, size_t stride, uint64_t offset)
+{
+    auto it = std::find_if(m_attribs.begin(), m_attribs.end(),
+                           [&](const Attrib &attrib)
+                           { return attrib.location == attribIndex; });
+    if (it == m_attribs.end())
+        it = m_attribs.insert(m_attribs.end(), Attrib{attribIndex});
+    uint32_t divisor = it->divisor;
+    *it = {attribIndex, buffer, count, type, normalized, integer, stride, offset, divisor};
+    m_dirty = true;
+}
+
+void VertexLayout::Resolve() const
+{
+    // binding의 offset은 첫 attribute 위치, 나머지는 relative offset으로 표현
+    // (relative offset은 GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET의 최소 보장값 2047을 넘지 않게)
+    const uint64_t kMaxRelativeOffset = 2047;
+    auto attribs = m_attribs;
+    std::sort(attribs.begin(), attribs.end(),
+              [](const Attrib &a, const Attrib &b)
+              { return a.location < b.location; });
+
+    VertexFormat format;
+    m_streams.clear();
+    for (auto &attrib : attribs)
+    {
+        uint32_t binding = 0;
+        for (; binding < (uint32_t)m_streams.size(); binding++)
+        {
+            auto &stream = m_streams[binding];
+            if (stream.buffer == attrib.buffer && stream.stride == attrib.stride &&
+                format.divisors[binding] == attrib.divisor && attrib.offset >= stream.offset &&
+                attrib.offset - stream.offset < attrib.stride &&
+                attrib.offset - stream.offset <= kMaxRelativeOffset)
+                break;
+        }
+        if (binding == (uint32_t)m_streams.size())
+        {
+            m_streams.push_back({attrib.buffer, attrib.offset, attrib.stride});
+            format.divisors.push_back(attrib.divisor);
+        }
+        format.attribs.push_back({attrib.location, attrib.count, attrib.type, attrib.normalized, attrib.integer,
+                                  binding, (uint32_t)(attrib.offset - m_streams[binding].offset)});
+    }
+    m_vertexArrayObject = VertexFormatRegistry::Get().GetVertexArray(format);
+    m_dirty = false;
 }
 
 void VertexLayout::SetAttrib(
-    uint32_t attribIndex, int count,
+    uint32_t attribIndex, uint32_t buffer, int count,
     uint32_t type, bool normalized,
-    size_t stride, uint64_t offset) const
+    size_t stride, uint64_t offset)
 {
+    if (m_shared)
+    {
+        RecordAttrib(attribIndex, buffer, count, type, normalized, false, stride, offset);
+        return;
+    }
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        // offset은 binding 쪽에 두고 attribute의 relative offset은 0 (GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET 제한을 피함)
+        glEnableVertexArrayAttrib(m_vertexArrayObject, attribIndex);
+        glVertexArrayAttribFormat(m_vertexArrayObject, attribIndex, count, type, normalized, 0);
+        SetVertexBuffer(attribIndex, buffer, stride, offset);
+        return;
+    }
+    Bind();
+    GlState::Get().BindBuffer(GL_ARRAY_BUFFER, buffer); // glVertexAttribPointer는 지금 bind된 buffer를 기억함
     glEnableVertexAttribArray(attribIndex); // // 정점 attribute 중 n번째를 사용하도록 설정
     glVertexAttribPointer(attribIndex, count, type, normalized, stride, (const void *)offset);
     // attribIndex : 정점의 n번째 attribute
@@ -35,8 +124,83 @@ void VertexLayout::SetAttrib(
     // offset: 첫 정점의 헤당 attribute까지의 간격 (byte 단위)
 }
 
+void VertexLayout::SetAttribI(uint32_t attribIndex, uint32_t buffer, int count, uint32_t type, size_t stride, uint64_t offset)
+{
+    if (m_shared)
+    {
+        RecordAttrib(attribIndex, buffer, count, type, false, true, stride, offset);
+        return;
+    }
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glEnableVertexArrayAttrib(m_vertexArrayObject, attribIndex);
+        glVertexArrayAttribIFormat(m_vertexArrayObject, attribIndex, count, type, 0);
+        SetVertexBuffer(attribIndex, buffer, stride, offset);
+        return;
+    }
+    Bind();
+    GlState::Get().BindBuffer(GL_ARRAY_BUFFER, buffer);
+    glEnableVertexAttribArray(attribIndex);
+    glVertexAttribIPointer(attribIndex, count, type, stride, (const void *)offset); // float로 변환하지 않고 정수 그대로 전달
+}
+
+void VertexLayout::SetVertexBuffer(uint32_t attribIndex, uint32_t buffer, size_t stride, uint64_t offset) const
+{
+    // glVertexAttribPointer도 attribute n을 binding n에 연결하므로 두 경로의 VAO 상태가 같음
+    glVertexArrayAttribBinding(m_vertexArrayObject, attribIndex, attribIndex);
+    glVertexArrayVertexBuffer(m_vertexArrayObject, attribIndex, buffer, (GLintptr)offset, (GLsizei)stride);
+}
+
+void VertexLayout::SetIndexBuffer(uint32_t buffer)
+{
+    if (m_shared)
+    {
+        m_indexBuffer = buffer; // Bind에서 연결
+        return;
+    }
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glVertexArrayElementBuffer(m_vertexArrayObject, buffer);
+        GlState::Get().OnVertexArrayElementBuffer(m_vertexArrayObject, buffer);
+        return;
+    }
+    Bind();
+    GlState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+}
+
+void VertexLayout::SetAttribDivisor(uint32_t attribIndex, uint32_t divisor)
+{
+    if (m_shared)
+    {
+        for (auto &attrib : m_attribs)
+        {
+            if (attrib.location == attribIndex)
+                attrib.divisor = divisor;
+        }
+        m_dirty = true;
+        return;
+    }
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glVertexArrayBindingDivisor(m_vertexArrayObject, attribIndex, divisor);
+        return;
+    }
+    Bind();
+    glVertexAttribDivisor(attribIndex, divisor);
+}
+
 void VertexLayout::Init()
 {
+    if (VertexFormatRegistry::Get().IsEnabled())
+    {
+        m_shared = true; // VAO는 처음 Bind할 때 registry에서 받음
+        return;
+    }
+    if (GlState::Get().IsDirectStateAccess())
+    {
+        glCreateVertexArrays(1, &m_vertexArrayObject); // bind하지 않아도 바로 사용 가능한 object 생성
+        return;
+    }
     glGenVertexArrays(1, &m_vertexArrayObject); // VAO 생성
     Bind();
-}
\ No newline at end of file
+}
@@ -10,15 +10,51 @@ public:
     static VertexLayoutUPtr Create();
     ~VertexLayout();
 
-    uint32_t Get() const { return m_vertexArrayObject; }
-    void Bind() const;
-    void SetAttrib(uint32_t attribIndex, int count, uint32_t type, bool normalized, size_t stride, uint64_t offset) const;
+    uint32_t Get() const; // 공유 VAO면 다른 VertexLayout도 같은 값을 가짐
+    void Bind() const;    // 공유 VAO면 VAO와 함께 이 layout의 vertex / index buffer도 연결
+    // attribute가 읽을 buffer를 직접 지정하므로 VAO나 buffer를 미리 bind해 둘 필요 없음
+    // VertexFormatRegistry를 쓸 수 있으면 설정을 기록만 해 두고 처음 Bind할 때 같은 형식의 공유 VAO를 찾는다.
+    // 아니면 이 layout만의 VAO를 direct state access로, 그것도 없으면 GL 3.3 방식대로 bind 후 설정
+    void SetAttrib(uint32_t attribIndex, uint32_t buffer, int count, uint32_t type, bool normalized, size_t stride, uint64_t offset);
+    void SetAttribI(uint32_t attribIndex, uint32_t buffer, int count, uint32_t type, size_t stride, uint64_t offset); // 정수 attribute (ivec, uvec)
+    void SetIndexBuffer(uint32_t buffer); // element buffer는 VAO 상태의 일부
     void DisableAttrib(int attribIndex) const;
+    void SetAttribDivisor(uint32_t attribIndex, uint32_t divisor); // divisor가 1이면 attribute가 정점이 아닌 인스턴스마다 한 칸씩 진행
+    bool IsShared() const { return m_shared; }
 
 private:
     VertexLayout() {}
     void Init();
-    uint32_t m_vertexArrayObject{0};
+    void SetVertexBuffer(uint32_t attribIndex, uint32_t buffer, size_t stride, uint64_t offset) const; // DSA: attribute마다 같은 번호의 binding 사용
+    void RecordAttrib(uint32_t attribIndex, uint32_t buffer, int count, uint32_t type, bool normalized, bool integer, size_t stride, uint64_t offset);
+    void Resolve() const; // 기록한 attribute를 binding으로 묶어 형식을 만들고 공유 VAO를 찾음
+
+    mutable uint32_t m_vertexArrayObject{0};
+
+    // 공유 VAO 모드에서 기록한 설정. 같은 buffer / stride / divisor를 쓰는 attribute는 binding 하나로 묶음
+    struct Attrib
+    {
+        uint32_t location;
+        uint32_t buffer;
+        int count;
+        uint32_t type;
+        bool normalized;
+        bool integer;
+        size_t stride;
+        uint64_t offset;
+        uint32_t divisor;
+    };
+    struct Stream // binding별로 glBindVertexBuffer에 넘길 값
+    {
+        uint32_t buffer;
+        uint64_t offset;
+        size_t stride;
+    };
+    bool m_shared{false};
+    std::vector<Attrib> m_attribs;
+    uint32_t m_indexBuffer{0};
+    mutable std::vector<Stream> m_streams;
+    mutable bool m_dirty{false}; // 기록이 바뀌어서 다음 Bind에 형식을 다시 찾아야 함
 };
 
 #endif // __VERTEX_LAYOUT_H__
\ No newline at end of file
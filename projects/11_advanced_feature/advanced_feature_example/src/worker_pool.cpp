@@ -0,0 +1,82 @@
+#include "worker_pool.h"
+
+WorkerPoolUPtr WorkerPool::Create(size_t threadCount)
+{
+    auto pool = WorkerPoolUPtr(new WorkerPool());
+    pool->Init(threadCount);
+    return std::move(pool);
+}
+
+void WorkerPool::Init(size_t threadCount)
+{
+    for (size_t i = 1; i < threadCount; i++)
+        m_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+    SPDLOG_INFO("worker pool: {} threads", GetThreadCount());
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto &thread : m_threads)
+        thread.join();
+}
+
+void WorkerPool::Run(size_t taskCount, const std::function<void(size_t)> &task)
+{
+    // 나눌 것이 없으면 깨우지 않고 바로 실행
+    if (m_threads.empty() || taskCount <= 1)
+    {
+        for (size_t i = 0; i < taskCount; i++)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask = 0;
+        m_busyCount = m_threads.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+    Work();
+
+    // task는 호출한 쪽의 지역 변수이므로 모든 worker가 손을 뗄 때까지 기다림
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]()
+                { return m_busyCount == 0; });
+    m_task = nullptr;
+}
+
+void WorkerPool::WorkerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]()
+                        { return m_quit || m_generation != generation; });
+            if (m_quit)
+                return;
+            generation = m_generation;
+        }
+        Work();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busyCount == 0)
+                m_done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::Work()
+{
+    for (size_t i = m_nextTask++; i < m_taskCount; i = m_nextTask++)
+        (*m_task)(i);
+}
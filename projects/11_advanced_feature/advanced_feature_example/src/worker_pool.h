@@ -0,0 +1,43 @@
+#ifndef __WORKER_POOL_H__
+#define __WORKER_POOL_H__
+
+#include "common.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// 한 번 띄운 스레드를 계속 재사용해서 작업을 나눠 처리하는 pool
+// 프레임마다 std::async로 스레드를 만들고 없애는 비용이 작업보다 커질 때 사용
+// Run은 호출한 스레드도 같이 task를 가져가 실행하고, 모든 task가 끝나야 반환됨. 한 번에 하나의 Run만 호출해야 함
+CLASS_PTR(WorkerPool)
+class WorkerPool
+{
+public:
+    static WorkerPoolUPtr Create(size_t threadCount); // 호출한 스레드를 포함한 수. threadCount - 1개의 스레드를 띄움
+    ~WorkerPool();
+
+    // task(0) ~ task(taskCount - 1)을 스레드들이 하나씩 가져가서 실행
+    void Run(size_t taskCount, const std::function<void(size_t)> &task);
+    size_t GetThreadCount() const { return m_threads.size() + 1; }
+
+private:
+    WorkerPool() {}
+    void Init(size_t threadCount);
+    void WorkerLoop();
+    void Work(); // 남은 task가 없을 때까지 가져가서 실행
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // 새 작업이 들어왔거나 종료
+    std::condition_variable m_done; // worker가 모두 작업을 마침
+    const std::function<void(size_t)> *m_task{nullptr};
+    size_t m_taskCount{0};
+    std::atomic<size_t> m_nextTask{0};
+    size_t m_busyCount{0};     // 이번 작업을 아직 마치지 않은 worker 수
+    uint64_t m_generation{0}; // Run마다 증가. worker는 자기가 본 값과 다르면 깨어남
+    bool m_quit{false};
+};
+
+#endif // __WORKER_POOL_H__